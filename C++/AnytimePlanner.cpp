@@ -0,0 +1,402 @@
+// AnytimePlanner.cpp
+// ===========================================================================
+// Implements the tiered anytime planner: search tiers, cue ball rollout
+// validation and one-shot lookahead.
+// ===========================================================================
+
+#include "AnytimePlanner.h"
+#include "CombinationPlanner.h"
+#include "GeometryUtils.h"
+#include "GhostBallSolver.h"
+#include "ScratchFilter.h"
+#include <algorithm>
+#include <cmath>
+
+AnytimeOptions defaultAnytimeOptions() {
+    AnytimeOptions options;
+    options.budget = std::chrono::microseconds(40000);
+    options.tier_deadlines = {0.3, 0.5, 0.7, 0.85, 1.0};
+    options.shots_per_tier = 8;
+    options.accept_success = 0.9;
+    options.max_shots = 4;
+    options.outcomes = nullptr;
+    return options;
+}
+
+// ---------------------------------------------------------------------------
+// Predicted cue ball run after contact:
+// - CUE_RUN_UNKNOWN: not validated yet, or the model cannot tell (the cue
+//   ball runs into another ball or keeps bouncing)
+// - CUE_RUN_RESTS: it stops on the table at (rest_x, rest_y)
+// - CUE_RUN_SCRATCH: it drops into a pocket
+// ---------------------------------------------------------------------------
+enum CueRun {
+    CUE_RUN_UNKNOWN,
+    CUE_RUN_RESTS,
+    CUE_RUN_SCRATCH
+};
+
+struct AnytimeCandidate {
+    ShotCandidate shot;
+    double success;
+    double score;
+    CueRun cue_run;
+    double rest_x, rest_y;
+};
+
+// Index of the ball closest to (x, y)
+static size_t nearestBall(const std::vector<std::vector<double>>& balls, double x, double y) {
+    size_t best = 0;
+    double best_d = -1;
+    for (size_t i = 0; i < balls.size(); ++i) {
+        double d = mag(balls[i][0] - x, balls[i][1] - y);
+        if (best_d < 0 || d < best_d) {
+            best = i;
+            best_d = d;
+        }
+    }
+    return best;
+}
+
+// ---------------------------------------------------------------------------
+// Index of the ball 'shot' pockets: the second ball for combinations (one
+// diameter past object_aim towards the hole), otherwise the target.
+// ---------------------------------------------------------------------------
+static size_t pottedBall(const ShotCandidate& shot, const std::vector<std::vector<double>>& balls, double bound_radius) {
+    if (shot.kind != COMBINATION_SHOT) {
+        return nearestBall(balls, shot.target_coords[0], shot.target_coords[1]);
+    }
+    double ux = shot.hole_coords[0] - shot.object_aim[0];
+    double uy = shot.hole_coords[1] - shot.object_aim[1];
+    double len = mag(ux, uy);
+    if (len < 1e-9) return nearestBall(balls, shot.object_aim[0], shot.object_aim[1]);
+    return nearestBall(balls, shot.object_aim[0] + ux / len * bound_radius,
+                       shot.object_aim[1] + uy / len * bound_radius);
+}
+
+// ---------------------------------------------------------------------------
+// Rolls out the cue ball after contact with the stun-shot model: the cue
+// ball leaves the ghost position along the tangent line with sin^2 of the
+// cut of the remaining roll, and the roll is sized so the target's cos^2
+// share covers VALIDATION_SPEED_MARGIN times its path.
+// ---------------------------------------------------------------------------
+static void validateShot(
+    AnytimeCandidate& c,
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& childballs,
+    const TableModel& table,
+    double bound_radius
+) {
+    const ShotCandidate& s = c.shot;
+    const auto& target = s.target_coords;
+    c.cue_run = CUE_RUN_UNKNOWN;
+
+    CueContact contact;
+    if (!cueContact(s, cueball_pos, bound_radius, VALIDATION_SPEED_MARGIN, contact)) return;
+    const double gx = contact.x;
+    const double gy = contact.y;
+    const double cos_cut = contact.cos_cut;
+    double cue_roll = contact.remaining * (1 - cos_cut * cos_cut);
+
+    c.rest_x = gx;
+    c.rest_y = gy;
+    double tx = contact.in_x - cos_cut * contact.line_x;
+    double ty = contact.in_y - cos_cut * contact.line_y;
+    double tangent = mag(tx, ty);
+    if (tangent > 1e-9 && cue_roll > 0) {
+        // The target and the pocketed ball have left their spots
+        size_t hit = nearestBall(childballs, target[0], target[1]);
+        size_t potted = pottedBall(s, childballs, bound_radius);
+        std::vector<std::vector<double>> others;
+        others.reserve(childballs.size());
+        for (size_t i = 0; i < childballs.size(); ++i) {
+            if (i != hit && i != potted) others.push_back(childballs[i]);
+        }
+        int bounces = 0;
+        RollResult result = rollOnTable(table, gx, gy, tx / tangent, ty / tangent, cue_roll, others,
+                                        bound_radius, c.rest_x, c.rest_y, bounces);
+        if (result == ROLL_POCKETED) {
+            c.cue_run = CUE_RUN_SCRATCH;
+            return;
+        }
+        if (result != ROLL_STOPPED) return;
+    }
+    c.cue_run = CUE_RUN_RESTS;
+}
+
+// ---------------------------------------------------------------------------
+// Chance from 'outcomes' that a ball arriving at the pocket of 'hole' from
+// (from_x, from_y), aimed at the mouth centre, drops
+// ---------------------------------------------------------------------------
+static double pocketCapture(
+    const OutcomeTables& outcomes,
+    const std::vector<Pocket>& pockets,
+    const std::vector<double>& hole,
+    double from_x, double from_y
+) {
+    for (const auto& p : pockets) {
+        if (p.center != hole) continue;
+        double dx = hole[0] - from_x;
+        double dy = hole[1] - from_y;
+        // Angle from the pocket axis (-facing)
+        double entry = std::atan2(p.facing[1] * dx - p.facing[0] * dy, -(p.facing[0] * dx + p.facing[1] * dy));
+        return outcomes.captureChance(entry, 0);
+    }
+    return 1;
+}
+
+// ---------------------------------------------------------------------------
+// Success estimate of each shot in 'shots' from 'cueball_pos'. Every kind
+// is scored on the same scale: cueMarginSuccess of its cue margin, times
+// the pocket capture chance of the pocketed ball's last leg if 'outcomes'
+// is given. Cue margins come from GhostBallBatch solves:
+// - direct and bank shots: cue ball -> target, aimed at object_aim
+// - flip shots: the cushion mirrors the cue ball's direction error, so the
+//   cue ball is placed on the straight line it would have come from
+//   (wall contact extended back by the cue -> wall length) and hits the
+//   target full, along wall -> target
+// - two-ball shots: first A -> B, which turns the pocket margin (of B for
+//   combinations, of A's exit for kisses, which turns with the line of
+//   centres) into a margin on A's direction; then cue ball -> A with that
+//   margin
+// ---------------------------------------------------------------------------
+static void estimateSuccess(
+    const std::vector<ShotCandidate>& shots,
+    const std::vector<double>& cueball_pos,
+    const TableModel& table,
+    double bound_radius,
+    const OutcomeTables* outcomes,
+    std::vector<double>& success
+) {
+    // Where the pocketed ball's last leg starts: the target, the cushion
+    // for banks, B for combinations, the contact for kisses
+    std::vector<std::vector<double>> last_leg(shots.size());
+    GhostBallBatch second;
+    for (size_t i = 0; i < shots.size(); ++i) {
+        const ShotCandidate& shot = shots[i];
+        last_leg[i] = shot.kind == BANK_SHOT || shot.kind == KISS_SHOT ? shot.object_aim : shot.target_coords;
+        if (shot.kind != COMBINATION_SHOT && shot.kind != KISS_SHOT) continue;
+        std::vector<double> b = secondBallOf(shot, bound_radius);
+        if (shot.kind == COMBINATION_SHOT) {
+            last_leg[i] = b;
+            addGhostBallShot(second, shot.target_coords, b, shot.hole_coords, shot.aim_margin);
+        } else {
+            std::vector<double> b_aim = {2 * b[0] - shot.object_aim[0], 2 * b[1] - shot.object_aim[1]};
+            addGhostBallShot(second, shot.target_coords, b, b_aim, shot.aim_margin);
+        }
+    }
+    solveGhostBalls(second, bound_radius);
+
+    GhostBallBatch batch;
+    size_t chained = 0;
+    for (const auto& shot : shots) {
+        const auto& target = shot.target_coords;
+        if (shot.kind == FLIP_SHOT) {
+            const auto& wall = shot.object_aim;
+            double leg = mag(wall[0] - cueball_pos[0], wall[1] - cueball_pos[1]);
+            double ux = wall[0] - target[0];
+            double uy = wall[1] - target[1];
+            double len = std::max(mag(ux, uy), 1e-9);
+            std::vector<double> mirrored = {wall[0] + ux / len * leg, wall[1] + uy / len * leg};
+            std::vector<double> along = {2 * target[0] - wall[0], 2 * target[1] - wall[1]};
+            addGhostBallShot(batch, mirrored, target, along, shot.aim_margin);
+        } else if (shot.kind == COMBINATION_SHOT || shot.kind == KISS_SHOT) {
+            addGhostBallShot(batch, cueball_pos, target, shot.object_aim, second.cue_margin[chained++]);
+        } else {
+            addGhostBallShot(batch, cueball_pos, target, shot.object_aim, shot.aim_margin);
+        }
+    }
+    solveGhostBalls(batch, bound_radius);
+
+    success.resize(shots.size());
+    for (size_t i = 0; i < shots.size(); ++i) {
+        success[i] = cueMarginSuccess(batch.cue_margin[i]);
+        if (outcomes && success[i] > 0) {
+            success[i] *= pocketCapture(*outcomes, table.pockets, shots[i].hole_coords,
+                                        last_leg[i][0], last_leg[i][1]);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Success estimate of the best direct shot from the cue ball rest once
+// the pocketed ball is gone; 1 if the table is cleared. Sets 'complete' to
+// false if 'cancel' cut the search short.
+// ---------------------------------------------------------------------------
+static double nextShotSuccess(
+    const AnytimeCandidate& c,
+    const std::vector<std::vector<double>>& childballs,
+    const TableModel& table,
+    double bound_radius,
+    const OutcomeTables* outcomes,
+    size_t max_shots,
+    const CancellationToken& cancel,
+    bool& complete
+) {
+    complete = true;
+    size_t potted = pottedBall(c.shot, childballs, bound_radius);
+    std::vector<std::vector<double>> layout;
+    layout.reserve(childballs.size());
+    for (size_t i = 0; i < childballs.size(); ++i) {
+        if (i != potted) layout.push_back(childballs[i]);
+    }
+    if (layout.empty()) return 1;
+
+    std::vector<double> rest = {c.rest_x, c.rest_y};
+    ShotSearch search(rest, layout, table, bound_radius);
+    std::vector<ShotCandidate> next = search.search(DIRECT_TIER, max_shots, &cancel);
+    complete = !search.stats().cancelled;
+
+    std::vector<double> success;
+    estimateSuccess(next, rest, table, bound_radius, outcomes, success);
+    double best = 0;
+    for (double p : success) best = std::max(best, p);
+    return best;
+}
+
+// Highest score first; equal scores keep search order
+static void rankCandidates(std::vector<AnytimeCandidate>& pool) {
+    std::stable_sort(pool.begin(), pool.end(),
+        [](const AnytimeCandidate& a, const AnytimeCandidate& b) { return a.score > b.score; });
+}
+
+// ---------------------------------------------------------------------------
+// Marks the candidates whose cue ball's stun or natural-roll path runs into
+// a pocket as scratches (score 0) with one batched flagScratchRisk pass, so
+// the rollout never spends time on them. Returns how many were marked.
+// ---------------------------------------------------------------------------
+static size_t prefilterScratches(
+    std::vector<AnytimeCandidate>& pool,
+    const std::vector<double>& cueball_pos,
+    const TableModel& table,
+    double bound_radius
+) {
+    ScratchBatch batch;
+    std::vector<size_t> index;
+    CueContact contact;
+    for (size_t i = 0; i < pool.size(); ++i) {
+        if (!cueContact(pool[i].shot, cueball_pos, bound_radius, VALIDATION_SPEED_MARGIN, contact)) continue;
+        addScratchShot(batch, contact);
+        index.push_back(i);
+    }
+    flagScratchRisk(batch, table.pockets, bound_radius / 2);
+
+    size_t marked = 0;
+    for (size_t k = 0; k < index.size(); ++k) {
+        if (batch.stun_risk[k] == 0 && batch.roll_risk[k] == 0) continue;
+        AnytimeCandidate& c = pool[index[k]];
+        c.cue_run = CUE_RUN_SCRATCH;
+        c.score = 0;
+        ++marked;
+    }
+    return marked;
+}
+
+std::vector<ShotCandidate> planAnytime(
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& childballs,
+    const TableModel& table,
+    double bound_radius,
+    const AnytimeOptions& options,
+    const CancellationToken& cancel,
+    AnytimeStats& stats
+) {
+    typedef CancellationToken::Clock Clock;
+    const Clock::time_point start = Clock::now();
+    stats.tiers_finished = 0;
+    stats.cut_short = false;
+    stats.candidates = 0;
+    stats.validated = 0;
+    stats.scratch_risks = 0;
+    stats.scratches = 0;
+    stats.lookahead = 0;
+
+    auto tierDeadline = [&](int tier) {
+        double fraction = static_cast<size_t>(tier) < options.tier_deadlines.size() ? options.tier_deadlines[tier] : 1.0;
+        fraction = std::min(1.0, std::max(0.0, fraction));
+        return start + std::chrono::duration_cast<Clock::duration>(options.budget * fraction);
+    };
+
+    // ---- Tiers 1-3: direct, single cushion, two-ball ------------------------
+    static const unsigned search_tiers[] = {DIRECT_TIER, CUSHION_TIER, COMBINATION_TIER};
+    std::vector<AnytimeCandidate> pool;
+    std::vector<double> success;
+    double best_success = 0;
+    ShotSearch search(cueball_pos, childballs, table, bound_radius);
+    for (int tier = ANYTIME_DIRECT; tier <= ANYTIME_COMBINATION; ++tier) {
+        if (tier != ANYTIME_DIRECT && best_success >= options.accept_success) break;
+        if (cancel.expired()) {
+            stats.cut_short = true;
+            break;
+        }
+        CancellationToken token(tierDeadline(tier), &cancel);
+        std::vector<ShotCandidate> shots = search.search(search_tiers[tier], options.shots_per_tier, &token);
+        estimateSuccess(shots, cueball_pos, table, bound_radius, options.outcomes, success);
+        for (size_t i = 0; i < shots.size(); ++i) {
+            pool.push_back({shots[i], success[i], success[i], CUE_RUN_UNKNOWN, 0, 0});
+            best_success = std::max(best_success, success[i]);
+        }
+        if (search.stats().cancelled) stats.cut_short = true;
+        else stats.tiers_finished |= 1u << tier;
+    }
+    stats.candidates = pool.size();
+    stats.search = search.stats();
+    stats.scratch_risks = prefilterScratches(pool, cueball_pos, table, bound_radius);
+    rankCandidates(pool);
+
+    // ---- Tier 4: simulated validation, best candidates first ----------------
+    if (!pool.empty() && !cancel.expired()) {
+        CancellationToken token(tierDeadline(ANYTIME_VALIDATION), &cancel);
+        bool finished = true;
+        for (auto& c : pool) {
+            if (c.cue_run == CUE_RUN_SCRATCH) continue;
+            if (token.expired()) {
+                finished = false;
+                break;
+            }
+            validateShot(c, cueball_pos, childballs, table, bound_radius);
+            ++stats.validated;
+            if (c.cue_run == CUE_RUN_SCRATCH) {
+                c.score = 0;
+                ++stats.scratches;
+            }
+        }
+        if (finished) stats.tiers_finished |= 1u << ANYTIME_VALIDATION;
+        else stats.cut_short = true;
+        rankCandidates(pool);
+    }
+
+    // ---- Tier 5: lookahead from the predicted cue ball rest -----------------
+    if (!pool.empty() && !cancel.expired()) {
+        CancellationToken token(tierDeadline(ANYTIME_LOOKAHEAD), &cancel);
+        bool finished = true;
+        for (auto& c : pool) {
+            if (c.cue_run != CUE_RUN_RESTS) continue;
+            if (token.expired()) {
+                finished = false;
+                break;
+            }
+            bool complete;
+            double next = nextShotSuccess(c, childballs, table, bound_radius, options.outcomes,
+                                          options.shots_per_tier, token, complete);
+            if (!complete) {
+                finished = false;
+                break;
+            }
+            c.score = c.success * (1 + next);
+            ++stats.lookahead;
+        }
+        if (finished) stats.tiers_finished |= 1u << ANYTIME_LOOKAHEAD;
+        else stats.cut_short = true;
+        rankCandidates(pool);
+    } else if (cancel.expired()) {
+        stats.cut_short = true;
+    }
+
+    // Shots known to scratch are never returned
+    std::vector<ShotCandidate> ranked;
+    for (size_t i = 0; i < pool.size() && ranked.size() < options.max_shots; ++i) {
+        if (pool[i].cue_run != CUE_RUN_SCRATCH) ranked.push_back(pool[i].shot);
+    }
+    return ranked;
+}
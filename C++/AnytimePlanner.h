@@ -0,0 +1,133 @@
+// AnytimePlanner.h
+// ===========================================================================
+// Shot planning under a per-frame time budget: always has a best-so-far
+// answer and refines it while time remains.
+//
+// The work is split into tiers, cheapest first, each with its own deadline
+// (a fraction of the frame budget):
+// 1. direct shots (ShotSearch, DIRECT_TIER)
+// 2. single-cushion shots: flips and object-ball banks (CUSHION_TIER)
+// 3. combination and kiss shots (COMBINATION_TIER)
+// 4. simulated validation: first the whole pool goes through the scratch
+//    prefilter (ScratchFilter), which scores 0 every shot whose cue ball's
+//    stun or natural-roll path runs straight into a pocket; the rest have
+//    the cue ball's run after contact rolled out on the TableModel
+//    (stun-shot model, as in SafetyPlanner), and shots whose cue ball
+//    drops into a pocket are scored 0
+// 5. lookahead: from the predicted cue ball rest, the best direct shot on
+//    the remaining balls is planned, so shots leaving position rank higher
+//
+// Shots are ranked by their estimated chance of going in, times (1 + the
+// next shot's estimate) once lookahead has reached them. Every kind is
+// estimated on one scale: the cue margin (GhostBallSolver) of the whole
+// shot, solved for all shots of a tier in one batch, times the pocket
+// capture table's chance when one is given. Flip shots are solved from
+// the cue ball mirrored in the cushion, two-ball shots as two chained
+// ghost-ball hits. Tiers 2 and 3 are skipped when a direct shot is
+// already likely to go in. Every tier polls its CancellationToken once per
+// candidate, so the planner returns within the budget (plus one
+// candidate's work) however crowded the table is.
+// ===========================================================================
+
+#ifndef ANYTIME_PLANNER_H
+#define ANYTIME_PLANNER_H
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+#include "CancellationToken.h"
+#include "OutcomeTables.h"
+#include "ShotCandidate.h"
+#include "ShotSearch.h"
+#include "TableModel.h"
+
+// The cue ball is struck hard enough to send the pocketed ball this many
+// times its path length, so it does not stop in the jaws (validation and
+// the scratch prefilter size the cue ball's run after contact with it)
+const double VALIDATION_SPEED_MARGIN = 1.2;
+
+// ---------------------------------------------------------------------------
+// Tiers in the order they run; AnytimeStats::tiers_finished has bit
+// (1 << tier) set for each tier that ran to its end.
+// ---------------------------------------------------------------------------
+enum AnytimeTier {
+    ANYTIME_DIRECT = 0,
+    ANYTIME_CUSHION = 1,
+    ANYTIME_COMBINATION = 2,
+    ANYTIME_VALIDATION = 3,
+    ANYTIME_LOOKAHEAD = 4,
+    ANYTIME_TIER_COUNT = 5
+};
+
+// ---------------------------------------------------------------------------
+// Planner settings:
+// - budget: total time for planAnytime
+// - tier_deadlines: per tier, the fraction of the budget by which it must
+//   end (cumulative, non-decreasing; missing entries mean 1)
+// - shots_per_tier: shortest shots kept from each search tier
+// - accept_success: skip the indirect tiers once a direct shot has at
+//   least this success estimate
+// - max_shots: length of the returned ranking
+// - outcomes: optional pocket capture table; direct and bank shots are then
+//   also weighted by their captureChance at the pocket (not owned, may be
+//   null)
+// ---------------------------------------------------------------------------
+struct AnytimeOptions {
+    std::chrono::microseconds budget;
+    std::vector<double> tier_deadlines;
+    size_t shots_per_tier;
+    double accept_success;
+    size_t max_shots;
+    const OutcomeTables* outcomes;
+};
+
+// ---------------------------------------------------------------------------
+// Defaults used by main.cpp: 40 ms, tiers ending at 30/50/70/85/100 %,
+// 8 shots per tier, accept at 90 %, 4 shots returned, no outcome tables.
+// ---------------------------------------------------------------------------
+AnytimeOptions defaultAnytimeOptions();
+
+// ---------------------------------------------------------------------------
+// Counters for one call:
+// - tiers_finished: bit (1 << AnytimeTier) per tier that ran to its end
+// - cut_short: some tier was stopped by its deadline or the caller's token
+// - candidates: shots collected by the search tiers
+// - scratch_risks: shots dropped by the scratch prefilter before rollout
+// - validated / scratches: shots rolled out, and how many of those
+//   pocketed the cue ball
+// - lookahead: shots whose next shot was planned
+// - search: ShotSearch counters over the search tiers
+// ---------------------------------------------------------------------------
+struct AnytimeStats {
+    unsigned tiers_finished;
+    bool cut_short;
+    size_t candidates;
+    size_t scratch_risks;
+    size_t validated;
+    size_t scratches;
+    size_t lookahead;
+    PlanStats search;
+};
+
+// ---------------------------------------------------------------------------
+// Plans the shot for the cue ball at 'cueball_pos' within options.budget.
+//
+// - bound_radius: ball diameter (contact distance and clearance margin)
+// - cancel: caller's token (e.g. the frame deadline); it bounds every tier
+//   on top of the budget
+//
+// Returns the ranked shots, best first (at most options.max_shots),
+// leaving out shots flagged by the prefilter or scratching in rollout.
+// Empty if no other shot was found in time.
+// ---------------------------------------------------------------------------
+std::vector<ShotCandidate> planAnytime(
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& childballs,
+    const TableModel& table,
+    double bound_radius,
+    const AnytimeOptions& options,
+    const CancellationToken& cancel,
+    AnytimeStats& stats
+);
+
+#endif // ANYTIME_PLANNER_H
@@ -0,0 +1,82 @@
+// BallMask.cpp
+// ===========================================================================
+// Builds the bitboard masks from the ball coordinates.
+// ===========================================================================
+
+#include "BallMask.h"
+#include "ShotPlanner.h"
+#include <algorithm>
+
+template <typename Scalar>
+BallMask segmentBlockers(
+    Scalar x1, Scalar y1, Scalar x2, Scalar y2,
+    const std::vector<std::vector<Scalar>>& balls,
+    typename NonDeduced<Scalar>::type bound_radius
+) {
+    SegmentBox<Scalar> box = segmentBox(x1, y1, x2, y2, bound_radius);
+    size_t count = std::min(balls.size(), MAX_MASK_BALLS);
+    BallMask blockers = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        Scalar obs_x = balls[i][0];
+        Scalar obs_y = balls[i][1];
+        if ((obs_x==x2 && obs_y==y2) || (obs_x==x1 && obs_y==y1)) {
+            continue;
+        }
+        if (outsideBox(box, obs_x, obs_y)) continue;
+        if (insideCapsule(x1, y1, x2, y2, obs_x, obs_y, bound_radius)) {
+            blockers |= ballBit(i);
+        }
+    }
+    return blockers;
+}
+
+template <typename Scalar>
+BallBoard buildBallBoard(
+    const std::vector<Scalar>& cueball_pos,
+    const std::vector<std::vector<Scalar>>& holes,
+    const std::vector<std::vector<Scalar>>& balls,
+    size_t first,
+    typename NonDeduced<Scalar>::type bound_radius
+) {
+    BallBoard board;
+    board.first = first;
+    board.cue_visible = 0;
+    board.hole_reachable.assign(holes.size(), 0);
+    board.cut_feasible.assign(holes.size(), 0);
+
+    size_t last = std::min(balls.size(), first + MAX_MASK_BALLS);
+    for (size_t i = first; i < last; ++i) {
+        const std::vector<Scalar>& ball = balls[i];
+        BallMask bit = ballBit(i - first);
+
+        // One cue->ball test per ball, shared by every hole
+        if (!isPathObstructed(ball[0], ball[1], cueball_pos[0], cueball_pos[1], balls, bound_radius)) {
+            board.cue_visible |= bit;
+        }
+        for (size_t h = 0; h < holes.size(); ++h) {
+            if (!isPathObstructed(ball[0], ball[1], holes[h][0], holes[h][1], balls, bound_radius)) {
+                board.hole_reachable[h] |= bit;
+            }
+            if (isCutAngleFeasible(cueball_pos, ball, holes[h])) {
+                board.cut_feasible[h] |= bit;
+            }
+        }
+    }
+    return board;
+}
+
+// ---------------------------------------------------------------------------
+// Explicit instantiations for the supported coordinate types.
+// ---------------------------------------------------------------------------
+#define INSTANTIATE_BALL_MASK(Scalar)                                           \
+    template BallMask segmentBlockers<Scalar>(                                   \
+        Scalar, Scalar, Scalar, Scalar,                                          \
+        const std::vector<std::vector<Scalar>>&, Scalar);                        \
+    template BallBoard buildBallBoard<Scalar>(                                   \
+        const std::vector<Scalar>&, const std::vector<std::vector<Scalar>>&,     \
+        const std::vector<std::vector<Scalar>>&, size_t, Scalar);
+
+INSTANTIATE_BALL_MASK(double)
+INSTANTIATE_BALL_MASK(float)
+INSTANTIATE_BALL_MASK(FixedPoint)
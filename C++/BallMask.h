@@ -0,0 +1,114 @@
+// BallMask.h
+// ===========================================================================
+// Bitboard representation of ball sets for tables with up to 64 balls.
+//
+// Bit i of a BallMask stands for ball i of the ball list the mask was built
+// from. Sets the planner keeps asking about (which balls block a corridor,
+// which balls the cue ball sees, which balls can reach a hole) are built
+// once per layout, so combining them is word-wide AND/OR/popcount instead
+// of loops over coordinate vectors.
+//
+// Key parts:
+// - segmentBlockers: mask of the balls blocking one corridor
+// - buildBallBoard: cue-visible and per-hole reachable / cut-feasible masks
+//
+// The templates are defined and explicitly instantiated in BallMask.cpp
+// for the same coordinate types as ShotPlanner.
+// ===========================================================================
+
+#ifndef BALL_MASK_H
+#define BALL_MASK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "GeometryUtils.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+typedef uint64_t BallMask;
+
+// Number of balls one mask can hold
+const size_t MAX_MASK_BALLS = 64;
+
+inline BallMask ballBit(size_t ball) {
+    return BallMask(1) << ball;
+}
+
+inline bool hasBall(BallMask mask, size_t ball) {
+    return (mask >> ball) & 1;
+}
+
+// Number of balls in the set
+inline int countBalls(BallMask mask) {
+#ifdef _MSC_VER
+    return static_cast<int>(__popcnt64(mask));
+#else
+    return __builtin_popcountll(mask);
+#endif
+}
+
+// Index of the lowest ball in a non-empty set
+inline size_t lowestBall(BallMask mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return index;
+#else
+    return static_cast<size_t>(__builtin_ctzll(mask));
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Returns the set of balls in 'balls' that block the corridor from (x1, y1)
+// to (x2, y2), using the same rules as isPathObstructed: a ball blocks if
+// its centre lies within 'bound_radius' of the segment, and balls sitting
+// exactly on an endpoint are ignored. Only the first MAX_MASK_BALLS balls
+// are considered.
+//
+// isPathObstructed(...) is equivalent to segmentBlockers(...) != 0; the
+// mask additionally tells which balls are in the way, e.g. so a
+// combination shot can allow its own balls:
+//   (segmentBlockers(...) & ~combination) == 0
+// ---------------------------------------------------------------------------
+template <typename Scalar>
+BallMask segmentBlockers(
+    Scalar x1, Scalar y1, Scalar x2, Scalar y2,
+    const std::vector<std::vector<Scalar>>& balls,
+    typename NonDeduced<Scalar>::type bound_radius
+);
+
+// ---------------------------------------------------------------------------
+// Masks for the direct shots of one layout, for balls [first, first + 64):
+// - first: index of the ball stored in bit 0
+// - cue_visible: balls the cue ball can hit without touching another ball
+// - hole_reachable[h]: balls with a clear corridor into hole h
+// - cut_feasible[h]: balls whose cue->ball->hole h cut angle is playable
+//
+// The direct shots into hole h are then
+//   cue_visible & hole_reachable[h] & cut_feasible[h]
+// ---------------------------------------------------------------------------
+struct BallBoard {
+    size_t first;
+    BallMask cue_visible;
+    std::vector<BallMask> hole_reachable;
+    std::vector<BallMask> cut_feasible;
+};
+
+// ---------------------------------------------------------------------------
+// Builds the BallBoard for balls [first, first + 64) of 'balls'. Every
+// ball in 'balls' still counts as an obstacle, so layouts with more than
+// 64 balls are handled one block of 64 at a time.
+// ---------------------------------------------------------------------------
+template <typename Scalar>
+BallBoard buildBallBoard(
+    const std::vector<Scalar>& cueball_pos,
+    const std::vector<std::vector<Scalar>>& holes,
+    const std::vector<std::vector<Scalar>>& balls,
+    size_t first,
+    typename NonDeduced<Scalar>::type bound_radius
+);
+
+#endif // BALL_MASK_H
@@ -0,0 +1,429 @@
+// BallSimulator.cpp
+// ===========================================================================
+// Implements the event-driven ball simulation: own events in closed form,
+// collision times as quartic roots, events applied one at a time.
+// ===========================================================================
+
+#include "BallSimulator.h"
+#include "GeometryUtils.h"
+#include <algorithm>
+#include <cmath>
+
+static const double NEVER = std::numeric_limits<double>::infinity();
+
+// Event queue entries per ball before stale entries are compacted away
+static const size_t QUEUE_ENTRIES_PER_BALL = 4;
+
+// ---------------------------------------------------------------------------
+// Polynomial c[0] + c[1] t + ... + c[degree] t^degree at t (Horner).
+// ---------------------------------------------------------------------------
+static double polynomialValue(const double* c, int degree, double t) {
+    double v = c[degree];
+    for (int k = degree - 1; k >= 0; --k) v = v * t + c[k];
+    return v;
+}
+
+// ---------------------------------------------------------------------------
+// Degree after dropping leading coefficients that cannot matter over
+// [0, span] (relative to the largest term).
+// ---------------------------------------------------------------------------
+static int effectiveDegree(const double* c, int degree, double span) {
+    double largest = 0;
+    double power = 1;
+    for (int k = 0; k <= degree; ++k) {
+        largest = std::max(largest, std::abs(c[k]) * power);
+        power *= span;
+    }
+    while (degree > 0 && std::abs(c[degree]) * std::pow(span, degree) <= 1e-14 * largest) --degree;
+    return degree;
+}
+
+// ---------------------------------------------------------------------------
+// Bisects [a, b], where the sign of the polynomial changes between a and
+// b, and returns the end of the final bracket on a's side.
+// ---------------------------------------------------------------------------
+static double bisectRoot(const double* c, int degree, double a, double b) {
+    bool a_positive = polynomialValue(c, degree, a) > 0;
+    for (int it = 0; it < 60 && b - a > 1e-12; ++it) {
+        double m = 0.5 * (a + b);
+        if ((polynomialValue(c, degree, m) > 0) == a_positive) a = m;
+        else b = m;
+    }
+    return a;
+}
+
+// ---------------------------------------------------------------------------
+// Roots in (lo, hi) where the polynomial changes sign, ascending. The roots
+// of the derivative split the interval into monotone pieces, and each piece
+// holds at most one root. Returns the number of roots (at most degree).
+// ---------------------------------------------------------------------------
+static int signChangeRoots(const double* c, int degree, double lo, double hi, double* roots) {
+    degree = effectiveDegree(c, degree, hi);
+    if (degree <= 0) return 0;
+
+    double points[6];
+    int count = 0;
+    points[count++] = lo;
+    if (degree >= 2) {
+        double derivative[4];
+        for (int k = 0; k < degree; ++k) derivative[k] = (k + 1) * c[k + 1];
+        count += signChangeRoots(derivative, degree - 1, lo, hi, points + 1);
+    }
+    points[count++] = hi;
+
+    int found = 0;
+    for (int p = 0; p + 1 < count; ++p) {
+        double fa = polynomialValue(c, degree, points[p]);
+        double fb = polynomialValue(c, degree, points[p + 1]);
+        if ((fa > 0) != (fb > 0)) roots[found++] = bisectRoot(c, degree, points[p], points[p + 1]);
+    }
+    return found;
+}
+
+// ---------------------------------------------------------------------------
+// First t in [0, span] where the quartic c drops to zero, given c(0) > 0;
+// NEVER if it stays positive.
+// ---------------------------------------------------------------------------
+static double firstTouch(const double* c, double span) {
+    int degree = effectiveDegree(c, 4, span);
+    double points[5];
+    int count = 0;
+    if (degree >= 2) {
+        double derivative[4];
+        for (int k = 0; k < degree; ++k) derivative[k] = (k + 1) * c[k + 1];
+        count = signChangeRoots(derivative, degree - 1, 0, span, points);
+    }
+    points[count++] = span;
+
+    double a = 0;
+    for (int p = 0; p < count; ++p) {
+        if (polynomialValue(c, degree, points[p]) <= 0) return bisectRoot(c, degree, a, points[p]);
+        a = points[p];
+    }
+    return NEVER;
+}
+
+BallSimulator::BallSimulator(
+    const TableModel& table,
+    double ball_radius,
+    bool use_broadphase,
+    double deceleration
+) : table_(table), radius_(ball_radius), deceleration_(deceleration),
+    use_broadphase_(use_broadphase),
+    queue_(MAX_MASK_BALLS, QUEUE_ENTRIES_PER_BALL * MAX_MASK_BALLS),
+    on_table_(0), rolling_(0), now_(0), stats_{0, 0, 0, 0, 0, 0, 0} {
+    balls_.reserve(MAX_MASK_BALLS);
+    own_.reserve(MAX_MASK_BALLS);
+    next_.reserve(MAX_MASK_BALLS);
+    broadphase_.reserve(MAX_MASK_BALLS);
+}
+
+void BallSimulator::reset(const std::vector<std::vector<double>>& balls) {
+    const size_t count = std::min(balls.size(), MAX_MASK_BALLS);
+    balls_.resize(count);
+    own_.resize(count);
+    next_.resize(count);
+    broadphase_.reset(count);
+    queue_.reset();
+    on_table_ = count == MAX_MASK_BALLS ? ~BallMask(0) : ballBit(count) - 1;
+    rolling_ = 0;
+    now_ = 0;
+    stats_ = {0, 0, 0, 0, 0, 0, 0};
+    for (size_t i = 0; i < count; ++i) {
+        balls_[i] = {balls[i][0], balls[i][1], 0, 0, 0, BALL_RESTING, -1, -1};
+        computeOwnEvent(i);
+        next_[i] = own_[i];
+        scheduleNext(i);
+    }
+}
+
+double BallSimulator::speedForRoll(double distance) const {
+    return std::sqrt(2 * deceleration_ * std::max(0.0, distance));
+}
+
+void BallSimulator::strike(size_t ball, double vx, double vy) {
+    SimBall& b = balls_[ball];
+    if (b.state != BALL_RESTING || mag(vx, vy) <= 0) return;
+    b.t0 = now_;
+    b.vx = vx;
+    b.vy = vy;
+    b.state = BALL_ROLLING;
+    ++rolling_;
+    afterMotionChange(ballBit(ball));
+}
+
+// ---------------------------------------------------------------------------
+// Position and velocity of ball i at time t (no later than its stop),
+// without changing its reference state.
+// ---------------------------------------------------------------------------
+void BallSimulator::motionAt(size_t i, double t, double& x, double& y, double& vx, double& vy) const {
+    const SimBall& b = balls_[i];
+    x = b.x;
+    y = b.y;
+    vx = b.vx;
+    vy = b.vy;
+    if (b.state != BALL_ROLLING || t <= b.t0) return;
+    double speed = mag(b.vx, b.vy);
+    double dt = std::min(t - b.t0, speed / deceleration_);
+    double distance = speed * dt - 0.5 * deceleration_ * dt * dt;
+    double left = std::max(0.0, speed - deceleration_ * dt);
+    x += b.vx / speed * distance;
+    y += b.vy / speed * distance;
+    vx *= left / speed;
+    vy *= left / speed;
+}
+
+// Moves ball i's reference state to time t
+void BallSimulator::advance(size_t i, double t) {
+    SimBall& b = balls_[i];
+    motionAt(i, t, b.x, b.y, b.vx, b.vy);
+    b.t0 = std::max(b.t0, t);
+}
+
+void BallSimulator::position(size_t ball, double& x, double& y) const {
+    double vx, vy;
+    motionAt(ball, now_, x, y, vx, vy);
+}
+
+// ---------------------------------------------------------------------------
+// Next cushion, pocket or stop of ball i (state at now_), with the same
+// cushion and pocket rules as rollOnTable, and its swept box.
+// ---------------------------------------------------------------------------
+void BallSimulator::computeOwnEvent(size_t i) {
+    const SimBall& b = balls_[i];
+    own_[i] = {NEVER, EVENT_NONE, 0};
+    if (b.state == BALL_POCKETED) return;
+    if (b.state == BALL_RESTING) {
+        broadphase_.update(i, b.x - radius_, b.y - radius_, b.x + radius_, b.y + radius_);
+        return;
+    }
+
+    const double speed = mag(b.vx, b.vy);
+    const double dx = b.vx / speed;
+    const double dy = b.vy / speed;
+    const double stop_distance = speed * speed / (2 * deceleration_);
+
+    double t_line = NEVER;
+    double t_cushion = NEVER;
+    size_t hit = table_.cushions.size();
+    for (size_t k = 0; k < table_.cushions.size(); ++k) {
+        const Cushion& c = table_.cushions[k];
+        double approach = c.normal[0] * dx + c.normal[1] * dy;
+        if (approach >= 0) continue;
+        double t = (c.centre_offset - c.normal[0] * b.x - c.normal[1] * b.y) / approach;
+        if (t < 0) t = 0;
+        t_line = std::min(t_line, t);
+
+        double hx = b.x + t * dx - c.start[0];
+        double hy = b.y + t * dy - c.start[1];
+        double sx = c.end[0] - c.start[0];
+        double sy = c.end[1] - c.start[1];
+        double along = hx * sx + hy * sy;
+        if (along >= 0 && along <= sx * sx + sy * sy && t < t_cushion) {
+            t_cushion = t;
+            hit = k;
+        }
+    }
+
+    double distance;
+    if (t_line >= stop_distance) {
+        distance = stop_distance;
+        own_[i] = {now_ + speed / deceleration_, EVENT_STOP, 0};
+    } else {
+        bool cushion = hit < table_.cushions.size() && t_cushion <= t_line + 1e-9;
+        distance = cushion ? t_cushion : t_line;
+        double root = std::sqrt(std::max(0.0, speed * speed - 2 * deceleration_ * distance));
+        own_[i] = {now_ + (speed - root) / deceleration_, cushion ? EVENT_CUSHION : EVENT_POCKET, hit};
+    }
+
+    double ex = b.x + dx * distance;
+    double ey = b.y + dy * distance;
+    broadphase_.update(i, std::min(b.x, ex) - radius_, std::min(b.y, ey) - radius_,
+                       std::max(b.x, ex) + radius_, std::max(b.y, ey) + radius_);
+}
+
+// ---------------------------------------------------------------------------
+// Time balls i and j first touch before either reaches its own event, or
+// NEVER. Centre distance squared minus (2r)^2 is a quartic in time.
+// ---------------------------------------------------------------------------
+double BallSimulator::collisionTime(size_t i, size_t j) {
+    ++stats_.pair_tests;
+    double span = std::min(own_[i].time, own_[j].time) - now_;
+    if (!(span > 0)) return NEVER;
+    double ix, iy, ivx, ivy, jx, jy, jvx, jvy;
+    motionAt(i, now_, ix, iy, ivx, ivy);
+    motionAt(j, now_, jx, jy, jvx, jvy);
+
+    // Relative position P + V t + A t^2
+    double px = jx - ix, py = jy - iy;
+    double vx = jvx - ivx, vy = jvy - ivy;
+    double ax = 0, ay = 0;
+    double speed_i = mag(ivx, ivy);
+    double speed_j = mag(jvx, jvy);
+    if (speed_i > 0) {
+        ax += 0.5 * deceleration_ * ivx / speed_i;
+        ay += 0.5 * deceleration_ * ivy / speed_i;
+    }
+    if (speed_j > 0) {
+        ax -= 0.5 * deceleration_ * jvx / speed_j;
+        ay -= 0.5 * deceleration_ * jvy / speed_j;
+    }
+
+    const double contact = 2 * radius_;
+    double c[5];
+    c[0] = px * px + py * py - contact * contact;
+    c[1] = 2 * (px * vx + py * vy);
+    c[2] = vx * vx + vy * vy + 2 * (px * ax + py * ay);
+    c[3] = 2 * (vx * ax + vy * ay);
+    c[4] = ax * ax + ay * ay;
+    // Already touching: collide now if approaching
+    if (c[0] <= 0) return c[1] < 0 ? now_ : NEVER;
+
+    double t = firstTouch(c, span);
+    return t == NEVER ? NEVER : now_ + t;
+}
+
+BallMask BallSimulator::candidates(size_t i) const {
+    if (use_broadphase_) return broadphase_.overlaps(i) & on_table_;
+    return on_table_ & ~ballBit(i);
+}
+
+// Puts next_[i] in the event queue in place of ball i's old entry
+void BallSimulator::scheduleNext(size_t i) {
+    if (next_[i].time < NEVER) queue_.schedule(i, next_[i].time);
+    else queue_.cancel(i);
+}
+
+// ---------------------------------------------------------------------------
+// After the balls in 'changed' got new motion: recompute their own events
+// and swept boxes, then the next event of every ball whose collision
+// partner changed. Collisions found also lower the partner's next event.
+// Every ball whose next event changed is rescheduled once at the end.
+// ---------------------------------------------------------------------------
+void BallSimulator::afterMotionChange(BallMask changed) {
+    for (BallMask m = changed; m; m &= m - 1) {
+        size_t i = lowestBall(m);
+        advance(i, now_);
+        computeOwnEvent(i);
+    }
+
+    BallMask stale = changed;
+    for (BallMask m = on_table_ & ~changed; m; m &= m - 1) {
+        size_t k = lowestBall(m);
+        if (next_[k].type == EVENT_COLLISION && hasBall(changed, next_[k].other)) stale |= ballBit(k);
+    }
+    for (BallMask m = stale; m; m &= m - 1) {
+        size_t i = lowestBall(m);
+        next_[i] = own_[i];
+    }
+
+    BallMask updated = stale;
+    for (BallMask m = stale & on_table_; m; m &= m - 1) {
+        size_t i = lowestBall(m);
+        // Pairs of two stale balls are tested once, from the lower index
+        BallMask others = candidates(i) & ~(stale & (ballBit(i) - 1));
+        for (; others; others &= others - 1) {
+            size_t j = lowestBall(others);
+            if (balls_[i].state != BALL_ROLLING && balls_[j].state != BALL_ROLLING) continue;
+            double t = collisionTime(i, j);
+            if (t < next_[i].time) next_[i] = {t, EVENT_COLLISION, j};
+            if (t < next_[j].time) {
+                next_[j] = {t, EVENT_COLLISION, i};
+                updated |= ballBit(j);
+            }
+        }
+    }
+    for (BallMask m = updated; m; m &= m - 1) scheduleNext(lowestBall(m));
+}
+
+size_t BallSimulator::run(double max_time, size_t max_events) {
+    size_t processed = 0;
+    while (rolling_ > 0 && processed < max_events) {
+        size_t i;
+        double t;
+        if (!queue_.peek(i, t)) break;
+        if (t > max_time) {
+            now_ = max_time;
+            for (BallMask m = on_table_; m; m &= m - 1) advance(lowestBall(m), max_time);
+            break;
+        }
+
+        now_ = t;
+        const Event e = next_[i];
+        SimBall& b = balls_[i];
+        advance(i, now_);
+        BallMask changed = ballBit(i);
+        switch (e.type) {
+            case EVENT_STOP:
+                b.vx = 0;
+                b.vy = 0;
+                b.state = BALL_RESTING;
+                --rolling_;
+                break;
+            case EVENT_CUSHION: {
+                const Cushion& c = table_.cushions[e.other];
+                double approach = c.normal[0] * b.vx + c.normal[1] * b.vy;
+                b.vx -= 2 * approach * c.normal[0];
+                b.vy -= 2 * approach * c.normal[1];
+                ++stats_.cushion_hits;
+                break;
+            }
+            case EVENT_POCKET: {
+                double best = NEVER;
+                for (size_t p = 0; p < table_.pockets.size(); ++p) {
+                    double d = mag(table_.pockets[p].center[0] - b.x, table_.pockets[p].center[1] - b.y);
+                    if (d < best) {
+                        best = d;
+                        b.pocket = static_cast<int>(p);
+                    }
+                }
+                b.vx = 0;
+                b.vy = 0;
+                b.state = BALL_POCKETED;
+                --rolling_;
+                on_table_ &= ~ballBit(i);
+                ++stats_.pocketed;
+                break;
+            }
+            case EVENT_COLLISION: {
+                size_t j = e.other;
+                SimBall& o = balls_[j];
+                advance(j, now_);
+                changed |= ballBit(j);
+                double nx = o.x - b.x;
+                double ny = o.y - b.y;
+                double d = mag(nx, ny);
+                nx /= d;
+                ny /= d;
+                // Equal masses: exchange the velocity components along the
+                // line of centres
+                double closing = (o.vx - b.vx) * nx + (o.vy - b.vy) * ny;
+                if (closing < 0) {
+                    b.vx += closing * nx;
+                    b.vy += closing * ny;
+                    o.vx -= closing * nx;
+                    o.vy -= closing * ny;
+                }
+                for (SimBall* s : {&b, &o}) {
+                    bool moving = mag(s->vx, s->vy) > 1e-9;
+                    if (moving && s->state == BALL_RESTING) ++rolling_;
+                    if (!moving && s->state == BALL_ROLLING) --rolling_;
+                    s->state = moving ? BALL_ROLLING : BALL_RESTING;
+                    if (!moving) s->vx = s->vy = 0;
+                }
+                if (b.first_contact < 0) b.first_contact = static_cast<int>(j);
+                if (o.first_contact < 0) o.first_contact = static_cast<int>(i);
+                ++stats_.collisions;
+                break;
+            }
+            case EVENT_NONE:
+                break;
+        }
+        ++stats_.events;
+        ++processed;
+        afterMotionChange(changed);
+    }
+    stats_.broadphase_swaps = broadphase_.swaps();
+    stats_.stale_events = queue_.stats().stale_dropped;
+    return processed;
+}
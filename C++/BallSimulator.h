@@ -0,0 +1,176 @@
+// BallSimulator.h
+// ===========================================================================
+// Event-driven simulation of all balls on the table after a strike.
+//
+// Motion model (the same stun-shot model SafetyPlanner and rollOnTable
+// use, now with time):
+// - a moving ball rolls straight and slows down at a constant rate, so a
+//   ball sent to roll D mm on an open table has speed sqrt(2 * a * D)
+// - balls collide elastically with equal masses and no friction: the
+//   velocity components along the line of centres are exchanged
+// - cushions reflect the velocity (angle in = angle out)
+// - a ball crossing a rail line through a pocket mouth is pocketed
+//
+// The simulation jumps from event to event (collision, cushion, pocket,
+// stop). Each ball's own next event (cushion, pocket or stop) is found in
+// closed form; it fixes the stretch of table the ball sweeps until then.
+// Those swept boxes go into a SweepAndPrune broadphase, so after an event
+// only the balls whose boxes overlap the changed balls' boxes get the
+// exact collision time test (the first root of a quartic in time).
+//
+// The next event of every ball sits in a fixed-capacity EventQueue; a ball
+// whose next event changes is rescheduled there, and its old entry goes
+// stale by epoch instead of being searched for.
+//
+// All state is sized for MAX_MASK_BALLS balls in the constructor. After
+// that reset(), strike() and run() never allocate, so one simulator reused
+// over many rollouts costs no allocation per rollout.
+//
+// Ball sets are BallMask bitboards, so at most MAX_MASK_BALLS balls.
+// ===========================================================================
+
+#ifndef BALL_SIMULATOR_H
+#define BALL_SIMULATOR_H
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "BallMask.h"
+#include "EventQueue.h"
+#include "SweepAndPrune.h"
+#include "TableModel.h"
+
+// Rolling deceleration (mm/s^2), about 1 % of g
+const double ROLLING_DECELERATION = 100.0;
+
+// Events processed per run() before giving up
+const size_t DEFAULT_MAX_SIM_EVENTS = 1000;
+
+enum SimBallState {
+    BALL_RESTING,
+    BALL_ROLLING,
+    BALL_POCKETED
+};
+
+// ---------------------------------------------------------------------------
+// Counters since the last reset():
+// - events: events processed (collisions + cushions + pockets + stops)
+// - collisions / cushion_hits / pocketed: per event type
+// - pair_tests: exact collision time tests run
+// - broadphase_swaps: box end swaps in the broadphase
+// - stale_events: superseded event queue entries dropped
+// ---------------------------------------------------------------------------
+struct SimStats {
+    size_t events;
+    size_t collisions;
+    size_t cushion_hits;
+    size_t pocketed;
+    size_t pair_tests;
+    size_t broadphase_swaps;
+    size_t stale_events;
+};
+
+class BallSimulator {
+public:
+    // -----------------------------------------------------------------------
+    // - table: cushions and pockets (must outlive the simulator)
+    // - ball_radius: contact distance is twice this
+    // - use_broadphase: false tests every pair after each event (reference
+    //   for the broadphase; same events, same results)
+    // -----------------------------------------------------------------------
+    BallSimulator(
+        const TableModel& table,
+        double ball_radius,
+        bool use_broadphase = true,
+        double deceleration = ROLLING_DECELERATION
+    );
+
+    // Places the balls at rest, clock at 0 (at most MAX_MASK_BALLS balls)
+    void reset(const std::vector<std::vector<double>>& balls);
+
+    // Gives a resting ball velocity (vx, vy) in mm/s at the current time
+    void strike(size_t ball, double vx, double vy);
+
+    // Speed that makes a ball roll 'distance' mm before stopping
+    double speedForRoll(double distance) const;
+
+    // -----------------------------------------------------------------------
+    // Processes events until every ball has stopped or dropped, the clock
+    // would pass 'max_time' (seconds; balls are then moved to max_time), or
+    // 'max_events' events have been processed. Returns the events processed.
+    // -----------------------------------------------------------------------
+    size_t run(
+        double max_time = std::numeric_limits<double>::infinity(),
+        size_t max_events = DEFAULT_MAX_SIM_EVENTS
+    );
+
+    // True if no ball is moving
+    bool settled() const { return rolling_ == 0; }
+
+    double time() const { return now_; }
+    size_t ballCount() const { return balls_.size(); }
+
+    // Position of a ball at the current time
+    void position(size_t ball, double& x, double& y) const;
+
+    SimBallState state(size_t ball) const { return balls_[ball].state; }
+
+    // Pocket the ball dropped into (index into table.pockets), or -1
+    int pocket(size_t ball) const { return balls_[ball].pocket; }
+
+    // First ball this ball touched, or -1
+    int firstContact(size_t ball) const { return balls_[ball].first_contact; }
+
+    const SimStats& stats() const { return stats_; }
+
+private:
+    // Ball state at time t0; the position at t follows from the motion model
+    struct SimBall {
+        double x, y;
+        double vx, vy;
+        double t0;
+        SimBallState state;
+        int pocket;
+        int first_contact;
+    };
+
+    enum EventType {
+        EVENT_NONE,
+        EVENT_STOP,
+        EVENT_CUSHION,
+        EVENT_POCKET,
+        EVENT_COLLISION
+    };
+
+    // Next event of one ball; 'other' is the partner ball or the cushion
+    struct Event {
+        double time;
+        EventType type;
+        size_t other;
+    };
+
+    void motionAt(size_t i, double t, double& x, double& y, double& vx, double& vy) const;
+    void advance(size_t i, double t);
+    void computeOwnEvent(size_t i);
+    double collisionTime(size_t i, size_t j);
+    BallMask candidates(size_t i) const;
+    void scheduleNext(size_t i);
+    void afterMotionChange(BallMask changed);
+
+    const TableModel& table_;
+    double radius_;
+    double deceleration_;
+    bool use_broadphase_;
+
+    std::vector<SimBall> balls_;
+    std::vector<Event> own_;   // cushion, pocket or stop
+    std::vector<Event> next_;  // earliest of own_ and the collisions
+    EventQueue queue_;         // next_ times
+    SweepAndPrune broadphase_;
+    BallMask on_table_;
+    size_t rolling_;
+    double now_;
+    SimStats stats_;
+};
+
+#endif // BALL_SIMULATOR_H
@@ -0,0 +1,123 @@
+// BankPlanner.cpp
+// ===========================================================================
+// Implements the cushion arrays and the mirrored-pocket bank shot generator.
+// ===========================================================================
+
+#include "BankPlanner.h"
+#include "GeometryUtils.h"
+#include <algorithm>
+#include <cmath>
+
+CushionLines buildCushionLines(const TableModel& table) {
+    CushionLines lines;
+    for (const auto& c : table.cushions) {
+        double nx = c.normal[0];
+        double ny = c.normal[1];
+        lines.nx.push_back(nx);
+        lines.ny.push_back(ny);
+        lines.centre_offset.push_back(c.centre_offset);
+        lines.m00.push_back(c.reflect[0]);
+        lines.m01.push_back(c.reflect[1]);
+        lines.m02.push_back(c.reflect[2]);
+        lines.m10.push_back(c.reflect[3]);
+        lines.m11.push_back(c.reflect[4]);
+        lines.m12.push_back(c.reflect[5]);
+        lines.along_lo.push_back(ny * c.start[0] - nx * c.start[1]);
+        lines.along_hi.push_back(ny * c.end[0] - nx * c.end[1]);
+    }
+    return lines;
+}
+
+// ---------------------------------------------------------------------------
+// Batched pass over all cushions for one (target, pocket): mirrors the
+// pocket with each cushion's reflection matrix and intersects the
+// target->mirror line with the cushion. valid[k] is positive if both the
+// target and the pocket are on the table side of cushion k and the contact
+// lands on its segment. Branch-free, with restrict pointers so it
+// vectorizes with the planner flags (the division and the min selects
+// need -fno-trapping-math; -O2 keeps it scalar).
+// ---------------------------------------------------------------------------
+static void mirrorAcrossCushions(
+    size_t count, const CushionLines& c,
+    double tx, double ty, double px, double py,
+    double* __restrict contact_x, double* __restrict contact_y,
+    double* __restrict path_sq, double* __restrict valid
+) {
+    const double* __restrict nx = c.nx.data();
+    const double* __restrict ny = c.ny.data();
+    const double* __restrict offset = c.centre_offset.data();
+    const double* __restrict m00 = c.m00.data();
+    const double* __restrict m01 = c.m01.data();
+    const double* __restrict m02 = c.m02.data();
+    const double* __restrict m10 = c.m10.data();
+    const double* __restrict m11 = c.m11.data();
+    const double* __restrict m12 = c.m12.data();
+    const double* __restrict along_lo = c.along_lo.data();
+    const double* __restrict along_hi = c.along_hi.data();
+    for (size_t k = 0; k < count; ++k) {
+        double s_t = nx[k] * tx + ny[k] * ty - offset[k];
+        double s_p = nx[k] * px + ny[k] * py - offset[k];
+        double mirror_x = m00[k] * px + m01[k] * py + m02[k];
+        double mirror_y = m10[k] * px + m11[k] * py + m12[k];
+        double dx = mirror_x - tx;
+        double dy = mirror_y - ty;
+        // The contact divides the path in the ratio of the cushion distances
+        double frac = s_t / (s_t + s_p);
+        double cx = tx + frac * dx;
+        double cy = ty + frac * dy;
+        double along = ny[k] * cx - nx[k] * cy;
+        contact_x[k] = cx;
+        contact_y[k] = cy;
+        path_sq[k] = dx * dx + dy * dy;
+        valid[k] = std::min(std::min(s_t, s_p), std::min(along - along_lo[k], along_hi[k] - along));
+    }
+}
+
+std::vector<BankShot> generateBankShots(
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& balls,
+    const std::vector<Pocket>& pockets,
+    const CushionLines& cushions,
+    double bound_radius,
+    const std::vector<bool>& strikable,
+    const CancellationToken* cancel
+) {
+    std::vector<BankShot> shots;
+    const size_t cushion_count = cushions.nx.size();
+
+    // Per-cushion results of the batched pass for one (target, pocket)
+    std::vector<double> contact_x(cushion_count), contact_y(cushion_count);
+    std::vector<double> path_sq(cushion_count);
+    std::vector<double> valid(cushion_count);
+
+    for (size_t t = 0; t < balls.size(); ++t) {
+        if (!strikable.empty() && !strikable[t]) continue;
+        if (cancel && cancel->expired()) break;
+        const double tx = balls[t][0];
+        const double ty = balls[t][1];
+        const double cue_leg = mag(tx - cueball_pos[0], ty - cueball_pos[1]);
+
+        for (size_t p = 0; p < pockets.size(); ++p) {
+            const double px = pockets[p].center[0];
+            const double py = pockets[p].center[1];
+
+            mirrorAcrossCushions(cushion_count, cushions, tx, ty, px, py,
+                                 contact_x.data(), contact_y.data(), path_sq.data(), valid.data());
+
+            for (size_t k = 0; k < cushion_count; ++k) {
+                if (!(valid[k] > 0)) continue;
+                double cx = contact_x[k];
+                double cy = contact_y[k];
+                // Same cut test as isCutAngleFeasible, towards the contact
+                if (!angleBelow(tx - cueball_pos[0], ty - cueball_pos[1], cx - tx, cy - ty, CUT_ANGLE_COS_LIMIT)) continue;
+
+                // Leg off the cushion must enter between the jaws
+                double lo, hi;
+                if (!pocketAcceptance(pockets[p], cx, cy, bound_radius, lo, hi) || lo >= 0 || hi <= 0) continue;
+
+                shots.push_back({t, k, p, {cx, cy}, cue_leg + std::sqrt(path_sq[k]), std::min(-lo, hi)});
+            }
+        }
+    }
+    return shots;
+}
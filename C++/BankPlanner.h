@@ -0,0 +1,101 @@
+// BankPlanner.h
+// ===========================================================================
+// Plans object-ball bank shots: the cue ball hits the target directly and
+// the target banks off one cushion into a pocket.
+//
+// Each pocket is mirrored across each cushion (TableModel). A straight line from
+// the target to a mirrored pocket crosses the cushion exactly where the
+// target must bounce (angle in = angle out), and its length is the length
+// of the banked path. All (target, cushion, pocket) triples are produced
+// in one pass; the innermost loop runs over the cushions, stored as
+// parallel arrays, with no branches so it vectorizes with the planner
+// flags (-O3 -fno-math-errno -fno-trapping-math, .vscode/tasks.json).
+//
+// Like computeFlipShot, the generator only does geometry and angle
+// pruning; ShotSearch ranks the result and runs the clearance tests.
+// ===========================================================================
+
+#ifndef BANK_PLANNER_H
+#define BANK_PLANNER_H
+
+#include <cstddef>
+#include <vector>
+#include "CancellationToken.h"
+#include "PocketModel.h"
+#include "TableModel.h"
+
+// ---------------------------------------------------------------------------
+// Cushions of a TableModel as parallel arrays, one entry per cushion (same
+// order as table.cushions):
+// - nx / ny / centre_offset: line of ball centres at contact,
+//   nx * x + ny * y = centre_offset, with (nx, ny) pointing into the table
+// - m00..m12: the cushion's reflection matrix (Cushion::reflect)
+// - along_lo / along_hi: extent of the cushion segment measured along the
+//   rail direction (ny, -nx); contacts outside it are in a pocket mouth
+// ---------------------------------------------------------------------------
+struct CushionLines {
+    std::vector<double> nx;
+    std::vector<double> ny;
+    std::vector<double> centre_offset;
+    std::vector<double> m00, m01, m02;
+    std::vector<double> m10, m11, m12;
+    std::vector<double> along_lo;
+    std::vector<double> along_hi;
+};
+
+// ---------------------------------------------------------------------------
+// Copies the cushions of 'table' into parallel arrays.
+// ---------------------------------------------------------------------------
+CushionLines buildCushionLines(const TableModel& table);
+
+// ---------------------------------------------------------------------------
+// One object-ball bank shot:
+// - target: index of the ball struck by the cue ball
+// - cushion / pocket: indices of the cushion banked off and the pocket
+// - contact: where the target's centre meets the cushion (on its line of
+//   ball centres)
+// - total_distance: cue->target + target->mirrored pocket (the unfolded
+//   banked path), ball centres
+// - aim_margin: how far the target's direction off the cushion may deviate
+//   from the pocket centre and still clear the jaws (radians)
+// ---------------------------------------------------------------------------
+struct BankShot {
+    size_t target;
+    size_t cushion;
+    size_t pocket;
+    std::vector<double> contact;
+    double total_distance;
+    double aim_margin;
+};
+
+// ---------------------------------------------------------------------------
+// Builds every geometrically playable bank shot.
+//
+// - balls: child balls (bank targets)
+// - cushions: built by buildCushionLines from the same table as 'pockets'
+// - bound_radius: clearance margin (ball diameter) for the jaw windows
+//
+// Pruned without any obstacle test:
+// - the cue->target->contact cut must pass CUT_ANGLE_COS_LIMIT
+// - the target must bounce between the pocket's and its own position
+//   (both on the table side of the cushion)
+// - the contact must land on the cushion segment, not in a pocket mouth
+// - the path from the contact to the pocket centre must fall inside the
+//   pocket's jaw window
+//
+// 'strikable' (optional, one flag per ball) restricts the targets to balls
+// the cue ball can reach; an empty vector allows every ball. 'cancel' is
+// polled once per target; once it expires the shots found so far are
+// returned.
+// ---------------------------------------------------------------------------
+std::vector<BankShot> generateBankShots(
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& balls,
+    const std::vector<Pocket>& pockets,
+    const CushionLines& cushions,
+    double bound_radius,
+    const std::vector<bool>& strikable = std::vector<bool>(),
+    const CancellationToken* cancel = nullptr
+);
+
+#endif // BANK_PLANNER_H
@@ -0,0 +1,428 @@
+// BatchRollout.cpp
+// ===========================================================================
+// Implements the lockstep batch rollout and its scalar reference.
+//
+// Every lane loop below repeats the arithmetic of the scalar path (first
+// contact, stun split, rollOnTable, isPathObstructed) operation for
+// operation, with selects in place of branches, so the lanes give the
+// same bits as the reference.
+// ===========================================================================
+
+// The lane loops vectorize with the planner flags (-O3 -fno-math-errno
+// -fno-trapping-math, see .vscode/tasks.json) but only pay off with AVX2
+// (masked selects on 4 doubles; at the baseline SSE2 the batch is slower
+// than the scalar path). With g++ on x86-64 Linux the lane functions are
+// therefore compiled twice, for AVX2 and the baseline, and the version is
+// picked when the program loads. None of this changes results: no
+// reassociation, and no FMA (the planner flags include -ffp-contract=off).
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__) && !defined(__AVX2__)
+#define LANE_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#define LANE_CLONES
+#endif
+
+#include "BatchRollout.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+static const size_t L = ROLLOUT_LANES;
+
+// ---------------------------------------------------------------------------
+// Per-lane state of one batch. The roll fields hold the ball currently
+// rolled (the target, then the cue ball) in the form rollOnTable takes it;
+// the leg fields are scratch for one cushion leg. Flags and counts are
+// 64-bit like the coordinates, so a lane mask is as wide as a lane value
+// and the selects vectorize.
+// ---------------------------------------------------------------------------
+struct BatchRollout::Lanes {
+    // Roll state
+    double x[L], y[L], dx[L], dy[L], distance[L];
+    double end_x[L], end_y[L];
+    int64_t exclude[L];   // ball that is not an obstacle, -1 for none
+    int64_t bounces[L];
+    int64_t result[L];
+    int64_t active[L];    // still rolling
+
+    // Current leg
+    double t_line[L], t_cushion[L];
+    double hit_nx[L], hit_ny[L];
+    int64_t hit[L];
+    double to_x[L], to_y[L];
+    int64_t stop[L];
+    int64_t test[L];      // leg needs the obstacle test
+    int64_t blocked[L];
+};
+
+bool sameOutcome(const RolloutOutcome& a, const RolloutOutcome& b) {
+    return a.target == b.target &&
+           a.object_result == b.object_result && a.object_x == b.object_x && a.object_y == b.object_y &&
+           a.object_bounces == b.object_bounces &&
+           a.cue_result == b.cue_result && a.cue_x == b.cue_x && a.cue_y == b.cue_y &&
+           a.cue_bounces == b.cue_bounces;
+}
+
+BatchRollout::BatchRollout(
+    const TableModel& table,
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& childballs,
+    double bound_radius
+) : table_(table), cue_x_(cueball_pos[0]), cue_y_(cueball_pos[1]),
+    radius_(bound_radius), balls_(childballs) {
+    for (const auto& b : childballs) {
+        ball_x_.push_back(b[0]);
+        ball_y_.push_back(b[1]);
+    }
+    for (const auto& c : table.cushions) {
+        nx_.push_back(c.normal[0]);
+        ny_.push_back(c.normal[1]);
+        centre_offset_.push_back(c.centre_offset);
+        start_x_.push_back(c.start[0]);
+        start_y_.push_back(c.start[1]);
+        double sx = c.end[0] - c.start[0];
+        double sy = c.end[1] - c.start[1];
+        seg_x_.push_back(sx);
+        seg_y_.push_back(sy);
+        seg_len_sq_.push_back(sx * sx + sy * sy);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Distance along (ax, ay) from (x, y) to the first rail line ahead, as the
+// first leg of rollOnTable finds it.
+// ---------------------------------------------------------------------------
+static double firstRailLine(const TableModel& table, double x, double y, double ax, double ay) {
+    double t_line = std::numeric_limits<double>::max();
+    for (const auto& c : table.cushions) {
+        double approach = c.normal[0] * ax + c.normal[1] * ay;
+        if (approach >= 0) continue;
+        double t = (c.centre_offset - c.normal[0] * x - c.normal[1] * y) / approach;
+        if (t < 0) t = 0;
+        t_line = std::min(t_line, t);
+    }
+    return t_line;
+}
+
+RolloutOutcome BatchRollout::reference(const RolloutVariant& v) const {
+    RolloutOutcome out = {-1, ROLL_STOPPED, 0, 0, 0, ROLL_STOPPED, 0, 0, 0};
+    const double r_sq = radius_ * radius_;
+
+    // First ball on the cue ball's line
+    double t_hit = std::numeric_limits<double>::max();
+    for (size_t j = 0; j < balls_.size(); ++j) {
+        double wx = balls_[j][0] - cue_x_;
+        double wy = balls_[j][1] - cue_y_;
+        double along = v.aim_x * wx + v.aim_y * wy;
+        double gap = r_sq - ((wx * wx + wy * wy) - along * along);
+        if (along <= 0 || gap <= 0) continue;
+        double t = along - std::sqrt(gap);
+        if (t < 0) t = 0;
+        if (t < t_hit) {
+            t_hit = t;
+            out.target = static_cast<int>(j);
+        }
+    }
+    double t_line = firstRailLine(table_, cue_x_, cue_y_, v.aim_x, v.aim_y);
+    if (out.target < 0 || t_hit >= v.roll || t_hit >= t_line) {
+        out.target = -1;
+        out.cue_result = rollOnTable(table_, cue_x_, cue_y_, v.aim_x, v.aim_y, v.roll, balls_, radius_,
+                                     out.cue_x, out.cue_y, out.cue_bounces);
+        return out;
+    }
+
+    // Stun split at contact
+    double cx = cue_x_ + t_hit * v.aim_x;
+    double cy = cue_y_ + t_hit * v.aim_y;
+    double tx = balls_[out.target][0];
+    double ty = balls_[out.target][1];
+    double ux = tx - cx;
+    double uy = ty - cy;
+    double u_len = std::sqrt(ux * ux + uy * uy);
+    ux /= u_len;
+    uy /= u_len;
+    double cos_cut = std::min(1.0, v.aim_x * ux + v.aim_y * uy);
+    double remaining = v.roll - t_hit;
+    double object_roll = remaining * (cos_cut * cos_cut);
+    double cue_roll = remaining * (1 - cos_cut * cos_cut);
+    double gx = v.aim_x - cos_cut * ux;
+    double gy = v.aim_y - cos_cut * uy;
+    double g_len = std::sqrt(gx * gx + gy * gy);
+    if (g_len > 1e-9) {
+        gx /= g_len;
+        gy /= g_len;
+    } else {
+        gx = v.aim_x;
+        gy = v.aim_y;
+    }
+
+    std::vector<std::vector<double>> others;
+    others.reserve(balls_.size());
+    for (size_t j = 0; j < balls_.size(); ++j) {
+        if (static_cast<int>(j) != out.target) others.push_back(balls_[j]);
+    }
+    out.object_result = rollOnTable(table_, tx, ty, ux, uy, object_roll, others, radius_,
+                                    out.object_x, out.object_y, out.object_bounces);
+    out.cue_result = rollOnTable(table_, cx, cy, gx, gy, cue_roll, others, radius_,
+                                 out.cue_x, out.cue_y, out.cue_bounces);
+    return out;
+}
+
+// ---------------------------------------------------------------------------
+// Sets lanes.blocked for the lanes whose current leg needs the obstacle
+// test: isPathObstructed from (x, y) to (to_x, to_y) over every ball but
+// the excluded one, box reject and capsule test as selects.
+// ---------------------------------------------------------------------------
+LANE_CLONES
+void BatchRollout::markBlocked(Lanes& s) const {
+    const double r = radius_;
+    const double r_sq = r * r;
+    for (size_t l = 0; l < L; ++l) s.blocked[l] = 0;
+    for (size_t j = 0; j < ball_x_.size(); ++j) {
+        const double ox = ball_x_[j];
+        const double oy = ball_y_[j];
+        const int64_t id = static_cast<int64_t>(j);
+        for (size_t l = 0; l < L; ++l) {
+            double x1 = s.x[l], y1 = s.y[l];
+            double x2 = s.to_x[l], y2 = s.to_y[l];
+            int64_t skip = (s.exclude[l] == id) | ((ox == x2) & (oy == y2)) | ((ox == x1) & (oy == y1));
+            double lo_x = x1 < x2 ? x1 : x2, hi_x = x1 < x2 ? x2 : x1;
+            double lo_y = y1 < y2 ? y1 : y2, hi_y = y1 < y2 ? y2 : y1;
+            int64_t outside = (ox < lo_x - r) | (ox > hi_x + r) | (oy < lo_y - r) | (oy > hi_y + r);
+            double vec_x = x2 - x1, vec_y = y2 - y1;
+            double w_x = ox - x1, w_y = oy - y1;
+            double e_x = ox - x2, e_y = oy - y2;
+            double len_sq = vec_x * vec_x + vec_y * vec_y;
+            double proj = w_x * vec_x + w_y * vec_y;
+            double cross = vec_x * w_y - vec_y * w_x;
+            // insideCapsule: nearest point is the start, the end or between
+            double near = proj <= 0 ? w_x * w_x + w_y * w_y : e_x * e_x + e_y * e_y;
+            int64_t inside = (proj > 0) & (proj < len_sq) ? cross * cross < r_sq * len_sq : near < r_sq;
+            s.blocked[l] |= s.test[l] & (skip ^ 1) & (outside ^ 1) & inside;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// rollOnTable for every active lane at once. One pass of the outer loop is
+// one cushion leg of every lane still rolling; lanes that stop, drop,
+// block or run out of bounces leave the active mask with their result.
+// ---------------------------------------------------------------------------
+LANE_CLONES
+void BatchRollout::rollLanes(Lanes& s) const {
+    const size_t cushions = nx_.size();
+    const double far = std::numeric_limits<double>::max();
+    for (int leg = 0; leg <= MAX_ROLL_BOUNCES; ++leg) {
+        int64_t rolling = 0;
+        for (size_t l = 0; l < L; ++l) rolling |= s.active[l];
+        if (rolling == 0) return;
+
+        for (size_t l = 0; l < L; ++l) {
+            s.end_x[l] = s.active[l] ? s.x[l] : s.end_x[l];
+            s.end_y[l] = s.active[l] ? s.y[l] : s.end_y[l];
+            s.t_line[l] = far;
+            s.t_cushion[l] = far;
+            s.hit_nx[l] = 0;
+            s.hit_ny[l] = 0;
+            s.hit[l] = 0;
+        }
+
+        // Nearest rail line ahead, and nearest cushion segment ahead
+        for (size_t k = 0; k < cushions; ++k) {
+            const double nx = nx_[k], ny = ny_[k], offset = centre_offset_[k];
+            const double sx0 = start_x_[k], sy0 = start_y_[k];
+            const double sx = seg_x_[k], sy = seg_y_[k], len_sq = seg_len_sq_[k];
+            for (size_t l = 0; l < L; ++l) {
+                double approach = nx * s.dx[l] + ny * s.dy[l];
+                int64_t ahead = approach < 0;
+                double t = (offset - nx * s.x[l] - ny * s.y[l]) / (ahead ? approach : -1.0);
+                t = t < 0 ? 0 : t;
+                s.t_line[l] = ahead & (t < s.t_line[l]) ? t : s.t_line[l];
+                double hx = s.x[l] + t * s.dx[l] - sx0;
+                double hy = s.y[l] + t * s.dy[l] - sy0;
+                double along = hx * sx + hy * sy;
+                int64_t take = ahead & (along >= 0) & (along <= len_sq) & (t < s.t_cushion[l]);
+                s.t_cushion[l] = take ? t : s.t_cushion[l];
+                s.hit_nx[l] = take ? nx : s.hit_nx[l];
+                s.hit_ny[l] = take ? ny : s.hit_ny[l];
+                s.hit[l] |= take;
+            }
+        }
+
+        // Leg end: the stop, or the cushion; pocket mouths need no test
+        for (size_t l = 0; l < L; ++l) {
+            int64_t stop = s.t_line[l] >= s.distance[l];
+            int64_t miss = (s.hit[l] ^ 1) | (s.t_cushion[l] > s.t_line[l] + 1e-9);
+            double travel = stop ? s.distance[l] : s.t_cushion[l];
+            travel = (stop | (miss ^ 1)) ? travel : 0.0;
+            s.to_x[l] = s.x[l] + travel * s.dx[l];
+            s.to_y[l] = s.y[l] + travel * s.dy[l];
+            s.stop[l] = stop;
+            s.test[l] = s.active[l] & (stop | (miss ^ 1));
+        }
+        markBlocked(s);
+
+        for (size_t l = 0; l < L; ++l) {
+            int64_t active = s.active[l];
+            int64_t stop = s.stop[l];
+            int64_t blocked = s.blocked[l];
+            // Not tested and not stopping: a pocket mouth
+            int64_t ends = blocked | stop | (s.test[l] ^ 1);
+            int64_t outcome = blocked ? ROLL_BLOCKED : (stop ? ROLL_STOPPED : ROLL_POCKETED);
+            int64_t stopped = active & stop & (blocked ^ 1);
+            s.end_x[l] = stopped ? s.to_x[l] : s.end_x[l];
+            s.end_y[l] = stopped ? s.to_y[l] : s.end_y[l];
+            s.result[l] = active & ends ? outcome : s.result[l];
+
+            int64_t bounce = active & (ends ^ 1);
+            double approach = s.hit_nx[l] * s.dx[l] + s.hit_ny[l] * s.dy[l];
+            double dx = s.dx[l] - 2 * approach * s.hit_nx[l];
+            double dy = s.dy[l] - 2 * approach * s.hit_ny[l];
+            s.dx[l] = bounce ? dx : s.dx[l];
+            s.dy[l] = bounce ? dy : s.dy[l];
+            s.x[l] = bounce ? s.to_x[l] : s.x[l];
+            s.y[l] = bounce ? s.to_y[l] : s.y[l];
+            s.distance[l] = bounce ? s.distance[l] - s.t_cushion[l] : s.distance[l];
+            s.bounces[l] += bounce;
+            s.active[l] = bounce;
+        }
+    }
+    for (size_t l = 0; l < L; ++l) {
+        s.result[l] = s.active[l] ? static_cast<int64_t>(ROLL_TOO_MANY_BOUNCES) : s.result[l];
+    }
+}
+
+LANE_CLONES
+void BatchRollout::runBatch(const RolloutVariant* v, RolloutOutcome* outcomes) const {
+    Lanes s;
+    double ax[L], ay[L], roll[L];
+    double t_hit[L], t_line[L], tx[L], ty[L];
+    int64_t target[L];
+    const double r_sq = radius_ * radius_;
+    const double far = std::numeric_limits<double>::max();
+    for (size_t l = 0; l < L; ++l) {
+        ax[l] = v[l].aim_x;
+        ay[l] = v[l].aim_y;
+        roll[l] = v[l].roll;
+        t_hit[l] = far;
+        t_line[l] = far;
+        tx[l] = 0;
+        ty[l] = 0;
+        target[l] = -1;
+    }
+
+    // ---- First ball on each cue ball line, and the first rail line ----------
+    for (size_t j = 0; j < ball_x_.size(); ++j) {
+        const double wx = ball_x_[j] - cue_x_;
+        const double wy = ball_y_[j] - cue_y_;
+        const double w_sq = wx * wx + wy * wy;
+        const int64_t id = static_cast<int64_t>(j);
+        for (size_t l = 0; l < L; ++l) {
+            double along = ax[l] * wx + ay[l] * wy;
+            double gap = r_sq - (w_sq - along * along);
+            int64_t touch = (along > 0) & (gap > 0);
+            double t = along - std::sqrt(touch ? gap : 0.0);
+            t = t < 0 ? 0 : t;
+            int64_t take = touch & (t < t_hit[l]);
+            t_hit[l] = take ? t : t_hit[l];
+            target[l] = take ? id : target[l];
+            tx[l] = take ? ball_x_[j] : tx[l];
+            ty[l] = take ? ball_y_[j] : ty[l];
+        }
+    }
+    for (size_t k = 0; k < nx_.size(); ++k) {
+        const double nx = nx_[k], ny = ny_[k];
+        const double gap = centre_offset_[k] - nx * cue_x_ - ny * cue_y_;
+        for (size_t l = 0; l < L; ++l) {
+            double approach = nx * ax[l] + ny * ay[l];
+            int64_t ahead = approach < 0;
+            double t = gap / (ahead ? approach : -1.0);
+            t = t < 0 ? 0 : t;
+            t_line[l] = ahead & (t < t_line[l]) ? t : t_line[l];
+        }
+    }
+
+    // ---- Stun split; lanes without contact roll the cue ball out ------------
+    int64_t contact[L];
+    double cx[L], cy[L], gx[L], gy[L], cue_roll[L];
+    for (size_t l = 0; l < L; ++l) {
+        contact[l] = (target[l] >= 0) & (t_hit[l] < roll[l]) & (t_hit[l] < t_line[l]);
+        double t = contact[l] ? t_hit[l] : 0.0;
+        cx[l] = cue_x_ + t * ax[l];
+        cy[l] = cue_y_ + t * ay[l];
+        double ux = tx[l] - cx[l];
+        double uy = ty[l] - cy[l];
+        double u_len = std::sqrt(ux * ux + uy * uy);
+        u_len = contact[l] ? u_len : 1.0;
+        ux /= u_len;
+        uy /= u_len;
+        double cos_cut = std::min(1.0, ax[l] * ux + ay[l] * uy);
+        double remaining = roll[l] - t;
+        double object_roll = remaining * (cos_cut * cos_cut);
+        double g_x = ax[l] - cos_cut * ux;
+        double g_y = ay[l] - cos_cut * uy;
+        double g_len = std::sqrt(g_x * g_x + g_y * g_y);
+        int64_t tangent = g_len > 1e-9;
+        double g_div = tangent ? g_len : 1.0;
+        gx[l] = contact[l] & tangent ? g_x / g_div : ax[l];
+        gy[l] = contact[l] & tangent ? g_y / g_div : ay[l];
+        cue_roll[l] = contact[l] ? remaining * (1 - cos_cut * cos_cut) : roll[l];
+        target[l] = contact[l] ? target[l] : -1;
+
+        s.x[l] = tx[l];
+        s.y[l] = ty[l];
+        s.dx[l] = ux;
+        s.dy[l] = uy;
+        s.distance[l] = object_roll;
+        s.end_x[l] = 0;
+        s.end_y[l] = 0;
+        s.exclude[l] = target[l];
+        s.bounces[l] = 0;
+        s.result[l] = ROLL_STOPPED;
+        s.active[l] = contact[l];
+    }
+    rollLanes(s);
+    for (size_t l = 0; l < L; ++l) {
+        outcomes[l].target = static_cast<int>(target[l]);
+        outcomes[l].object_result = static_cast<RollResult>(s.result[l]);
+        outcomes[l].object_x = s.end_x[l];
+        outcomes[l].object_y = s.end_y[l];
+        outcomes[l].object_bounces = static_cast<int>(s.bounces[l]);
+    }
+
+    for (size_t l = 0; l < L; ++l) {
+        s.x[l] = cx[l];
+        s.y[l] = cy[l];
+        s.dx[l] = gx[l];
+        s.dy[l] = gy[l];
+        s.distance[l] = cue_roll[l];
+        s.end_x[l] = 0;
+        s.end_y[l] = 0;
+        s.exclude[l] = target[l];
+        s.bounces[l] = 0;
+        s.result[l] = ROLL_STOPPED;
+        s.active[l] = 1;
+    }
+    rollLanes(s);
+    for (size_t l = 0; l < L; ++l) {
+        outcomes[l].cue_result = static_cast<RollResult>(s.result[l]);
+        outcomes[l].cue_x = s.end_x[l];
+        outcomes[l].cue_y = s.end_y[l];
+        outcomes[l].cue_bounces = static_cast<int>(s.bounces[l]);
+    }
+}
+
+void BatchRollout::run(const RolloutVariant* variants, size_t count, RolloutOutcome* outcomes) const {
+    size_t full = count - count % L;
+    for (size_t i = 0; i < full; i += L) {
+        runBatch(variants + i, outcomes + i);
+    }
+    if (full == count) return;
+    RolloutVariant padded[L];
+    RolloutOutcome results[L];
+    for (size_t l = 0; l < L; ++l) {
+        padded[l] = variants[std::min(full + l, count - 1)];
+    }
+    runBatch(padded, results);
+    std::copy(results, results + (count - full), outcomes + full);
+}
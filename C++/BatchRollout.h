@@ -0,0 +1,121 @@
+// BatchRollout.h
+// ===========================================================================
+// Batch rollout of many perturbed variants of one stun shot.
+//
+// Scoring a shot by rolling out small perturbations of it (aim angle, roll
+// distance) runs the same tiny simulation hundreds of times. One rollout
+// alone is too branchy to keep the SIMD units busy, so the batch engine
+// runs ROLLOUT_LANES independent rollouts side by side in lockstep: every
+// step is a loop over the lanes on structure-of-arrays state, written
+// without branches so the compiler vectorizes it. Lanes that have finished
+// are masked off and keep their result until the whole batch is done.
+//
+// The lane loops need the planner flags (-O3 -fno-math-errno
+// -fno-trapping-math, .vscode/tasks.json) and AVX2 to beat the scalar
+// path. With g++ on x86-64 Linux, BatchRollout.cpp builds its lane
+// functions for AVX2 and the baseline and picks one at load time.
+// Elsewhere (MinGW, MSVC, clang) add -mavx2 when the target has it, or
+// the batch is slower than the scalar path. On FMA targets (-mfma,
+// -march) keep -ffp-contract=off, otherwise fused multiply-adds make the
+// lanes and the reference differ in the last bit.
+//
+// Rollout model (the stun-shot model of SafetyPlanner and validateShot):
+// - the cue ball rolls straight along the aim; the first ball it touches
+//   before reaching a rail line and before stopping is the target
+// - at contact the target leaves along the line of centres with cos^2 of
+//   the cut of the remaining roll, the cue ball along the tangent line
+//   with sin^2 of it
+// - each then rolls with cushion bounces exactly as rollOnTable, with the
+//   other balls (not the target) as obstacles
+// - without a contact the cue ball rolls out the whole distance
+//
+// reference() runs one rollout with rollOnTable and gives the same result
+// bit for bit; it is the check for the batch path.
+// ===========================================================================
+
+#ifndef BATCH_ROLLOUT_H
+#define BATCH_ROLLOUT_H
+
+#include <cstddef>
+#include <vector>
+#include "TableModel.h"
+
+// Rollouts run side by side in one batch step. 8 doubles fill two AVX2 or
+// one AVX-512 register; 16 pays off with -mprefer-vector-width=512.
+const size_t ROLLOUT_LANES = 8;
+
+// ---------------------------------------------------------------------------
+// One variant of the shot:
+// - aim_x, aim_y: unit direction the cue ball is sent in
+// - roll: distance the cue ball would roll on an open table (mm)
+// ---------------------------------------------------------------------------
+struct RolloutVariant {
+    double aim_x, aim_y;
+    double roll;
+};
+
+// ---------------------------------------------------------------------------
+// Result of one rollout:
+// - target: index of the ball the cue ball hit first, or -1
+// - object_result / object_x, object_y / object_bounces: the target's roll
+//   as returned by rollOnTable (ROLL_STOPPED and zeros if no target)
+// - cue_result / cue_x, cue_y / cue_bounces: the cue ball's roll after
+//   contact, or its whole roll if nothing was hit
+// ---------------------------------------------------------------------------
+struct RolloutOutcome {
+    int target;
+    RollResult object_result;
+    double object_x, object_y;
+    int object_bounces;
+    RollResult cue_result;
+    double cue_x, cue_y;
+    int cue_bounces;
+};
+
+// Same target, results, rest positions and bounce counts
+bool sameOutcome(const RolloutOutcome& a, const RolloutOutcome& b);
+
+class BatchRollout {
+public:
+    // -----------------------------------------------------------------------
+    // Copies the balls and the cushions into parallel arrays.
+    // - table: cushions (pockets are the gaps between them)
+    // - cueball_pos / childballs: layout, as in the planners
+    // - bound_radius: contact distance between ball centres (ball diameter)
+    // -----------------------------------------------------------------------
+    BatchRollout(
+        const TableModel& table,
+        const std::vector<double>& cueball_pos,
+        const std::vector<std::vector<double>>& childballs,
+        double bound_radius
+    );
+
+    // -----------------------------------------------------------------------
+    // Rolls out variants[0..count) in batches of ROLLOUT_LANES and writes
+    // one outcome per variant. A short last batch pads the unused lanes
+    // with copies of the last variant.
+    // -----------------------------------------------------------------------
+    void run(const RolloutVariant* variants, size_t count, RolloutOutcome* outcomes) const;
+
+    // Scalar reference for one variant (rollOnTable per ball)
+    RolloutOutcome reference(const RolloutVariant& variant) const;
+
+private:
+    struct Lanes;
+
+    void runBatch(const RolloutVariant* variants, RolloutOutcome* outcomes) const;
+    void rollLanes(Lanes& lanes) const;
+    void markBlocked(Lanes& lanes) const;
+
+    const TableModel& table_;
+    double cue_x_, cue_y_;
+    double radius_;
+    std::vector<std::vector<double>> balls_;
+    // Balls, parallel arrays
+    std::vector<double> ball_x_, ball_y_;
+    // Cushions, parallel arrays (see Cushion)
+    std::vector<double> nx_, ny_, centre_offset_;
+    std::vector<double> start_x_, start_y_, seg_x_, seg_y_, seg_len_sq_;
+};
+
+#endif // BATCH_ROLLOUT_H
@@ -0,0 +1,50 @@
+// CancellationToken.h
+// ===========================================================================
+// Cooperative cancellation for planner loops.
+//
+// A token expires when cancel() is called (from any thread), when its
+// deadline passes, or when its parent token expires. Long-running loops
+// poll expired() once per candidate and return what they have so far.
+// Child tokens give one stage of a computation a tighter deadline while
+// still honouring the caller's.
+// ===========================================================================
+
+#ifndef CANCELLATION_TOKEN_H
+#define CANCELLATION_TOKEN_H
+
+#include <atomic>
+#include <chrono>
+
+// ---------------------------------------------------------------------------
+// - deadline: expiry time; time_point::max() for none
+// - parent: optional token whose expiry is inherited (must outlive this one)
+// ---------------------------------------------------------------------------
+class CancellationToken {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    explicit CancellationToken(
+        Clock::time_point deadline = Clock::time_point::max(),
+        const CancellationToken* parent = nullptr
+    ) : cancelled_(false), deadline_(deadline), parent_(parent) {}
+
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+
+    void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+
+    bool expired() const {
+        if (cancelled_.load(std::memory_order_relaxed)) return true;
+        if (deadline_ != Clock::time_point::max() && Clock::now() >= deadline_) return true;
+        return parent_ && parent_->expired();
+    }
+
+    Clock::time_point deadline() const { return deadline_; }
+
+private:
+    std::atomic<bool> cancelled_;
+    Clock::time_point deadline_;
+    const CancellationToken* parent_;
+};
+
+#endif // CANCELLATION_TOKEN_H
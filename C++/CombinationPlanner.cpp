@@ -0,0 +1,189 @@
+// CombinationPlanner.cpp
+// ===========================================================================
+// Implements the contact geometry for combination and kiss shots.
+// ===========================================================================
+
+#include "CombinationPlanner.h"
+#include "GeometryUtils.h"
+#include <algorithm>
+#include <cmath>
+
+// ---------------------------------------------------------------------------
+// Contact points against ball B for one pocket. They do not depend on the
+// ball A that is driven into B, so they are computed once per (B, pocket).
+// - ghost: where A must be to send B into the pocket
+// - kiss[2]: where A must be to glance off B into the pocket (one per side)
+// - kiss_state[k]: whether A, rolling from kiss point k to the pocket
+//   centre, clears the jaws (-1 = not tested yet; the jaw test needs
+//   several trig calls, so it only runs once some A can reach the point)
+// ---------------------------------------------------------------------------
+struct ContactPoints {
+    double ux, uy;          // unit vector B -> pocket
+    double b_leg;           // |B -> pocket|
+    double ghost_x, ghost_y;
+    bool has_kiss;
+    int kiss_state[2];
+    double kiss_x[2], kiss_y[2];
+    double kiss_margin[2];
+};
+
+static ContactPoints contactPoints(double bx, double by, double hx, double hy, double ball_diameter) {
+    ContactPoints cp;
+    cp.ux = hx - bx;
+    cp.uy = hy - by;
+    cp.b_leg = mag(cp.ux, cp.uy);
+    cp.has_kiss = false;
+    cp.kiss_state[0] = cp.kiss_state[1] = -1;
+    if (cp.b_leg <= 0) return cp;
+    cp.ux /= cp.b_leg;
+    cp.uy /= cp.b_leg;
+
+    cp.ghost_x = bx - cp.ux * ball_diameter;
+    cp.ghost_y = by - cp.uy * ball_diameter;
+
+    // A leaves the kiss at right angles to the line of centres, so the kiss
+    // point lies on the circle with diameter B-pocket (Thales) and at
+    // ball_diameter from B
+    if (ball_diameter < cp.b_leg) {
+        double along = ball_diameter * ball_diameter / cp.b_leg; // from B towards the pocket
+        double across = std::sqrt(ball_diameter * ball_diameter - along * along);
+        for (int k = 0; k < 2; ++k) {
+            double side = k == 0 ? -1.0 : 1.0;
+            cp.kiss_x[k] = bx + cp.ux * along - cp.uy * across * side;
+            cp.kiss_y[k] = by + cp.uy * along + cp.ux * across * side;
+        }
+        cp.has_kiss = true;
+    }
+    return cp;
+}
+
+std::vector<CombinationShot> generateCombinationShots(
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& balls,
+    const std::vector<Pocket>& pockets,
+    double ball_diameter,
+    const std::vector<bool>& strikable,
+    const CancellationToken* cancel
+) {
+    std::vector<CombinationShot> shots;
+    const double cue_x = cueball_pos[0];
+    const double cue_y = cueball_pos[1];
+
+    std::vector<size_t> firsts;
+    std::vector<double> cue_legs;
+    for (size_t a = 0; a < balls.size(); ++a) {
+        if (!strikable.empty() && !strikable[a]) continue;
+        firsts.push_back(a);
+        cue_legs.push_back(mag(balls[a][0] - cue_x, balls[a][1] - cue_y));
+    }
+    if (firsts.empty()) return shots;
+
+    // Contact points for every (B, pocket), shared by all A
+    const size_t pocket_count = pockets.size();
+    std::vector<ContactPoints> contacts(balls.size() * pocket_count);
+    for (size_t b = 0; b < balls.size(); ++b) {
+        for (size_t p = 0; p < pocket_count; ++p) {
+            const auto& hole = pockets[p].center;
+            contacts[b * pocket_count + p] = contactPoints(balls[b][0], balls[b][1], hole[0], hole[1], ball_diameter);
+        }
+    }
+
+    for (size_t i = 0; i < firsts.size(); ++i) {
+        if (cancel && cancel->expired()) break;
+        const size_t a = firsts[i];
+        const double ax = balls[a][0];
+        const double ay = balls[a][1];
+        const double cue_dx = ax - cue_x;
+        const double cue_dy = ay - cue_y;
+
+        for (size_t b = 0; b < balls.size(); ++b) {
+            if (b == a) continue;
+            const double bx = balls[b][0];
+            const double by = balls[b][1];
+
+            for (size_t p = 0; p < pocket_count; ++p) {
+                ContactPoints& cp = contacts[b * pocket_count + p];
+                if (cp.b_leg <= 0) continue;
+                const double hx = pockets[p].center[0];
+                const double hy = pockets[p].center[1];
+
+                // Combination: A must arrive at B's ghost ball
+                double in_x = cp.ghost_x - ax;
+                double in_y = cp.ghost_y - ay;
+                if (angleBelow(in_x, in_y, cp.ux, cp.uy, CUT_ANGLE_COS_LIMIT) &&
+                    angleBelow(cue_dx, cue_dy, in_x, in_y, CUT_ANGLE_COS_LIMIT)) {
+                    shots.push_back({COMBINATION_SHOT, a, b, p, {cp.ghost_x, cp.ghost_y},
+                                     cue_legs[i] + mag(in_x, in_y) + cp.b_leg, 0.0});
+                }
+
+                if (!cp.has_kiss) continue;
+                for (int k = 0; k < 2; ++k) {
+                    if (cp.kiss_state[k] == 0) continue;
+                    double kx = cp.kiss_x[k];
+                    double ky = cp.kiss_y[k];
+                    in_x = kx - ax;
+                    in_y = ky - ay;
+                    // A must be moving into B at contact
+                    if (INNER_PRODUCT(in_x, in_y, bx - kx, by - ky) <= 0) continue;
+                    if (!angleBelow(in_x, in_y, hx - kx, hy - ky, KISS_DEFLECTION_COS_LIMIT)) continue;
+                    if (!angleBelow(cue_dx, cue_dy, in_x, in_y, CUT_ANGLE_COS_LIMIT)) continue;
+                    if (cp.kiss_state[k] < 0) {
+                        // Aiming at the pocket centre must lie inside the jaw window
+                        double lo, hi;
+                        bool ok = pocketAcceptance(pockets[p], kx, ky, ball_diameter, lo, hi) && lo < 0 && hi > 0;
+                        cp.kiss_state[k] = ok ? 1 : 0;
+                        cp.kiss_margin[k] = ok ? std::min(-lo, hi) : 0.0;
+                        if (!ok) continue;
+                    }
+                    shots.push_back({KISS_SHOT, a, b, p, {kx, ky},
+                                     cue_legs[i] + mag(in_x, in_y) + mag(hx - kx, hy - ky),
+                                     cp.kiss_margin[k]});
+                }
+            }
+        }
+    }
+    return shots;
+}
+
+std::vector<double> secondBallOf(const ShotCandidate& shot, double ball_diameter) {
+    const auto& a = shot.target_coords;
+    const auto& contact = shot.object_aim;
+    double ux = shot.hole_coords[0] - contact[0];
+    double uy = shot.hole_coords[1] - contact[1];
+    double len = mag(ux, uy);
+    if (len < 1e-9) return contact;
+    ux /= len;
+    uy /= len;
+    if (shot.kind == KISS_SHOT) {
+        double nx = -uy;
+        double ny = ux;
+        if (nx * (contact[0] - a[0]) + ny * (contact[1] - a[1]) < 0) {
+            nx = -nx;
+            ny = -ny;
+        }
+        ux = nx;
+        uy = ny;
+    }
+    return {contact[0] + ux * ball_diameter, contact[1] + uy * ball_diameter};
+}
+
+bool twoBallContact(
+    const ShotCandidate& shot,
+    const std::vector<double>& second,
+    double ball_diameter,
+    std::vector<double>& contact
+) {
+    const auto& hole = shot.hole_coords;
+    ContactPoints cp = contactPoints(second[0], second[1], hole[0], hole[1], ball_diameter);
+    if (cp.b_leg <= 0) return false;
+    if (shot.kind == COMBINATION_SHOT) {
+        contact = {cp.ghost_x, cp.ghost_y};
+        return true;
+    }
+    if (!cp.has_kiss) return false;
+    // Same side of the B -> hole line as the original kiss point
+    double side = cp.ux * (shot.object_aim[1] - second[1]) - cp.uy * (shot.object_aim[0] - second[0]);
+    int k = side < 0 ? 0 : 1;
+    contact = {cp.kiss_x[k], cp.kiss_y[k]};
+    return true;
+}
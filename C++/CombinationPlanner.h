@@ -0,0 +1,106 @@
+// CombinationPlanner.h
+// ===========================================================================
+// Generates two-ball shots for tables where no direct shot is open:
+// - combination: the cue ball drives ball A into ball B, and B is pocketed
+//   (cue -> A -> B -> pocket)
+// - kiss (carom): the cue ball drives A into B, and A glances off B into
+//   the pocket (cue -> A -> contact with B -> pocket)
+//
+// Like computeFlipShot, the generator only does geometry: contact points,
+// cut-angle pruning and path length. The shot search (ShotSearch) ranks the
+// result together with the flip shots and runs the clearance tests lazily,
+// reusing its per-ball cue-leg and pocket-window results.
+// ===========================================================================
+
+#ifndef COMBINATION_PLANNER_H
+#define COMBINATION_PLANNER_H
+
+#include <cstddef>
+#include <vector>
+#include "CancellationToken.h"
+#include "PocketModel.h"
+#include "ShotCandidate.h"
+
+// ---------------------------------------------------------------------------
+// One two-ball shot:
+// - kind: COMBINATION_SHOT or KISS_SHOT
+// - first: index of the ball struck by the cue ball (A)
+// - second: index of the ball A runs into (B)
+// - pocket: index into the pockets the shot was generated for
+// - contact: centre of A at the moment it touches B (the ghost ball of B
+//   for combinations, the kiss point for kiss shots)
+// - total_distance: cue->A + A->contact + the leg into the pocket (from B
+//   for combinations, from the contact for kiss shots), ball centres
+// - aim_margin: for kiss shots, how far A's exit direction may deviate from
+//   the pocket centre and still clear the jaws (radians); 0 for
+//   combinations, whose margin comes from B's pocket window
+// ---------------------------------------------------------------------------
+struct CombinationShot {
+    ShotKind kind;
+    size_t first;
+    size_t second;
+    size_t pocket;
+    std::vector<double> contact;
+    double total_distance;
+    double aim_margin;
+};
+
+// ---------------------------------------------------------------------------
+// Largest deflection of A when it kisses off B: 70 degrees between A's
+// incoming and outgoing directions, stored as its cosine. A keeps
+// cos(deflection) of its speed, so thinner kisses would leave it too slow
+// to reach the pocket.
+// ---------------------------------------------------------------------------
+const double KISS_DEFLECTION_COS_LIMIT = 0.34202014332566871; // cos(70 deg)
+
+// ---------------------------------------------------------------------------
+// Builds every geometrically playable combination and kiss shot.
+//
+// - balls: child balls (candidates for A and B)
+// - ball_diameter: distance between centres at contact
+//
+// Pruned without any obstacle test:
+// - cut at A (cue->A vs A->contact) and, for combinations, at B
+//   (A->contact vs B->pocket) must pass the CUT_ANGLE_COS_LIMIT test
+// - kiss shots need A to move towards B at contact, a deflection within
+//   KISS_DEFLECTION_COS_LIMIT and an exit towards the pocket centre inside
+//   the jaw window; B too close to the pocket has no kiss point
+//
+// 'strikable' (optional, one flag per ball) restricts A to balls the cue
+// ball can reach, e.g. from cached cue-leg clearance results; an empty
+// vector allows every ball. Contact points only depend on (B, pocket) and
+// are computed once for all A. 'cancel' is polled once per A; once it
+// expires the shots found so far are returned.
+// ---------------------------------------------------------------------------
+std::vector<CombinationShot> generateCombinationShots(
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& balls,
+    const std::vector<Pocket>& pockets,
+    double ball_diameter,
+    const std::vector<bool>& strikable = std::vector<bool>(),
+    const CancellationToken* cancel = nullptr
+);
+
+// ---------------------------------------------------------------------------
+// Ball B of a two-ball ShotCandidate (which only keeps A and the contact):
+// one diameter past the contact along the line of centres. For
+// combinations that line runs to the hole; a kiss sends A off at right
+// angles to it, so B lies across A's exit, on the side A is moving
+// towards.
+// ---------------------------------------------------------------------------
+std::vector<double> secondBallOf(const ShotCandidate& shot, double ball_diameter);
+
+// ---------------------------------------------------------------------------
+// Contact of two-ball 'shot' recomputed for ball B at 'second', as
+// generateCombinationShots places it: B's ghost ball for combinations, the
+// kiss point on the same side of B as shot.object_aim for kisses. Returns
+// false if B is too close to the hole for a kiss.
+// ---------------------------------------------------------------------------
+bool twoBallContact(
+    const ShotCandidate& shot,
+    const std::vector<double>& second,
+    double ball_diameter,
+    std::vector<double>& contact
+);
+
+#endif // COMBINATION_PLANNER_H
@@ -0,0 +1,379 @@
+// EndgameTablebase.cpp
+// ===========================================================================
+// Implements tablebase generation, the file format and run-time lookup.
+// ===========================================================================
+
+#include "EndgameTablebase.h"
+#include "ShotPlanner.h"
+#include "GeometryUtils.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+
+static const char kMagic[8] = {'B', 'I', 'L', 'L', 'T', 'B', '0', '1'};
+static const uint32_t kVersion = 2;
+static const uint64_t kSectionAlign = uint64_t(2) << 20;
+static const uint16_t kNoShot = 0x000F;
+
+static uint64_t alignUp(uint64_t offset) {
+    return (offset + kSectionAlign - 1) / kSectionAlign * kSectionAlign;
+}
+
+static double mouthWidth(const Pocket& p) {
+    return mag(p.jaw_b[0] - p.jaw_a[0], p.jaw_b[1] - p.jaw_a[1]);
+}
+
+// ---------------------------------------------------------------------------
+// Pocket permutation for mirroring about x = centre (in_x) or y = centre.
+// Returns false if some pocket has no mirror image within 'tolerance'.
+// ---------------------------------------------------------------------------
+static bool mirrorPockets(
+    const std::vector<Pocket>& pockets,
+    bool in_x,
+    double centre,
+    double tolerance,
+    std::vector<size_t>& perm
+) {
+    perm.assign(pockets.size(), 0);
+    for (size_t h = 0; h < pockets.size(); ++h) {
+        double x = pockets[h].center[0];
+        double y = pockets[h].center[1];
+        if (in_x) x = 2 * centre - x; else y = 2 * centre - y;
+        size_t match = pockets.size();
+        for (size_t k = 0; k < pockets.size(); ++k) {
+            if (mag(pockets[k].center[0] - x, pockets[k].center[1] - y) <= tolerance) {
+                match = k;
+                break;
+            }
+        }
+        if (match == pockets.size()) return false;
+        perm[h] = match;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Header for a table; two calls with the same arguments give identical
+// bytes, which is how a resumable file is recognized.
+// ---------------------------------------------------------------------------
+static EndgameHeader makeHeader(const std::vector<Pocket>& pockets, double bound_radius, double cell_size) {
+    EndgameHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kVersion;
+
+    double min_x = pockets[0].center[0], max_x = min_x;
+    double min_y = pockets[0].center[1], max_y = min_y;
+    for (const auto& p : pockets) {
+        min_x = std::min(min_x, p.center[0]);
+        max_x = std::max(max_x, p.center[0]);
+        min_y = std::min(min_y, p.center[1]);
+        max_y = std::max(max_y, p.center[1]);
+    }
+    double width = std::max(max_x - min_x, cell_size);
+    double height = std::max(max_y - min_y, cell_size);
+    h.cells_x = static_cast<uint32_t>(std::max(1.0, std::round(width / cell_size)));
+    h.cells_y = static_cast<uint32_t>(std::max(1.0, std::round(height / cell_size)));
+    h.origin_x = min_x;
+    h.origin_y = min_y;
+    h.cell_w = width / h.cells_x;
+    h.cell_h = height / h.cells_y;
+    h.bound_radius = bound_radius;
+    h.mouth_width = mouthWidth(pockets[0]);
+    h.pocket_count = static_cast<uint32_t>(pockets.size());
+    for (size_t k = 0; k < pockets.size(); ++k) {
+        h.pockets[k][0] = pockets[k].center[0];
+        h.pockets[k][1] = pockets[k].center[1];
+    }
+
+    std::vector<size_t> perm;
+    double tolerance = std::min(h.cell_w, h.cell_h) / 4;
+    h.mirror_x = mirrorPockets(pockets, true, min_x + width / 2, tolerance, perm) ? 1 : 0;
+    h.mirror_y = mirrorPockets(pockets, false, min_y + height / 2, tolerance, perm) ? 1 : 0;
+    h.cue_cells_x = h.mirror_x ? (h.cells_x + 1) / 2 : h.cells_x;
+    h.cue_cells_y = h.mirror_y ? (h.cells_y + 1) / 2 : h.cells_y;
+
+    uint64_t cells = uint64_t(h.cells_x) * h.cells_y;
+    uint64_t cue_cells = uint64_t(h.cue_cells_x) * h.cue_cells_y;
+    h.progress_offset = sizeof(EndgameHeader);
+    h.progress_count = 2 * cue_cells;
+    h.two_ball_offset = alignUp(h.progress_offset + h.progress_count);
+    h.two_ball_count = cue_cells * cells;
+    h.three_ball_offset = alignUp(h.two_ball_offset + 2 * h.two_ball_count);
+    h.three_ball_count = cue_cells * (cells * (cells - 1) / 2);
+    h.file_size = h.three_ball_offset + 2 * h.three_ball_count;
+    return h;
+}
+
+static double cellX(const EndgameHeader& h, uint32_t i) { return h.origin_x + (i + 0.5) * h.cell_w; }
+static double cellY(const EndgameHeader& h, uint32_t j) { return h.origin_y + (j + 0.5) * h.cell_h; }
+
+// Index of the unordered pair a < b among 'cells' cells
+static uint64_t pairIndex(uint64_t a, uint64_t b, uint64_t cells) {
+    return a * cells - a * (a + 1) / 2 + (b - a - 1);
+}
+
+// ---------------------------------------------------------------------------
+// Best direct shot of one layout by shotDifficulty, with the same tests as
+// the first tier of planShots, encoded as a tablebase entry.
+// ---------------------------------------------------------------------------
+static uint16_t solveLayout(
+    const std::vector<double>& cue,
+    const std::vector<std::vector<double>>& balls,
+    const std::vector<Pocket>& pockets,
+    double bound_radius,
+    std::vector<PocketWindow>& windows
+) {
+    // Overlapping balls: not a real layout
+    for (size_t i = 0; i < balls.size(); ++i) {
+        if (mag(balls[i][0] - cue[0], balls[i][1] - cue[1]) < bound_radius) return kNoShot;
+        for (size_t j = i + 1; j < balls.size(); ++j) {
+            if (mag(balls[i][0] - balls[j][0], balls[i][1] - balls[j][1]) < bound_radius) return kNoShot;
+        }
+    }
+
+    double best = std::numeric_limits<double>::infinity();
+    uint16_t entry = kNoShot;
+    for (size_t t = 0; t < balls.size(); ++t) {
+        const auto& target = balls[t];
+        if (isPathObstructed(cue[0], cue[1], target[0], target[1], balls, bound_radius)) continue;
+        evaluatePocketWindows(t, balls, pockets, bound_radius, windows);
+        double cue_leg = mag(target[0] - cue[0], target[1] - cue[1]);
+        for (size_t h = 0; h < pockets.size(); ++h) {
+            if (!windows[h].reachable) continue;
+            const auto& hole = pockets[h].center;
+            if (!isCutAngleFeasible(cue, target, hole)) continue;
+            double difficulty = shotDifficulty(cue_leg + mag(hole[0] - target[0], hole[1] - target[1]), windows[h].margin);
+            if (difficulty < best) {
+                best = difficulty;
+                long success = std::lround(shotSuccessEstimate(difficulty) * 255);
+                entry = static_cast<uint16_t>(h | (t << 4) | (success << 8));
+            }
+        }
+    }
+    return entry;
+}
+
+bool generateEndgameTablebase(
+    const std::string& path,
+    const std::vector<Pocket>& pockets,
+    double bound_radius,
+    double cell_size,
+    ThreadPool& pool,
+    EndgameGenStats& stats,
+    ThreadPool::Clock::time_point deadline
+) {
+    stats.units = 0;
+    stats.resumed = 0;
+    stats.generated = 0;
+    if (pockets.empty() || pockets.size() > MAX_ENDGAME_POCKETS || cell_size <= 0) return false;
+
+    const EndgameHeader header = makeHeader(pockets, bound_radius, cell_size);
+
+    // Step 1: resume a file for the same table, or start a new one
+    bool resume = false;
+    {
+        std::ifstream in(path, std::ios::binary);
+        EndgameHeader existing;
+        if (in && in.read(reinterpret_cast<char*>(&existing), sizeof(existing)) &&
+            std::memcmp(&existing, &header, sizeof(header)) == 0) {
+            std::error_code ec;
+            resume = std::filesystem::file_size(path, ec) == header.file_size && !ec;
+        }
+    }
+    if (!resume) {
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            if (!out.write(reinterpret_cast<const char*>(&header), sizeof(header))) return false;
+        }
+        std::error_code ec;
+        std::filesystem::resize_file(path, header.file_size, ec);
+        if (ec) return false;
+    }
+
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file) return false;
+    std::vector<char> progress(header.progress_count, 0);
+    file.seekg(header.progress_offset);
+    if (!file.read(progress.data(), progress.size())) return false;
+
+    std::vector<size_t> pending;
+    for (size_t u = 0; u < progress.size(); ++u) {
+        if (progress[u]) ++stats.resumed; else pending.push_back(u);
+    }
+    stats.units = progress.size();
+
+    // Step 2: one unit = one canonical cue cell of one section
+    const uint64_t cue_cells = uint64_t(header.cue_cells_x) * header.cue_cells_y;
+    const uint64_t cells = uint64_t(header.cells_x) * header.cells_y;
+    std::mutex io_mutex;
+    std::atomic<bool> failed(false);
+
+    size_t done = pool.parallelFor(pending.size(), [&](size_t i) {
+        size_t unit = pending[i];
+        bool three_ball = unit >= cue_cells;
+        uint64_t cue_cell = unit % cue_cells;
+        std::vector<double> cue = {cellX(header, cue_cell % header.cue_cells_x),
+                                   cellY(header, static_cast<uint32_t>(cue_cell / header.cue_cells_x))};
+        std::vector<PocketWindow> windows;
+        std::vector<uint16_t> entries;
+        std::vector<std::vector<double>> balls;
+
+        if (!three_ball) {
+            entries.resize(cells);
+            balls.resize(1);
+            for (uint64_t b = 0; b < cells; ++b) {
+                balls[0] = {cellX(header, b % header.cells_x), cellY(header, static_cast<uint32_t>(b / header.cells_x))};
+                entries[b] = solveLayout(cue, balls, pockets, bound_radius, windows);
+            }
+        } else {
+            entries.resize(cells * (cells - 1) / 2);
+            balls.resize(2);
+            uint64_t index = 0;
+            for (uint64_t a = 0; a < cells; ++a) {
+                balls[0] = {cellX(header, a % header.cells_x), cellY(header, static_cast<uint32_t>(a / header.cells_x))};
+                for (uint64_t b = a + 1; b < cells; ++b) {
+                    balls[1] = {cellX(header, b % header.cells_x), cellY(header, static_cast<uint32_t>(b / header.cells_x))};
+                    entries[index++] = solveLayout(cue, balls, pockets, bound_radius, windows);
+                }
+            }
+        }
+
+        uint64_t offset = three_ball
+            ? header.three_ball_offset + 2 * cue_cell * entries.size()
+            : header.two_ball_offset + 2 * cue_cell * entries.size();
+        // Entries first, then the progress byte, so a crash never marks a
+        // unit done whose entries were not written
+        std::lock_guard<std::mutex> lock(io_mutex);
+        file.seekp(offset);
+        file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(uint16_t));
+        file.flush();
+        file.seekp(header.progress_offset + unit);
+        file.put(1);
+        file.flush();
+        if (!file) failed = true;
+    }, deadline);
+
+    stats.generated = done;
+    return !failed && stats.resumed + done == stats.units;
+}
+
+bool EndgameTablebase::open(const std::string& path, const std::vector<Pocket>& pockets, double bound_radius) {
+    file_.close();
+    pockets_ = pockets;
+    bound_radius_ = bound_radius;
+    if (pockets.empty() || pockets.size() > MAX_ENDGAME_POCKETS) return false;
+    if (!file_.open(path, true)) return false;
+
+    // Must be a complete file built for this table
+    bool valid = file_.size() >= sizeof(EndgameHeader);
+    if (valid) {
+        std::memcpy(&header_, file_.data(), sizeof(header_));
+        valid = std::memcmp(header_.magic, kMagic, sizeof(kMagic)) == 0 &&
+                header_.version == kVersion &&
+                header_.file_size == file_.size() &&
+                header_.pocket_count == pockets.size() &&
+                header_.bound_radius == bound_radius &&
+                std::abs(header_.mouth_width - mouthWidth(pockets[0])) < 1e-9;
+    }
+    for (size_t k = 0; valid && k < pockets.size(); ++k) {
+        valid = std::abs(header_.pockets[k][0] - pockets[k].center[0]) < 1e-9 &&
+                std::abs(header_.pockets[k][1] - pockets[k].center[1]) < 1e-9;
+    }
+    for (uint64_t u = 0; valid && u < header_.progress_count; ++u) {
+        valid = file_.data()[header_.progress_offset + u] == 1;
+    }
+    if (valid) {
+        double tolerance = std::min(header_.cell_w, header_.cell_h) / 4;
+        double centre_x = header_.origin_x + header_.cell_w * header_.cells_x / 2;
+        double centre_y = header_.origin_y + header_.cell_h * header_.cells_y / 2;
+        if (header_.mirror_x) valid = mirrorPockets(pockets, true, centre_x, tolerance, flip_x_);
+        if (header_.mirror_y && valid) valid = mirrorPockets(pockets, false, centre_y, tolerance, flip_y_);
+    }
+    if (!valid) file_.close();
+    return valid;
+}
+
+bool EndgameTablebase::lookup(
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& childballs,
+    ShotCandidate& shot,
+    double& success
+) const {
+    if (!file_.isOpen() || childballs.empty() || childballs.size() > 2) return false;
+
+    // Snap every ball to its cell. The entry was solved for the balls on
+    // the cell centres; one that moved more than a ball diameter to get
+    // there makes it a different layout, which is left to the planner.
+    long cx[3], cy[3];
+    for (size_t i = 0; i <= childballs.size(); ++i) {
+        const std::vector<double>& p = i == 0 ? cueball_pos : childballs[i - 1];
+        cx[i] = static_cast<long>(std::floor((p[0] - header_.origin_x) / header_.cell_w));
+        cy[i] = static_cast<long>(std::floor((p[1] - header_.origin_y) / header_.cell_h));
+        if (cx[i] < 0 || cx[i] >= static_cast<long>(header_.cells_x) ||
+            cy[i] < 0 || cy[i] >= static_cast<long>(header_.cells_y)) return false;
+        double snap = mag(p[0] - cellX(header_, static_cast<uint32_t>(cx[i])),
+                          p[1] - cellY(header_, static_cast<uint32_t>(cy[i])));
+        if (snap > bound_radius_) return false;
+    }
+
+    // Mirror the layout so the cue ball is in the stored quadrant
+    const long last_x = header_.cells_x - 1;
+    const long last_y = header_.cells_y - 1;
+    bool flip_x = header_.mirror_x && cx[0] > last_x - cx[0];
+    bool flip_y = header_.mirror_y && cy[0] > last_y - cy[0];
+    for (size_t i = 0; i <= childballs.size(); ++i) {
+        if (flip_x) cx[i] = last_x - cx[i];
+        if (flip_y) cy[i] = last_y - cy[i];
+    }
+
+    const uint64_t cells = uint64_t(header_.cells_x) * header_.cells_y;
+    const uint64_t cue_cell = uint64_t(cy[0]) * header_.cue_cells_x + cx[0];
+    uint64_t offset;
+    size_t lower_ball = 0;
+    if (childballs.size() == 1) {
+        offset = header_.two_ball_offset + 2 * (cue_cell * cells + uint64_t(cy[1]) * header_.cells_x + cx[1]);
+    } else {
+        uint64_t a = uint64_t(cy[1]) * header_.cells_x + cx[1];
+        uint64_t b = uint64_t(cy[2]) * header_.cells_x + cx[2];
+        if (a == b) return false;
+        if (a > b) {
+            std::swap(a, b);
+            lower_ball = 1;
+        }
+        offset = header_.three_ball_offset + 2 * (cue_cell * (cells * (cells - 1) / 2) + pairIndex(a, b, cells));
+    }
+
+    uint16_t entry;
+    std::memcpy(&entry, file_.data() + offset, sizeof(entry));
+    size_t pocket = entry & 0x0F;
+    if (entry == kNoShot || pocket >= pockets_.size()) return false;
+
+    // Back from the canonical frame to the real balls and pockets
+    size_t target = ((entry >> 4) & 1) ? 1 - lower_ball : lower_ball;
+    if (childballs.size() == 1) target = 0;
+    if (flip_x) pocket = flip_x_[pocket];
+    if (flip_y) pocket = flip_y_[pocket];
+
+    // Snapping can open or close a path, so the stored shot gets the same
+    // tests as in solveLayout on the real layout, and its success estimate
+    // is recomputed from the real distances and pocket window
+    const auto& ball = childballs[target];
+    const auto& hole = pockets_[pocket].center;
+    if (!isCutAngleFeasible(cueball_pos, ball, hole)) return false;
+    if (isPathObstructed(cueball_pos[0], cueball_pos[1], ball[0], ball[1], childballs, bound_radius_)) return false;
+    std::vector<PocketWindow> windows;
+    evaluatePocketWindows(target, childballs, pockets_, bound_radius_, windows);
+    if (!windows[pocket].reachable) return false;
+
+    double total_distance = mag(ball[0] - cueball_pos[0], ball[1] - cueball_pos[1]) +
+                            mag(hole[0] - ball[0], hole[1] - ball[1]);
+    shot = {ball, hole, total_distance, DIRECT_SHOT, windows[pocket].margin, hole};
+    success = shotSuccessEstimate(shotDifficulty(total_distance, windows[pocket].margin));
+    return true;
+}
@@ -0,0 +1,140 @@
+// EndgameTablebase.h
+// ===========================================================================
+// Precomputed best shots for endgames: the cue ball plus one or two object
+// balls.
+//
+// The table is divided into a grid of cells and every placement of the
+// balls on cell centres is solved offline (the best direct shot, by
+// shotDifficulty, with its shotSuccessEstimate). At run time a layout is
+// snapped to the grid and answered with one array read instead of a plan.
+//
+// Symmetry: if the pockets are symmetric about the table's centre lines
+// (the usual six-pocket table), a layout and its mirror images have the
+// same answer with mirrored pockets. Only layouts with the cue ball in one
+// quadrant are stored, which makes the file four times smaller. The two
+// object balls of a three-ball layout are stored as an unordered pair.
+//
+// File layout (little-endian, one fixed header, then 2 MiB aligned
+// sections so they can be mapped with huge pages):
+// - EndgameHeader
+// - progress: one byte per generation unit (section, canonical cue cell),
+//   set once that unit's entries are written; generation resumes from it
+// - two-ball section: [cue cell][ball cell]
+// - three-ball section: [cue cell][ball pair]
+// Each entry is 16 bits: pocket in bits 0-3 (15 = no shot), target in
+// bit 4 (three-ball: 0 = lower cell index of the pair), success estimate
+// 0..255 in bits 8-15.
+//
+// Key parts:
+// - generateEndgameTablebase: parallel, resumable offline generator
+// - EndgameTablebase: memory-mapped run-time lookup
+// ===========================================================================
+
+#ifndef ENDGAME_TABLEBASE_H
+#define ENDGAME_TABLEBASE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+#include "PocketModel.h"
+#include "ShotCandidate.h"
+#include "ThreadPool.h"
+
+// Largest pocket count the entry format can address
+const size_t MAX_ENDGAME_POCKETS = 15;
+
+// ---------------------------------------------------------------------------
+// File header. Offsets are in bytes from the start of the file.
+// ---------------------------------------------------------------------------
+struct EndgameHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t cells_x, cells_y;
+    uint32_t cue_cells_x, cue_cells_y;
+    uint32_t mirror_x, mirror_y;
+    uint32_t pocket_count;
+    double origin_x, origin_y;
+    double cell_w, cell_h;
+    double bound_radius;
+    double mouth_width;
+    double pockets[MAX_ENDGAME_POCKETS][2];
+    uint64_t progress_offset, progress_count;
+    uint64_t two_ball_offset, two_ball_count;
+    uint64_t three_ball_offset, three_ball_count;
+    uint64_t file_size;
+};
+
+// ---------------------------------------------------------------------------
+// Progress of one generateEndgameTablebase call:
+// - units: generation units in the file
+// - resumed: units already done when the call started
+// - generated: units written by this call
+// ---------------------------------------------------------------------------
+struct EndgameGenStats {
+    size_t units;
+    size_t resumed;
+    size_t generated;
+};
+
+// ---------------------------------------------------------------------------
+// Generates (or continues generating) the tablebase at 'path'.
+//
+// - pockets: pocket model of the table; the grid spans their bounding box
+// - bound_radius: clearance margin (ball diameter)
+// - cell_size: requested grid cell size (mm); adjusted so a whole number
+//   of cells spans the table
+// - pool / deadline: units run in parallel; no new unit starts after the
+//   deadline
+//
+// An existing file built for the same table and parameters is resumed;
+// anything else at 'path' is overwritten. Returns true once every unit is
+// done (false on I/O errors, or if the deadline stopped it first).
+// ---------------------------------------------------------------------------
+bool generateEndgameTablebase(
+    const std::string& path,
+    const std::vector<Pocket>& pockets,
+    double bound_radius,
+    double cell_size,
+    ThreadPool& pool,
+    EndgameGenStats& stats,
+    ThreadPool::Clock::time_point deadline = ThreadPool::Clock::time_point::max()
+);
+
+// ---------------------------------------------------------------------------
+// Run-time side: maps a finished tablebase and answers endgame layouts.
+//
+// - open: maps 'path' and checks it was generated for these pockets and
+//   bound_radius and is complete
+// - lookup: for one or two child balls on the grid area, snaps the layout
+//   to cell centres and reads its entry. The stored shot is then checked
+//   on the real ball positions (cut angle, cue leg, pocket window) as the
+//   generator checked it on the snapped ones. On success 'shot' is that
+//   direct shot and 'success' its estimate for the real layout. Returns
+//   false for other layouts, for entries without a shot, when snapping
+//   moved a ball more than bound_radius, and when the real layout blocks
+//   the stored shot (the planner should handle those).
+// ---------------------------------------------------------------------------
+class EndgameTablebase {
+public:
+    bool open(const std::string& path, const std::vector<Pocket>& pockets, double bound_radius);
+    bool isOpen() const { return file_.isOpen(); }
+
+    bool lookup(
+        const std::vector<double>& cueball_pos,
+        const std::vector<std::vector<double>>& childballs,
+        ShotCandidate& shot,
+        double& success
+    ) const;
+
+private:
+    MappedFile file_;
+    EndgameHeader header_;
+    std::vector<Pocket> pockets_;
+    std::vector<size_t> flip_x_;  // pocket index after mirroring in x
+    std::vector<size_t> flip_y_;
+    double bound_radius_;
+};
+
+#endif // ENDGAME_TABLEBASE_H
@@ -0,0 +1,86 @@
+// EventQueue.cpp
+// ===========================================================================
+// Implements the fixed-capacity event heap with per-ball epochs.
+// ===========================================================================
+
+#include "EventQueue.h"
+#include <algorithm>
+
+EventQueue::EventQueue(size_t max_balls, size_t capacity)
+    : heap_(capacity > max_balls ? capacity : max_balls + 1),
+      epoch_(max_balls, 0), pending_(max_balls, -1), size_(0), stats_{0, 0, 0} {}
+
+void EventQueue::reset() {
+    std::fill(pending_.begin(), pending_.end(), -1);
+    size_ = 0;
+    stats_ = {0, 0, 0};
+}
+
+void EventQueue::siftUp(size_t index) {
+    Entry e = heap_[index];
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (!before(e, heap_[parent])) break;
+        heap_[index] = heap_[parent];
+        index = parent;
+    }
+    heap_[index] = e;
+}
+
+void EventQueue::siftDown(size_t index) {
+    Entry e = heap_[index];
+    for (;;) {
+        size_t child = 2 * index + 1;
+        if (child >= size_) break;
+        if (child + 1 < size_ && before(heap_[child + 1], heap_[child])) ++child;
+        if (!before(heap_[child], e)) break;
+        heap_[index] = heap_[child];
+        index = child;
+    }
+    heap_[index] = e;
+}
+
+void EventQueue::popTop() {
+    heap_[0] = heap_[--size_];
+    if (size_ > 0) siftDown(0);
+}
+
+// ---------------------------------------------------------------------------
+// Drops every stale entry and rebuilds the heap bottom-up.
+// ---------------------------------------------------------------------------
+void EventQueue::compact() {
+    size_t kept = 0;
+    for (size_t k = 0; k < size_; ++k) {
+        if (!stale(heap_[k])) heap_[kept++] = heap_[k];
+    }
+    stats_.stale_dropped += size_ - kept;
+    size_ = kept;
+    for (size_t k = size_ / 2; k-- > 0;) siftDown(k);
+    ++stats_.compactions;
+}
+
+void EventQueue::schedule(size_t ball, double time) {
+    if (pending_[ball] == time) return;
+    pending_[ball] = time;
+    uint32_t epoch = ++epoch_[ball];
+    if (size_ == heap_.size()) compact();
+    heap_[size_] = {time, static_cast<uint32_t>(ball), epoch};
+    siftUp(size_++);
+    ++stats_.pushes;
+}
+
+void EventQueue::cancel(size_t ball) {
+    pending_[ball] = -1;
+    ++epoch_[ball];
+}
+
+bool EventQueue::peek(size_t& ball, double& time) {
+    while (size_ > 0 && stale(heap_[0])) {
+        popTop();
+        ++stats_.stale_dropped;
+    }
+    if (size_ == 0) return false;
+    ball = heap_[0].ball;
+    time = heap_[0].time;
+    return true;
+}
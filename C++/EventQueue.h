@@ -0,0 +1,94 @@
+// EventQueue.h
+// ===========================================================================
+// Fixed-capacity priority queue of per-ball event times for the ball
+// simulator.
+//
+// Each ball has at most one pending event. Rescheduling a ball does not
+// search the heap for its old entry: every ball carries an epoch that is
+// bumped on each schedule() or cancel(), entries remember the epoch they
+// were pushed with, and entries whose epoch is out of date are dropped
+// when they reach the top. When the heap is full, the stale entries are
+// compacted away in place.
+//
+// The heap storage is allocated once, in the constructor; reset() and all
+// queue operations after it never allocate.
+//
+// Ties in time go to the lower ball index, so the order of events is the
+// same as scanning the balls in index order for the earliest one.
+// ===========================================================================
+
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Counters since the last reset():
+// - pushes: entries pushed by schedule() (not counting unchanged times)
+// - stale_dropped: out-of-date entries removed (at the top or compacted)
+// - compactions: times the full heap was compacted
+// ---------------------------------------------------------------------------
+struct EventQueueStats {
+    size_t pushes;
+    size_t stale_dropped;
+    size_t compactions;
+};
+
+class EventQueue {
+public:
+    // -----------------------------------------------------------------------
+    // - max_balls: balls are numbered 0..max_balls-1
+    // - capacity: heap entries; raised to max_balls + 1 if lower (live
+    //   entries never outnumber the balls, so a compaction always frees a
+    //   slot)
+    // -----------------------------------------------------------------------
+    EventQueue(size_t max_balls, size_t capacity);
+
+    // Empties the queue
+    void reset();
+
+    // -----------------------------------------------------------------------
+    // Sets the pending event time of 'ball', replacing any earlier one. If
+    // the pending time is already 'time', the heap is left as it is.
+    // -----------------------------------------------------------------------
+    void schedule(size_t ball, double time);
+
+    // Removes the pending event of 'ball'
+    void cancel(size_t ball);
+
+    // -----------------------------------------------------------------------
+    // Earliest pending event (ball and time) without removing it; false if
+    // none is pending. Drops stale entries from the top on the way.
+    // -----------------------------------------------------------------------
+    bool peek(size_t& ball, double& time);
+
+    size_t capacity() const { return heap_.size(); }
+    const EventQueueStats& stats() const { return stats_; }
+
+private:
+    struct Entry {
+        double time;
+        uint32_t ball;
+        uint32_t epoch;
+    };
+
+    static bool before(const Entry& a, const Entry& b) {
+        return a.time < b.time || (a.time == b.time && a.ball < b.ball);
+    }
+
+    bool stale(const Entry& e) const { return e.epoch != epoch_[e.ball]; }
+    void siftUp(size_t index);
+    void siftDown(size_t index);
+    void popTop();
+    void compact();
+
+    std::vector<Entry> heap_;       // fixed size; [0, size_) in use
+    std::vector<uint32_t> epoch_;   // current epoch per ball
+    std::vector<double> pending_;   // time of the live entry per ball, or -1
+    size_t size_;
+    EventQueueStats stats_;
+};
+
+#endif // EVENT_QUEUE_H
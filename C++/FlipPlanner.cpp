@@ -6,67 +6,78 @@
 
 #include "FlipPlanner.h"
 #include "GeometryUtils.h"
+#include "ShotPlanner.h"
+#include <algorithm>
 #include <cmath>
 #include <limits>
 
-std::vector<FlipShot> evaluateFlipShots(
-    const std::vector<double>& cueball_pos,
-    const std::vector<std::vector<double>>& candidates,
-    const std::vector<std::vector<double>>& obstacles,
-    const std::vector<std::vector<double>>& walls,
-    double bound_radius
+template <typename Scalar>
+bool computeFlipShot(
+    const std::vector<Scalar>& cueball_pos,
+    const std::vector<Scalar>& target,
+    const std::vector<Scalar>& wall,
+    BasicFlipShot<Scalar>& fs
 ) {
-    std::vector<FlipShot> flips;
+    // Step 1: Mirror target ball across the wall
+    Scalar mirror_x = 2 * wall[0] - target[0];
+    Scalar mirror_y = 2 * wall[1] - target[1];
 
-    // Try every wall and every target ball
-    for (const auto& wall : walls) {
-        for (const auto& target : candidates) {
+    // Step 2: Construct line from cueball to mirror image
+    Scalar vec1_x = mirror_x - cueball_pos[0];
+    Scalar vec1_y = mirror_y - cueball_pos[1];
+    if (vec1_x == 0 && vec1_y == 0) return false;
 
-            // Step 1: Mirror target ball across the wall
-            double mirror_x = 2 * wall[0] - target[0];
-            double mirror_y = 2 * wall[1] - target[1];
+    // Step 3: Wall contact point is halfway along the cue->mirror line
+    Scalar half_x = vec1_x / 2;
+    Scalar half_y = vec1_y / 2;
+    Scalar contact_x = cueball_pos[0] + half_x;
+    Scalar contact_y = cueball_pos[1] + half_y;
 
-            // Step 2: Construct line from cueball to mirror image
-            double vec1_x = mirror_x - cueball_pos[0];
-            double vec1_y = mirror_y - cueball_pos[1];
-            double norm1 = mag(vec1_x, vec1_y);
-            if (norm1 == 0) continue;
+    fs.cue_to_wall_vector = {half_x, half_y};
+    fs.wall_contact_point = {contact_x, contact_y};
+    fs.wall_to_target_vector = {target[0] - contact_x, target[1] - contact_y};
+    fs.target_coords = target;
+    fs.hole_coords = {0, 0}; // Optional: assign later
+    fs.total_distance = mag(fs.cue_to_wall_vector[0], fs.cue_to_wall_vector[1]) +
+                        mag(fs.wall_to_target_vector[0], fs.wall_to_target_vector[1]);
+    return true;
+}
 
-            // Step 3: Normalize and find wall contact point (halfway)
-            double unit1_x = vec1_x / norm1;
-            double unit1_y = vec1_y / norm1;
-            double contact_x = cueball_pos[0] + unit1_x * (norm1 / 2);
-            double contact_y = cueball_pos[1] + unit1_y * (norm1 / 2);
+template <typename Scalar>
+bool isFlipObstructed(
+    const std::vector<Scalar>& cueball_pos,
+    const BasicFlipShot<Scalar>& fs,
+    const std::vector<std::vector<Scalar>>& obstacles,
+    typename NonDeduced<Scalar>::type bound_radius
+) {
+    // Check cue -> wall, then wall -> target, with the same capsule test
+    // used for direct shots
+    Scalar contact_x = fs.wall_contact_point[0];
+    Scalar contact_y = fs.wall_contact_point[1];
+    return isPathObstructed(cueball_pos[0], cueball_pos[1], contact_x, contact_y, obstacles, bound_radius) ||
+           isPathObstructed(contact_x, contact_y, fs.target_coords[0], fs.target_coords[1], obstacles, bound_radius);
+}
 
-            // Step 4: Validate both path segments for collisions
-            bool blocked = false;
-            for (const auto& obs : obstacles) {
-                // Skip self
-                if (mag(obs[0] - cueball_pos[0], obs[1] - cueball_pos[1]) < 1e-5) continue;
-
-                // Check cue -> wall
-                if (std::abs(dis(unit1_x, unit1_y, cueball_pos[0], cueball_pos[1], obs[0], obs[1])) < bound_radius) {
-                    blocked = true;
-                    break;
-                }
-
-                // Check wall -> target
-                if (std::abs(dis(target[0] - contact_x, target[1] - contact_y, contact_x, contact_y, obs[0], obs[1])) < bound_radius) {
-                    blocked = true;
-                    break;
-                }
-            }
+template <typename Scalar>
+std::vector<BasicFlipShot<Scalar>> evaluateFlipShots(
+    const std::vector<Scalar>& cueball_pos,
+    const std::vector<std::vector<Scalar>>& candidates,
+    const std::vector<std::vector<Scalar>>& obstacles,
+    const std::vector<std::vector<Scalar>>& walls,
+    typename NonDeduced<Scalar>::type bound_radius
+) {
+    std::vector<BasicFlipShot<Scalar>> flips;
 
+    // Try every wall and every target ball
+    for (const auto& wall : walls) {
+        for (const auto& target : candidates) {
+            // Steps 1-3: mirror, cue->mirror line and contact point
+            BasicFlipShot<Scalar> fs;
+            if (!computeFlipShot(cueball_pos, target, wall, fs)) continue;
+
+            // Step 4: Validate both path segments for collisions
             // Step 5: If clear, save this shot structure
-            if (!blocked) {
-                FlipShot fs;
-                fs.cue_to_wall_vector = {unit1_x * norm1 / 2, unit1_y * norm1 / 2};
-                fs.wall_contact_point = {contact_x, contact_y};
-                fs.wall_to_target_vector = {target[0] - contact_x, target[1] - contact_y};
-                fs.target_coords = target;
-                fs.hole_coords = {0, 0}; // Optional: assign later
-                fs.total_distance = mag(fs.cue_to_wall_vector[0], fs.cue_to_wall_vector[1]) +
-                                    mag(fs.wall_to_target_vector[0], fs.wall_to_target_vector[1]);
+            if (!isFlipObstructed(cueball_pos, fs, obstacles, bound_radius)) {
                 flips.push_back(fs);
             }
         }
@@ -74,3 +85,74 @@ std::vector<FlipShot> evaluateFlipShots(
 
     return flips;
 }
+
+bool computeFlipShot(
+    const std::vector<double>& cueball_pos,
+    const std::vector<double>& target,
+    const Cushion& cushion,
+    FlipShot& fs
+) {
+    std::vector<double> contact;
+    if (!cushionContact(cushion, cueball_pos, target, contact)) return false;
+
+    fs.cue_to_wall_vector = {contact[0] - cueball_pos[0], contact[1] - cueball_pos[1]};
+    fs.wall_contact_point = contact;
+    fs.wall_to_target_vector = {target[0] - contact[0], target[1] - contact[1]};
+    fs.target_coords = target;
+    fs.hole_coords = {0, 0};
+    fs.total_distance = mag(fs.cue_to_wall_vector[0], fs.cue_to_wall_vector[1]) +
+                        mag(fs.wall_to_target_vector[0], fs.wall_to_target_vector[1]);
+    return true;
+}
+
+size_t assignFlipPocket(
+    const FlipShot& fs,
+    const std::vector<Pocket>& pockets,
+    double bound_radius,
+    double& aim_margin
+) {
+    const double tx = fs.target_coords[0];
+    const double ty = fs.target_coords[1];
+    const double travel = std::atan2(fs.wall_to_target_vector[1], fs.wall_to_target_vector[0]);
+    const double two_pi = 6.28318530717958647692;
+
+    size_t best = pockets.size();
+    double best_offset = std::numeric_limits<double>::max();
+    aim_margin = 0;
+    for (size_t h = 0; h < pockets.size(); ++h) {
+        double lo, hi;
+        if (!pocketAcceptance(pockets[h], tx, ty, bound_radius, lo, hi)) continue;
+
+        // Travel direction relative to the target->pocket centre direction
+        double hole_dir = std::atan2(pockets[h].center[1] - ty, pockets[h].center[0] - tx);
+        double offset = std::remainder(travel - hole_dir, two_pi);
+        if (offset > lo && offset < hi) {
+            aim_margin = std::min(offset - lo, hi - offset);
+            return h;
+        }
+        if (std::abs(offset) < best_offset) {
+            best_offset = std::abs(offset);
+            best = h;
+        }
+    }
+    return best;
+}
+
+// ---------------------------------------------------------------------------
+// Explicit instantiations for the supported coordinate types.
+// ---------------------------------------------------------------------------
+#define INSTANTIATE_FLIP_PLANNER(Scalar)                                        \
+    template bool computeFlipShot<Scalar>(                                       \
+        const std::vector<Scalar>&, const std::vector<Scalar>&,                  \
+        const std::vector<Scalar>&, BasicFlipShot<Scalar>&);                     \
+    template bool isFlipObstructed<Scalar>(                                      \
+        const std::vector<Scalar>&, const BasicFlipShot<Scalar>&,                \
+        const std::vector<std::vector<Scalar>>&, Scalar);                        \
+    template std::vector<BasicFlipShot<Scalar>> evaluateFlipShots<Scalar>(      \
+        const std::vector<Scalar>&, const std::vector<std::vector<Scalar>>&,     \
+        const std::vector<std::vector<Scalar>>&,                                 \
+        const std::vector<std::vector<Scalar>>&, Scalar);
+
+INSTANTIATE_FLIP_PLANNER(double)
+INSTANTIATE_FLIP_PLANNER(float)
+INSTANTIATE_FLIP_PLANNER(FixedPoint)
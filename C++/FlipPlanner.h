@@ -7,12 +7,26 @@
 // - Reflect target ball across wall to find mirror image
 // - Connect cue ball to mirror and simulate bounce point
 // - Validate path segments against obstacles
+//
+// Two wall models are supported. The templated functions take walls.csv
+// points and mirror the target through the point (2 * wall - target), as
+// the original planner did; they are kept for the precision harness. The
+// Cushion overload of computeFlipShot reflects about the cushion's line of
+// ball centres (TableModel) and is what the shot search uses.
+//
+// Like ShotPlanner, everything is templated on the coordinate type (double,
+// float or FixedPoint) with explicit instantiations in FlipPlanner.cpp.
+// FlipShot is the double version used by the rest of the pipeline.
 // ===========================================================================
 
 #ifndef FLIP_PLANNER_H
 #define FLIP_PLANNER_H
 
+#include <cstddef>
 #include <vector>
+#include "GeometryUtils.h"
+#include "PocketModel.h"
+#include "TableModel.h"
 
 // ---------------------------------------------------------------------------
 // Structure representing a valid flip shot (wall-bounce assisted shot):
@@ -20,18 +34,68 @@
 // - wall_contact_point: where the cueball should hit the wall
 // - wall_to_target_vector: vector from wall to target ball
 // - target_coords: location of child ball
-// - hole_coords: intended hole (can be filled later)
+// - hole_coords: intended hole; computeFlipShot leaves {0, 0}, the shot
+//   search fills it in with assignFlipPocket
 // - total_distance: sum of cue->wall and wall->target lengths (for ranking)
 // ---------------------------------------------------------------------------
-struct FlipShot {
-    std::vector<double> cue_to_wall_vector;
-    std::vector<double> wall_contact_point;
-    std::vector<double> wall_to_target_vector;
-    std::vector<double> target_coords;
-    std::vector<double> hole_coords;
-    double total_distance;
+template <typename Scalar>
+struct BasicFlipShot {
+    std::vector<Scalar> cue_to_wall_vector;
+    std::vector<Scalar> wall_contact_point;
+    std::vector<Scalar> wall_to_target_vector;
+    std::vector<Scalar> target_coords;
+    std::vector<Scalar> hole_coords;
+    typename ScalarTraits<Scalar>::Real total_distance;
 };
 
+typedef BasicFlipShot<double> FlipShot;
+
+// ---------------------------------------------------------------------------
+// Builds the flip shot geometry for one (target, wall) pair: mirror image,
+// wall contact point, both path vectors and total_distance. No obstacle
+// checks are done here, so it is cheap enough to compute for every pair
+// up front (e.g. to order candidates before testing them).
+//
+// Returns false if the geometry is degenerate (cue ball on the mirror image).
+// ---------------------------------------------------------------------------
+template <typename Scalar>
+bool computeFlipShot(
+    const std::vector<Scalar>& cueball_pos,
+    const std::vector<Scalar>& target,
+    const std::vector<Scalar>& wall,
+    BasicFlipShot<Scalar>& fs
+);
+
+// ---------------------------------------------------------------------------
+// Same as above against a cushion segment from TableModel: the target is
+// reflected with the cushion's matrix and the contact is where the cue ball
+// centre meets the cushion (cushionContact).
+//
+// Returns false if the cue ball or the target is not on the table side of
+// the cushion, or if the contact would fall in a pocket mouth or beyond the
+// end of the cushion.
+// ---------------------------------------------------------------------------
+bool computeFlipShot(
+    const std::vector<double>& cueball_pos,
+    const std::vector<double>& target,
+    const Cushion& cushion,
+    FlipShot& fs
+);
+
+// ---------------------------------------------------------------------------
+// Checks both segments of a flip shot (cue -> wall, wall -> target) against
+// the obstacles using the capsule test from isPathObstructed (segments are
+// bounded, the cue ball and target on the endpoints are ignored).
+// Returns true if any obstacle lies within 'bound_radius' of either segment.
+// ---------------------------------------------------------------------------
+template <typename Scalar>
+bool isFlipObstructed(
+    const std::vector<Scalar>& cueball_pos,
+    const BasicFlipShot<Scalar>& fs,
+    const std::vector<std::vector<Scalar>>& obstacles,
+    typename NonDeduced<Scalar>::type bound_radius
+);
+
 // ---------------------------------------------------------------------------
 // Evaluates all flip shots by mirroring each target across each wall,
 // then computing potential cueball path to contact point and checking
@@ -46,12 +110,32 @@ struct FlipShot {
 //
 // Returns a list of valid FlipShot objects (can be ranked by distance)
 // ---------------------------------------------------------------------------
-std::vector<FlipShot> evaluateFlipShots(
-    const std::vector<double>& cueball_pos,
-    const std::vector<std::vector<double>>& candidates,
-    const std::vector<std::vector<double>>& obstacles,
-    const std::vector<std::vector<double>>& walls,
-    double bound_radius
+template <typename Scalar>
+std::vector<BasicFlipShot<Scalar>> evaluateFlipShots(
+    const std::vector<Scalar>& cueball_pos,
+    const std::vector<std::vector<Scalar>>& candidates,
+    const std::vector<std::vector<Scalar>>& obstacles,
+    const std::vector<std::vector<Scalar>>& walls,
+    typename NonDeduced<Scalar>::type bound_radius
+);
+
+// ---------------------------------------------------------------------------
+// Picks the pocket a flip shot drives its target towards.
+//
+// The cue ball arrives along the wall->target line and hits the target
+// full, so the target continues in that direction. The pocket whose jaw
+// window (pocketAcceptance) contains that direction is chosen, and
+// 'aim_margin' is set to the distance to the nearer window edge (radians).
+// If no window contains it, the pocket closest in angle is returned with
+// an aim_margin of 0.
+//
+// Returns pockets.size() if no pocket can be approached from the target.
+// ---------------------------------------------------------------------------
+size_t assignFlipPocket(
+    const FlipShot& fs,
+    const std::vector<Pocket>& pockets,
+    double bound_radius,
+    double& aim_margin
 );
 
 #endif // FLIP_PLANNER_H
@@ -2,14 +2,64 @@
 // ===========================================================================
 // This header provides fundamental geometric functions for 2D vector math,
 // useful for billiards path planning and collision detection.
-// Functions include vector magnitude, dot product, angle cosine, and
-// perpendicular distance from a point to a line.
+// Functions include vector magnitude, dot product, angle cosine,
+// perpendicular distance from a point to a line, and the capsule and
+// bounding-box tests used for path clearance.
+//
+// The numeric helpers (mag, COS_VAL, dis) are kept for reporting. The
+// planner's filtering loops use the predicates further down instead, which
+// compare squared lengths, dot and cross products against precomputed
+// thresholds and need no sqrt, division or trigonometric call.
+//
+// All functions are templated on the coordinate type (Scalar) so the
+// planners can run on double, float or FixedPoint coordinates; see
+// ScalarTraits for the types used for products and lengths.
 // ===========================================================================
 
 #ifndef GEOMETRY_UTILS_H
 #define GEOMETRY_UTILS_H
 
 #include <cmath>
+#include <cstdint>
+
+// ---------------------------------------------------------------------------
+// Fixed-point coordinate: a 32-bit integer in units of 0.1 mm.
+// Differences of table coordinates fit easily; products are taken in 64 bits,
+// so every clearance test on this type is exact and deterministic.
+// ---------------------------------------------------------------------------
+typedef int32_t FixedPoint;
+
+// ---------------------------------------------------------------------------
+// Per-scalar types and conversions:
+// - Wide: type used for products of two coordinates (dot/cross products,
+//   squared lengths). Must not overflow for table-sized coordinates.
+// - Real: type used for lengths, cosines and other non-integral results.
+// - fromMillimeters / toMillimeters: conversion from and to the CSV units.
+// ---------------------------------------------------------------------------
+template <typename Scalar>
+struct ScalarTraits {
+    typedef Scalar Wide;
+    typedef Scalar Real;
+    static Scalar fromMillimeters(double v) { return static_cast<Scalar>(v); }
+    static double toMillimeters(Scalar v) { return static_cast<double>(v); }
+};
+
+template <>
+struct ScalarTraits<FixedPoint> {
+    typedef int64_t Wide;
+    typedef double Real;
+    static FixedPoint fromMillimeters(double v) { return static_cast<FixedPoint>(std::lround(v * 10)); }
+    static double toMillimeters(FixedPoint v) { return v / 10.0; }
+};
+
+// ---------------------------------------------------------------------------
+// Wraps a template parameter so it is not deduced from an argument, letting
+// callers pass e.g. an int literal as bound_radius to a double planner.
+// ---------------------------------------------------------------------------
+template <typename T>
+struct NonDeduced {
+    typedef T type;
+};
 
 // ---------------------------------------------------------------------------
 // Computes the inner (dot) product of two 2D vectors:
@@ -17,8 +67,10 @@
 // Inner product = a*c + b*d
 // This is used to calculate projection, angle cosine, and alignment.
 // ---------------------------------------------------------------------------
-inline double INNER_PRODUCT(double a, double b, double c, double d) {
-    return a * c + b * d;
+template <typename Scalar>
+inline typename ScalarTraits<Scalar>::Wide INNER_PRODUCT(Scalar a, Scalar b, Scalar c, Scalar d) {
+    typedef typename ScalarTraits<Scalar>::Wide Wide;
+    return static_cast<Wide>(a) * c + static_cast<Wide>(b) * d;
 }
 
 // ---------------------------------------------------------------------------
@@ -27,8 +79,10 @@ inline double INNER_PRODUCT(double a, double b, double c, double d) {
 // Magnitude = sqrt(a^2 + b^2)
 // This represents the vector's length or distance in 2D space.
 // ---------------------------------------------------------------------------
-inline double mag(double a, double b) {
-    return std::sqrt(a * a + b * b);
+template <typename Scalar>
+inline typename ScalarTraits<Scalar>::Real mag(Scalar a, Scalar b) {
+    typedef typename ScalarTraits<Scalar>::Real Real;
+    return std::sqrt(static_cast<Real>(INNER_PRODUCT(a, b, a, b)));
 }
 
 // ---------------------------------------------------------------------------
@@ -40,8 +94,10 @@ inline double mag(double a, double b) {
 // - 0.0 means perpendicular
 // - -1.0 means opposite direction
 // ---------------------------------------------------------------------------
-inline double COS_VAL(double a, double b, double c, double d) {
-    return (INNER_PRODUCT(a, b, c, d) / (mag(a, b) * mag(c, d)));
+template <typename Scalar>
+inline typename ScalarTraits<Scalar>::Real COS_VAL(Scalar a, Scalar b, Scalar c, Scalar d) {
+    typedef typename ScalarTraits<Scalar>::Real Real;
+    return (static_cast<Real>(INNER_PRODUCT(a, b, c, d)) / (mag(a, b) * mag(c, d)));
 }
 
 // ---------------------------------------------------------------------------
@@ -53,12 +109,118 @@ inline double COS_VAL(double a, double b, double c, double d) {
 //
 // This function is crucial for checking whether any ball obstructs a direct path.
 // ---------------------------------------------------------------------------
-inline double dis(double vec_x, double vec_y, double pass_x, double pass_y, double x0, double y0) {
-    double c = vec_y * pass_x - vec_x * pass_y;
-    double numerator = vec_y * x0 - vec_x * y0 - c;
-    double denominator = std::sqrt(vec_x * vec_x + vec_y * vec_y);
-    double distance = numerator / denominator;
+template <typename Scalar>
+inline typename ScalarTraits<Scalar>::Real dis(Scalar vec_x, Scalar vec_y, Scalar pass_x, Scalar pass_y, Scalar x0, Scalar y0) {
+    typedef typename ScalarTraits<Scalar>::Wide Wide;
+    typedef typename ScalarTraits<Scalar>::Real Real;
+    Wide c = static_cast<Wide>(vec_y) * pass_x - static_cast<Wide>(vec_x) * pass_y;
+    Wide numerator = static_cast<Wide>(vec_y) * x0 - static_cast<Wide>(vec_x) * y0 - c;
+    Real denominator = mag(vec_x, vec_y);
+    Real distance = static_cast<Real>(numerator) / denominator;
     return distance;
 }
 
+// ---------------------------------------------------------------------------
+// Checks whether point (x0, y0) lies within 'radius' of the segment
+// (x1, y1)-(x2, y2), i.e. inside the capsule swept by a ball of that radius
+// moving along the segment.
+//
+// With d = P2 - P1 and w = P0 - P1:
+// - if the projection (w • d) falls within [0, |d|^2], the perpendicular
+//   distance decides: cross(d, w)^2 < radius^2 * |d|^2
+// - otherwise the nearer endpoint decides (the round caps)
+// No square root or division is needed.
+// ---------------------------------------------------------------------------
+template <typename Scalar>
+inline bool insideCapsule(Scalar x1, Scalar y1, Scalar x2, Scalar y2, Scalar x0, Scalar y0, Scalar radius) {
+    typedef typename ScalarTraits<Scalar>::Wide Wide;
+    Scalar vec_x = x2 - x1;
+    Scalar vec_y = y2 - y1;
+    Scalar w_x = x0 - x1;
+    Scalar w_y = y0 - y1;
+    Wide radius_sq = static_cast<Wide>(radius) * radius;
+    Wide len_sq = INNER_PRODUCT(vec_x, vec_y, vec_x, vec_y);
+    Wide proj = INNER_PRODUCT(w_x, w_y, vec_x, vec_y);
+
+    if (proj <= 0) return INNER_PRODUCT(w_x, w_y, w_x, w_y) < radius_sq;
+    if (proj >= len_sq) {
+        Scalar e_x = x0 - x2;
+        Scalar e_y = y0 - y2;
+        return INNER_PRODUCT(e_x, e_y, e_x, e_y) < radius_sq;
+    }
+    Wide cross = static_cast<Wide>(vec_x) * w_y - static_cast<Wide>(vec_y) * w_x;
+    return cross * cross < radius_sq * len_sq;
+}
+
+// ---------------------------------------------------------------------------
+// Axis-aligned bounding box of a segment inflated by a radius.
+// Any point outside this box is farther than 'radius' from the segment, so
+// the box rejects most obstacles before the exact capsule distance is needed.
+// ---------------------------------------------------------------------------
+template <typename Scalar>
+struct SegmentBox {
+    Scalar min_x, min_y, max_x, max_y;
+};
+
+template <typename Scalar>
+inline SegmentBox<Scalar> segmentBox(Scalar x1, Scalar y1, Scalar x2, Scalar y2, Scalar radius) {
+    SegmentBox<Scalar> box;
+    box.min_x = (x1 < x2 ? x1 : x2) - radius;
+    box.max_x = (x1 < x2 ? x2 : x1) + radius;
+    box.min_y = (y1 < y2 ? y1 : y2) - radius;
+    box.max_y = (y1 < y2 ? y2 : y1) + radius;
+    return box;
+}
+
+template <typename Scalar>
+inline bool outsideBox(const SegmentBox<Scalar>& box, Scalar x0, Scalar y0) {
+    return x0 < box.min_x || x0 > box.max_x || y0 < box.min_y || y0 > box.max_y;
+}
+
+// ---------------------------------------------------------------------------
+// Squared magnitude of a 2D vector (a, b). Use this instead of mag() when
+// the length only feeds a comparison.
+// ---------------------------------------------------------------------------
+template <typename Scalar>
+inline typename ScalarTraits<Scalar>::Wide MAG_SQ(Scalar a, Scalar b) {
+    return INNER_PRODUCT(a, b, a, b);
+}
+
+// ---------------------------------------------------------------------------
+// Checks whether the angle between A = (a, b) and B = (c, d) is smaller than
+// the angle whose cosine is 'cos_limit', without calling acos:
+// angle < limit  <=>  A • B > cos_limit * |A| * |B|
+//
+// Both sides are squared to drop the square roots, which is valid once the
+// signs are known:
+// - A • B >= 0 and cos_limit < 0: always true (obtuse limit, acute angle)
+// - A • B <= 0 and cos_limit >= 0: always false
+// - otherwise compare (A • B)^2 against cos_limit^2 * |A|^2 * |B|^2, with
+//   the direction of the comparison set by the common sign
+// Zero-length vectors have no angle and return false.
+// ---------------------------------------------------------------------------
+template <typename Scalar>
+inline bool angleBelow(Scalar a, Scalar b, Scalar c, Scalar d, double cos_limit) {
+    typedef typename ScalarTraits<Scalar>::Wide Wide;
+    typedef typename ScalarTraits<Scalar>::Real Real;
+    Wide len_sq_a = MAG_SQ(a, b);
+    Wide len_sq_b = MAG_SQ(c, d);
+    if (len_sq_a == 0 || len_sq_b == 0) return false;
+
+    Wide dot = INNER_PRODUCT(a, b, c, d);
+    Real limit = static_cast<Real>(cos_limit);
+    Real dot_sq = static_cast<Real>(dot * dot);
+    Real rhs = limit * limit * static_cast<Real>(len_sq_a) * static_cast<Real>(len_sq_b);
+    if (limit < 0) {
+        if (dot >= 0) return true;
+        return dot_sq < rhs;
+    }
+    if (dot <= 0) return false;
+    return dot_sq > rhs;
+}
+
+// Largest cut angle (cue->child vs child->hole) that can still pocket the
+// child ball: 110 degrees, stored as its cosine for angleBelow().
+const double CUT_ANGLE_COS_LIMIT = -0.34202014332566871; // cos(110 deg)
+
 #endif // GEOMETRY_UTILS_H
@@ -0,0 +1,210 @@
+// GhostBallSolver.cpp
+// ===========================================================================
+// Implements the batched ghost-ball aim computation.
+// ===========================================================================
+
+#include "GhostBallSolver.h"
+#include <algorithm>
+#include <cmath>
+
+static const double kRadToDeg = 180.0 / 3.14159265358979323846;
+static const double kTinySquare = 1e-300;
+static const double kHalfPi = 1.57079632679489661923;
+
+void addGhostBallShot(
+    GhostBallBatch& batch,
+    const std::vector<double>& cueball_pos,
+    const std::vector<double>& target,
+    const std::vector<double>& hole,
+    double pocket_margin
+) {
+    batch.cue_x.push_back(cueball_pos[0]);
+    batch.cue_y.push_back(cueball_pos[1]);
+    batch.target_x.push_back(target[0]);
+    batch.target_y.push_back(target[1]);
+    batch.hole_x.push_back(hole[0]);
+    batch.hole_y.push_back(hole[1]);
+    batch.pocket_margin.push_back(pocket_margin);
+}
+
+double hitYawDegrees(double dir_x, double dir_y) {
+    // acos(dir . (0, -1)) folded onto the robot's branch, written with atan2
+    double yaw = std::atan2(dir_y, dir_x) * kRadToDeg;
+    if (dir_x <= 0 && yaw > 0) yaw -= 360;
+    return yaw;
+}
+
+double cueMarginSuccess(double cue_margin) {
+    if (cue_margin <= 0) return 0;
+    return std::erf(cue_margin / (1.4142135623730951 * CUE_AIM_ERROR_RAD));
+}
+
+// ---------------------------------------------------------------------------
+// Pass 1 of solveGhostBalls: ghost centre, aim vector and cosine of the cut
+// angle (written to cut_cos). Degenerate shots are left with zero vectors
+// for pass 2 to fix up. The loop has no branches, and the restrict
+// parameters tell the compiler the arrays never overlap, so with the
+// planner flags it vectorizes without runtime alias checks.
+// ---------------------------------------------------------------------------
+static void solveGhostCentres(
+    size_t n, double ball_diameter,
+    const double* __restrict cue_x, const double* __restrict cue_y,
+    const double* __restrict target_x, const double* __restrict target_y,
+    const double* __restrict hole_x, const double* __restrict hole_y,
+    double* __restrict ghost_x, double* __restrict ghost_y,
+    double* __restrict aim_x, double* __restrict aim_y,
+    double* __restrict cut_cos
+) {
+    for (size_t i = 0; i < n; ++i) {
+        // The tiny bias keeps the loop branch-free: a zero vector stays zero
+        // instead of dividing by zero, other lengths are unchanged
+        double ux = hole_x[i] - target_x[i];
+        double uy = hole_y[i] - target_y[i];
+        double u_inv = 1.0 / std::sqrt(ux * ux + uy * uy + kTinySquare);
+        ux *= u_inv;
+        uy *= u_inv;
+
+        double gx = target_x[i] - ux * ball_diameter;
+        double gy = target_y[i] - uy * ball_diameter;
+        double ax = gx - cue_x[i];
+        double ay = gy - cue_y[i];
+        double a_inv = 1.0 / std::sqrt(ax * ax + ay * ay + kTinySquare);
+        ax *= a_inv;
+        ay *= a_inv;
+
+        ghost_x[i] = gx;
+        ghost_y[i] = gy;
+        aim_x[i] = ax;
+        aim_y[i] = ay;
+        // cosine for now, converted to degrees in pass 2
+        cut_cos[i] = ax * ux + ay * uy;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Cue margin of shot 'i' (cosine of the cut 'cut_cos'). On each side, the
+// target sent pocket_margin off its direction needs the ghost ball turned
+// about the target by that angle; the cue margin is the smaller of the two
+// angles the cue aim turns through to reach them. If the cut would pass 90
+// degrees first, that side ends where the cue ball just grazes the target.
+// ---------------------------------------------------------------------------
+static double cueMargin(const GhostBallBatch& batch, size_t i, double ball_diameter, double cut_cos) {
+    if (cut_cos <= 0) return 0;
+    const double cx = batch.cue_x[i], cy = batch.cue_y[i];
+    const double tx = batch.target_x[i], ty = batch.target_y[i];
+    const double ax = batch.aim_x[i], ay = batch.aim_y[i];
+    const double ux = (tx - batch.ghost_x[i]) / ball_diameter;
+    const double uy = (ty - batch.ghost_y[i]) / ball_diameter;
+    const double m_cos = std::cos(batch.pocket_margin[i]);
+    const double m_sin = std::sin(batch.pocket_margin[i]);
+
+    double margin = batch.pocket_margin[i] > 0 ? kHalfPi : 0;
+    for (int side = -1; side <= 1; side += 2) {
+        double rx = ux * m_cos - side * uy * m_sin;
+        double ry = side * ux * m_sin + uy * m_cos;
+        double vx = tx - rx * ball_diameter - cx;
+        double vy = ty - ry * ball_diameter - cy;
+        double turn;
+        if (vx * rx + vy * ry > 0) {
+            turn = std::atan2(std::abs(ax * vy - ay * vx), ax * vx + ay * vy);
+        } else {
+            // Graze: the aim line passes one diameter from the target
+            double to_target = std::sqrt((tx - cx) * (tx - cx) + (ty - cy) * (ty - cy));
+            double offset = ball_diameter * std::sqrt(1 - cut_cos * cut_cos);
+            turn = std::asin(std::min(1.0, ball_diameter / to_target)) -
+                   std::asin(std::min(1.0, offset / to_target));
+        }
+        margin = std::min(margin, turn);
+    }
+    return margin;
+}
+
+void solveGhostBalls(GhostBallBatch& batch, double ball_diameter) {
+    const size_t n = batch.cue_x.size();
+    batch.ghost_x.resize(n);
+    batch.ghost_y.resize(n);
+    batch.aim_x.resize(n);
+    batch.aim_y.resize(n);
+    batch.cut_angle.resize(n);
+    batch.yaw.resize(n);
+    batch.cue_margin.resize(n);
+
+    // Pass 1: arithmetic only, vectorized
+    solveGhostCentres(n, ball_diameter,
+                      batch.cue_x.data(), batch.cue_y.data(),
+                      batch.target_x.data(), batch.target_y.data(),
+                      batch.hole_x.data(), batch.hole_y.data(),
+                      batch.ghost_x.data(), batch.ghost_y.data(),
+                      batch.aim_x.data(), batch.aim_y.data(),
+                      batch.cut_angle.data());
+
+    // Pass 2: degenerate shots, angles and cue margins
+    for (size_t i = 0; i < n; ++i) {
+        double ux = batch.hole_x[i] - batch.target_x[i];
+        double uy = batch.hole_y[i] - batch.target_y[i];
+        double u_len = std::sqrt(ux * ux + uy * uy);
+        double c = batch.cut_angle[i];
+        bool degenerate = true;
+        if (u_len <= 1e-9) {
+            // Target on the hole: nothing to cut
+            c = 1.0;
+        } else if (std::abs(batch.aim_x[i]) + std::abs(batch.aim_y[i]) < 0.5) {
+            // Cue ball on the ghost ball: aim along the target->hole line
+            batch.aim_x[i] = ux / u_len;
+            batch.aim_y[i] = uy / u_len;
+            c = 1.0;
+        } else {
+            degenerate = false;
+        }
+        c = c > 1.0 ? 1.0 : (c < -1.0 ? -1.0 : c);
+        batch.cut_angle[i] = std::acos(c) * kRadToDeg;
+        batch.yaw[i] = hitYawDegrees(batch.aim_x[i], batch.aim_y[i]);
+        batch.cue_margin[i] = degenerate ? batch.pocket_margin[i] : cueMargin(batch, i, ball_diameter, c);
+    }
+}
+
+void correctGhostBallsForThrow(
+    GhostBallBatch& batch,
+    double ball_diameter,
+    const OutcomeTables& tables,
+    const std::vector<double>& cue_speed
+) {
+    if (!tables.isOpen()) return;
+    for (size_t i = 0; i < batch.cut_angle.size(); ++i) {
+        double ux = (batch.target_x[i] - batch.ghost_x[i]) / ball_diameter;
+        double uy = (batch.target_y[i] - batch.ghost_y[i]) / ball_diameter;
+        // Target on the hole: no contact line to turn
+        if (ux * ux + uy * uy < 0.25) continue;
+        // Side the target leaves the aim line to; the ghost turns further out
+        double side = batch.aim_x[i] * uy - batch.aim_y[i] * ux < 0 ? -1.0 : 1.0;
+        double cut = batch.cut_angle[i] / kRadToDeg;
+        double gx = batch.ghost_x[i], gy = batch.ghost_y[i];
+        double ax = batch.aim_x[i], ay = batch.aim_y[i];
+        bool placed = true;
+        for (int step = 0; step < 2; ++step) {
+            double turn = side * tables.throwAngle(cut, cue_speed[i]);
+            double rx = ux * std::cos(turn) - uy * std::sin(turn);
+            double ry = ux * std::sin(turn) + uy * std::cos(turn);
+            gx = batch.target_x[i] - rx * ball_diameter;
+            gy = batch.target_y[i] - ry * ball_diameter;
+            ax = gx - batch.cue_x[i];
+            ay = gy - batch.cue_y[i];
+            double len = std::sqrt(ax * ax + ay * ay);
+            if (len < 1e-9) {
+                // Cue ball on the turned ghost ball: keep the plain aim
+                placed = false;
+                break;
+            }
+            ax /= len;
+            ay /= len;
+            cut = std::acos(std::min(1.0, std::max(-1.0, ax * rx + ay * ry)));
+        }
+        if (!placed) continue;
+        batch.ghost_x[i] = gx;
+        batch.ghost_y[i] = gy;
+        batch.aim_x[i] = ax;
+        batch.aim_y[i] = ay;
+        batch.cut_angle[i] = cut * kRadToDeg;
+        batch.yaw[i] = hitYawDegrees(ax, ay);
+    }
+}
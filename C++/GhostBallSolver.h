@@ -0,0 +1,135 @@
+// GhostBallSolver.h
+// ===========================================================================
+// Computes the cue aim for direct shots from the ghost-ball construction.
+//
+// To send the target ball towards the hole, the cue ball must be at the
+// "ghost ball" position when it makes contact: one ball diameter behind the
+// target, on the hole->target line. The cue ball is therefore aimed at the
+// ghost-ball centre, not at the target itself.
+//
+// Shots are solved in batches stored as parallel arrays (one entry per
+// shot). The geometry pass is a branch-free loop over contiguous doubles
+// that g++ vectorizes with the planner flags (-O3 -fno-math-errno
+// -fno-trapping-math, .vscode/tasks.json; errno-setting sqrt keeps it
+// scalar); only the angle conversions run one shot at a time. main.cpp
+// fills a batch with all ranked candidates and solves them together.
+//
+// The angle pass also gives each shot its cue margin: how far the cue
+// ball's direction may be off before the target leaves its pocket window.
+// Sending the target pocket_margin off its line needs the ghost ball turned
+// by that angle about the target, which the cue sees as a turn of roughly
+//   pocket_margin * ball_diameter * cos(cut) / |cue -> ghost|
+// (computed exactly, on both sides). Long cue legs and thin cuts shrink
+// it; AnytimePlanner ranks shots by it.
+//
+// Key parts:
+// - GhostBallBatch: inputs and results for a batch of (cue, target, hole)
+// - addGhostBallShot / solveGhostBalls: fill and solve a batch
+// - cueMarginSuccess: chance of potting a shot with a given cue margin
+// - correctGhostBallsForThrow: re-aims solved shots for collision throw
+// - hitYawDegrees: robot yaw for a strike direction
+// ===========================================================================
+
+#ifndef GHOST_BALL_SOLVER_H
+#define GHOST_BALL_SOLVER_H
+
+#include <cstddef>
+#include <vector>
+#include "OutcomeTables.h"
+
+// ---------------------------------------------------------------------------
+// Batch of shots, one index per shot.
+//
+// Inputs (filled by addGhostBallShot):
+// - cue_x/y, target_x/y, hole_x/y: cue ball, target ball and hole centres
+// - pocket_margin: how far the target's direction may deviate and still
+//   be pocketed (radians, ShotCandidate::aim_margin)
+//
+// Results (filled by solveGhostBalls):
+// - ghost_x/y: cue ball centre at contact
+// - aim_x/y: unit vector from the cue ball towards the ghost ball
+// - cut_angle: angle between the cue aim and the target->hole direction,
+//   in degrees (0 = straight shot)
+// - yaw: hit pose yaw for the aim direction, see hitYawDegrees
+// - cue_margin: how far the cue aim may deviate, on either side, before the
+//   target misses its pocket window (radians); 0 for cuts of 90 degrees or
+//   more
+// ---------------------------------------------------------------------------
+struct GhostBallBatch {
+    std::vector<double> cue_x, cue_y;
+    std::vector<double> target_x, target_y;
+    std::vector<double> hole_x, hole_y;
+    std::vector<double> pocket_margin;
+
+    std::vector<double> ghost_x, ghost_y;
+    std::vector<double> aim_x, aim_y;
+    std::vector<double> cut_angle;
+    std::vector<double> yaw;
+    std::vector<double> cue_margin;
+};
+
+// ---------------------------------------------------------------------------
+// Appends one (cue, target, hole) triple to the batch, with the target's
+// pocket margin (0 if only the aim is needed).
+// ---------------------------------------------------------------------------
+void addGhostBallShot(
+    GhostBallBatch& batch,
+    const std::vector<double>& cueball_pos,
+    const std::vector<double>& target,
+    const std::vector<double>& hole,
+    double pocket_margin = 0
+);
+
+// ---------------------------------------------------------------------------
+// Solves every shot in the batch.
+//
+// - ball_diameter: distance between ball centres at contact
+//
+// If the cue ball already sits on the ghost ball, the aim falls back to the
+// target->hole direction; a target on the hole gets a cut angle of 0. Both
+// cases get the pocket margin as their cue margin.
+// ---------------------------------------------------------------------------
+void solveGhostBalls(GhostBallBatch& batch, double ball_diameter);
+
+// Standard deviation of the robot's cue direction (radians); with it a
+// straight shot with 500 mm legs scores the same as with the distance-based
+// shotSuccessEstimate (ShotCandidate.h)
+const double CUE_AIM_ERROR_RAD = 6e-4;
+
+// ---------------------------------------------------------------------------
+// Estimated chance of potting a shot with 'cue_margin' radians of cue
+// margin: the probability that a normal cue direction error with standard
+// deviation CUE_AIM_ERROR_RAD stays within the margin.
+// ---------------------------------------------------------------------------
+double cueMarginSuccess(double cue_margin);
+
+// ---------------------------------------------------------------------------
+// Re-aims every shot of a solved batch for collision-induced throw, which
+// turns the target's direction towards the cue ball's and makes cuts go
+// thin. The ghost ball is turned about the target, away from the aim, by
+// the throw of the cut it then makes (two fixed-point steps), and ghost_x/y,
+// aim_x/y, cut_angle (the cut actually played) and yaw are updated;
+// cue_margin is left as it is.
+//
+// - tables: outcome tables giving throwAngle; nothing changes if no table
+//   is open
+// - cue_speed: cue ball speed at contact per shot (mm/s)
+// ---------------------------------------------------------------------------
+void correctGhostBallsForThrow(
+    GhostBallBatch& batch,
+    double ball_diameter,
+    const OutcomeTables& tables,
+    const std::vector<double>& cue_speed
+);
+
+// ---------------------------------------------------------------------------
+// Converts a unit strike direction into the robot hit pose yaw, in degrees.
+//
+// Same convention as the original main.cpp computation: the yaw is
+// -90 + theta for directions with a positive x component and -90 - theta
+// otherwise, where theta is the angle between the direction and the tool
+// axis (0, -1). The result lies in [-270, 90).
+// ---------------------------------------------------------------------------
+double hitYawDegrees(double dir_x, double dir_y);
+
+#endif // GHOST_BALL_SOLVER_H
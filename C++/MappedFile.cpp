@@ -0,0 +1,105 @@
+// MappedFile.cpp
+// ===========================================================================
+// Implements the platform-specific file mapping.
+// ===========================================================================
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() : data_(nullptr), size_(0), file_(nullptr), mapping_(nullptr) {}
+
+bool MappedFile::open(const std::string& path, bool huge_page_hint) {
+    (void)huge_page_hint; // large pages need a privilege and anonymous memory on Windows
+    close();
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    file_ = file;
+    mapping_ = mapping;
+    data_ = static_cast<const unsigned char*>(view);
+    size_ = static_cast<size_t>(size.QuadPart);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(mapping_);
+    if (file_) CloseHandle(file_);
+    data_ = nullptr;
+    size_ = 0;
+    mapping_ = nullptr;
+    file_ = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile() : data_(nullptr), size_(0), fd_(-1) {}
+
+bool MappedFile::open(const std::string& path, bool huge_page_hint) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+    // Lookups jump around the table; read-ahead would only waste memory
+    madvise(view, static_cast<size_t>(info.st_size), MADV_RANDOM);
+#ifdef MADV_HUGEPAGE
+    if (huge_page_hint) madvise(view, static_cast<size_t>(info.st_size), MADV_HUGEPAGE);
+#else
+    (void)huge_page_hint;
+#endif
+    fd_ = fd;
+    data_ = static_cast<const unsigned char*>(view);
+    size_ = static_cast<size_t>(info.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) munmap(const_cast<unsigned char*>(data_), size_);
+    if (fd_ >= 0) ::close(fd_);
+    data_ = nullptr;
+    size_ = 0;
+    fd_ = -1;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
@@ -0,0 +1,51 @@
+// MappedFile.h
+// ===========================================================================
+// Read-only memory mapping of a binary data file.
+//
+// Precomputed tables (e.g. the endgame tablebase) are too large to parse
+// at start-up. Mapping them lets the OS page in only the parts a lookup
+// touches, and several processes share one copy in the page cache.
+// Uses CreateFileMapping on Windows and mmap elsewhere.
+// ===========================================================================
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// ---------------------------------------------------------------------------
+// Owns one read-only mapping of a whole file.
+//
+// - open: maps 'path'; returns false if it cannot be opened or is empty
+// - huge_page_hint: on Linux, asks for transparent huge pages on the
+//   mapping (useful when the hot data starts on a 2 MiB boundary)
+// - data / size: mapped bytes, valid until close() or destruction
+// ---------------------------------------------------------------------------
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path, bool huge_page_hint = false);
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    const unsigned char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const unsigned char* data_;
+    size_t size_;
+#ifdef _WIN32
+    void* file_;
+    void* mapping_;
+#else
+    int fd_;
+#endif
+};
+
+#endif // MAPPED_FILE_H
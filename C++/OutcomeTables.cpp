@@ -0,0 +1,244 @@
+// OutcomeTables.cpp
+// ===========================================================================
+// Implements the throw and capture models, table generation and lookup.
+// ===========================================================================
+
+#include "OutcomeTables.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+static const char kMagic[8] = {'B', 'I', 'L', 'L', 'O', 'T', '0', '1'};
+static const uint32_t kVersion = 1;
+static const uint64_t kGridAlign = 64;
+static const double kHalfPi = 1.57079632679489661923;
+
+// Sliding friction between the balls, a + b * exp(-c * v) for a sliding
+// speed v in m/s (fit to measurements of phenolic balls)
+static const double THROW_FRICTION_MIN = 9.951e-3;
+static const double THROW_FRICTION_RANGE = 0.108;
+static const double THROW_FRICTION_DECAY = 1.088;
+
+// Capture model: the throat narrows by this angle on each side behind the
+// jaws and is one ball diameter deep; bounces keep this share of the
+// normal speed
+static const double THROAT_ANGLE = 10 * kHalfPi / 90;
+static const double JAW_RESTITUTION = 0.6;
+// Bounces before a rattling ball is given up as lost
+static const int MAX_RATTLES = 6;
+// March step (mm per unit of speed), speed below which the ball has
+// stalled in the jaws (entry speed is 1), and steps before giving up
+static const double CAPTURE_STEP = 0.02;
+static const double CAPTURE_STALL_SPEED = 0.05;
+static const int MAX_CAPTURE_STEPS = 200000;
+// Supersamples per axis around each capture grid point
+static const int CAPTURE_SUBSAMPLES = 4;
+
+static uint64_t alignUp(uint64_t offset) {
+    return (offset + kGridAlign - 1) / kGridAlign * kGridAlign;
+}
+
+OutcomeTableOptions defaultOutcomeTableOptions() {
+    OutcomeTableOptions options;
+    options.throw_cuts = 91;
+    options.throw_speeds = 64;
+    options.max_speed = 4000;
+    options.capture_angles = 51;
+    options.capture_offsets = 61;
+    options.max_entry_angle = 75 * kHalfPi / 90;
+    return options;
+}
+
+double collisionThrow(double cut, double speed) {
+    double c = std::max(std::cos(cut), 1e-9);
+    double s = std::abs(std::sin(cut));
+    double sliding = std::abs(speed) * s / 1000;
+    double friction = THROW_FRICTION_MIN + THROW_FRICTION_RANGE * std::exp(-THROW_FRICTION_DECAY * sliding);
+    // Tangential over normal impulse
+    return std::atan(std::min(friction * c, s / 7) / c);
+}
+
+bool simulateCapture(double entry_angle, double offset, double ball_diameter, double mouth_width) {
+    // Pocket frame: the mouth on y = 0 between the jaws at x = -/+ half,
+    // the pocket at y < 0. The ball drops once its centre passes the back
+    // of the throat.
+    const double r = ball_diameter / 2;
+    const double half = mouth_width / 2;
+    const double depth = ball_diameter;
+    const double back = half - depth * std::tan(THROAT_ANGLE);
+    const double walls[2][4] = {{-half, 0, -back, -depth}, {half, 0, back, -depth}};
+
+    double vx = std::sin(entry_angle);
+    double vy = -std::cos(entry_angle);
+    if (vy >= 0) return false;
+    // Start two diameters out, on the line through the mouth crossing
+    double start = 2 * ball_diameter;
+    double x = offset + vx * start / vy;
+    double y = start;
+
+    int rattles = 0;
+    for (int step = 0; step < MAX_CAPTURE_STEPS; ++step) {
+        x += vx * CAPTURE_STEP;
+        y += vy * CAPTURE_STEP;
+        if (y <= -depth) return true;
+        if (y > start && vy > 0) return false;
+        // Outside the jaws the ball runs into the cushion
+        if (std::abs(x) > half && y < r) return false;
+
+        for (const auto& w : walls) {
+            double sx = w[2] - w[0];
+            double sy = w[3] - w[1];
+            double t = ((x - w[0]) * sx + (y - w[1]) * sy) / (sx * sx + sy * sy);
+            t = std::min(1.0, std::max(0.0, t));
+            double nx = x - (w[0] + t * sx);
+            double ny = y - (w[1] + t * sy);
+            double d = std::sqrt(nx * nx + ny * ny);
+            if (d >= r || d < 1e-12) continue;
+            nx /= d;
+            ny /= d;
+            double vn = vx * nx + vy * ny;
+            if (vn >= 0) continue;
+            vx -= (1 + JAW_RESTITUTION) * vn * nx;
+            vy -= (1 + JAW_RESTITUTION) * vn * ny;
+            if (++rattles > MAX_RATTLES) return false;
+        }
+        if (vx * vx + vy * vy < CAPTURE_STALL_SPEED * CAPTURE_STALL_SPEED) return false;
+    }
+    return false;
+}
+
+// Header for a table; the grids follow it at aligned offsets
+static OutcomeHeader makeHeader(double ball_diameter, double mouth_width, const OutcomeTableOptions& options) {
+    OutcomeHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kVersion;
+    h.throw_cuts = static_cast<uint32_t>(options.throw_cuts);
+    h.throw_speeds = static_cast<uint32_t>(options.throw_speeds);
+    h.capture_angles = static_cast<uint32_t>(options.capture_angles);
+    h.capture_offsets = static_cast<uint32_t>(options.capture_offsets);
+    h.max_speed = options.max_speed;
+    h.max_entry_angle = options.max_entry_angle;
+    h.ball_diameter = ball_diameter;
+    h.mouth_width = mouth_width;
+    h.throw_offset = alignUp(sizeof(OutcomeHeader));
+    h.capture_offset = alignUp(h.throw_offset + sizeof(float) * uint64_t(h.throw_cuts) * h.throw_speeds);
+    h.file_size = h.capture_offset + sizeof(float) * uint64_t(h.capture_angles) * h.capture_offsets;
+    return h;
+}
+
+bool generateOutcomeTables(
+    const std::string& path,
+    double ball_diameter,
+    double mouth_width,
+    const OutcomeTableOptions& options,
+    ThreadPool& pool
+) {
+    if (options.throw_cuts < 2 || options.throw_speeds < 2 ||
+        options.capture_angles < 2 || options.capture_offsets < 2) return false;
+    const OutcomeHeader header = makeHeader(ball_diameter, mouth_width, options);
+
+    const size_t cuts = header.throw_cuts, speeds = header.throw_speeds;
+    std::vector<float> throws(cuts * speeds);
+    for (size_t i = 0; i < cuts; ++i) {
+        double cut = kHalfPi * i / (cuts - 1);
+        for (size_t j = 0; j < speeds; ++j) {
+            throws[i * speeds + j] = static_cast<float>(collisionThrow(cut, header.max_speed * j / (speeds - 1)));
+        }
+    }
+
+    // One angle row per task
+    const size_t angles = header.capture_angles, offsets = header.capture_offsets;
+    const double angle_step = header.max_entry_angle / (angles - 1);
+    const double offset_step = mouth_width / (offsets - 1);
+    std::vector<float> capture(angles * offsets);
+    pool.parallelFor(angles, [&](size_t i) {
+        for (size_t j = 0; j < offsets; ++j) {
+            int dropped = 0;
+            for (int s = 0; s < CAPTURE_SUBSAMPLES; ++s) {
+                double a = angle_step * (i + (s + 0.5) / CAPTURE_SUBSAMPLES - 0.5);
+                for (int t = 0; t < CAPTURE_SUBSAMPLES; ++t) {
+                    double o = -mouth_width / 2 + offset_step * (j + (t + 0.5) / CAPTURE_SUBSAMPLES - 0.5);
+                    if (simulateCapture(a, o, ball_diameter, mouth_width)) ++dropped;
+                }
+            }
+            capture[i * offsets + j] = static_cast<float>(dropped) / (CAPTURE_SUBSAMPLES * CAPTURE_SUBSAMPLES);
+        }
+    });
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    std::vector<char> padding(kGridAlign, 0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(padding.data(), header.throw_offset - sizeof(header));
+    out.write(reinterpret_cast<const char*>(throws.data()), throws.size() * sizeof(float));
+    out.write(padding.data(), header.capture_offset - header.throw_offset - throws.size() * sizeof(float));
+    out.write(reinterpret_cast<const char*>(capture.data()), capture.size() * sizeof(float));
+    return static_cast<bool>(out);
+}
+
+// ---------------------------------------------------------------------------
+// Bilinear interpolation in a rows x cols grid at fractional grid
+// coordinates (row, col), clamped to the grid.
+// ---------------------------------------------------------------------------
+static double interpolate(const float* grid, size_t rows, size_t cols, double row, double col) {
+    row = std::min(static_cast<double>(rows - 1), std::max(0.0, row));
+    col = std::min(static_cast<double>(cols - 1), std::max(0.0, col));
+    size_t r0 = std::min(static_cast<size_t>(row), rows - 2);
+    size_t c0 = std::min(static_cast<size_t>(col), cols - 2);
+    double fr = row - r0;
+    double fc = col - c0;
+    const float* p = grid + r0 * cols + c0;
+    double top = p[0] + (p[1] - p[0]) * fc;
+    double bottom = p[cols] + (p[cols + 1] - p[cols]) * fc;
+    return top + (bottom - top) * fr;
+}
+
+bool OutcomeTables::open(const std::string& path, double ball_diameter, double mouth_width) {
+    file_.close();
+    if (!file_.open(path)) return false;
+
+    // Must be a whole file built for these balls and pockets
+    bool valid = file_.size() >= sizeof(OutcomeHeader);
+    if (valid) {
+        std::memcpy(&header_, file_.data(), sizeof(header_));
+        valid = std::memcmp(header_.magic, kMagic, sizeof(kMagic)) == 0 &&
+                header_.version == kVersion &&
+                header_.file_size == file_.size() &&
+                header_.ball_diameter == ball_diameter &&
+                std::abs(header_.mouth_width - mouth_width) < 1e-9 &&
+                header_.throw_cuts >= 2 && header_.throw_speeds >= 2 &&
+                header_.capture_angles >= 2 && header_.capture_offsets >= 2 &&
+                header_.max_speed > 0 && header_.max_entry_angle > 0 &&
+                header_.throw_offset % kGridAlign == 0 && header_.capture_offset % kGridAlign == 0 &&
+                header_.throw_offset + sizeof(float) * uint64_t(header_.throw_cuts) * header_.throw_speeds <= header_.capture_offset &&
+                header_.capture_offset + sizeof(float) * uint64_t(header_.capture_angles) * header_.capture_offsets <= header_.file_size;
+    }
+    if (!valid) {
+        file_.close();
+        return false;
+    }
+    throw_ = reinterpret_cast<const float*>(file_.data() + header_.throw_offset);
+    capture_ = reinterpret_cast<const float*>(file_.data() + header_.capture_offset);
+    return true;
+}
+
+double OutcomeTables::throwAngle(double cut, double speed) const {
+    if (!file_.isOpen()) return 0;
+    return interpolate(throw_, header_.throw_cuts, header_.throw_speeds,
+                       std::abs(cut) / kHalfPi * (header_.throw_cuts - 1),
+                       speed / header_.max_speed * (header_.throw_speeds - 1));
+}
+
+double OutcomeTables::captureChance(double entry_angle, double offset) const {
+    if (!file_.isOpen()) return 1;
+    // A mirrored entry has the same chance
+    if (entry_angle < 0) {
+        entry_angle = -entry_angle;
+        offset = -offset;
+    }
+    return interpolate(capture_, header_.capture_angles, header_.capture_offsets,
+                       entry_angle / header_.max_entry_angle * (header_.capture_angles - 1),
+                       (offset / header_.mouth_width + 0.5) * (header_.capture_offsets - 1));
+}
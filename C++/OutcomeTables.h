@@ -0,0 +1,136 @@
+// OutcomeTables.h
+// ===========================================================================
+// Precomputed lookup tables for two effects the geometric planners ignore:
+// - collision-induced throw: friction between the balls at contact turns
+//   the object ball's direction a little towards the cue ball's, so a cut
+//   goes thinner than the ghost-ball line. The throw angle depends on the
+//   cut angle and the cue ball speed.
+// - pocket capture: a ball that enters the mouth near a jaw or at a steep
+//   angle can hit the jaw, rattle in the throat and come back out. Whether
+//   it drops depends on its entry angle and its offset from the mouth
+//   centre.
+//
+// Both are too slow to evaluate per candidate (capture is a small bounce
+// simulation), so outcome_gen samples them offline on a grid and writes a
+// binary file. At run time the file is mapped (MappedFile) and lookups
+// interpolate bilinearly between the four nearest grid points.
+//
+// File layout (little-endian): OutcomeHeader, then the throw grid
+// [cut][speed] and the capture grid [entry angle][offset], both float and
+// starting on 64-byte boundaries.
+//
+// Key parts:
+// - collisionThrow / simulateCapture: the offline physics
+// - generateOutcomeTables: writes the file
+// - OutcomeTables: memory-mapped run-time lookup
+// ===========================================================================
+
+#ifndef OUTCOME_TABLES_H
+#define OUTCOME_TABLES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "MappedFile.h"
+#include "ThreadPool.h"
+
+// ---------------------------------------------------------------------------
+// File header. Offsets are in bytes from the start of the file.
+// - throw grid: throw_cuts cut angles over [0, 90] degrees by throw_speeds
+//   cue ball speeds over [0, max_speed] (mm/s)
+// - capture grid: capture_angles entry angles over [0, max_entry_angle]
+//   (radians; negative angles are mirrored) by capture_offsets offsets
+//   over [-mouth_width / 2, mouth_width / 2] (mm)
+// ---------------------------------------------------------------------------
+struct OutcomeHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t throw_cuts, throw_speeds;
+    uint32_t capture_angles, capture_offsets;
+    uint32_t reserved;
+    double max_speed;
+    double max_entry_angle;
+    double ball_diameter;
+    double mouth_width;
+    uint64_t throw_offset;
+    uint64_t capture_offset;
+    uint64_t file_size;
+};
+
+// ---------------------------------------------------------------------------
+// Grid sizes and ranges for generateOutcomeTables (see OutcomeHeader).
+// ---------------------------------------------------------------------------
+struct OutcomeTableOptions {
+    size_t throw_cuts;
+    size_t throw_speeds;
+    double max_speed;
+    size_t capture_angles;
+    size_t capture_offsets;
+    double max_entry_angle;
+};
+
+// ---------------------------------------------------------------------------
+// Defaults used by outcome_gen: throw every degree of cut by 64 speeds up
+// to 4 m/s, capture every 1.5 degrees up to 75 by 61 offsets.
+// ---------------------------------------------------------------------------
+OutcomeTableOptions defaultOutcomeTableOptions();
+
+// ---------------------------------------------------------------------------
+// Throw angle (radians, towards the cue ball's direction) of a stun shot
+// with cut angle 'cut' (radians) and cue ball speed 'speed' (mm/s) at
+// contact. The friction impulse at contact is limited by the sliding
+// friction coefficient, which falls with the sliding speed, and by the
+// impulse that stops the sliding (1/7 of the relative speed for two solid
+// balls).
+// ---------------------------------------------------------------------------
+double collisionThrow(double cut, double speed);
+
+// ---------------------------------------------------------------------------
+// True if a ball crossing the mouth line 'offset' mm from the mouth centre,
+// at 'entry_angle' radians from the pocket axis, drops. The pocket is the
+// two jaw points 'mouth_width' apart with a throat narrowing behind them;
+// the ball bounces off jaws and throat walls with restitution and is lost
+// if it comes back out, stalls or bounces too often.
+// ---------------------------------------------------------------------------
+bool simulateCapture(double entry_angle, double offset, double ball_diameter, double mouth_width);
+
+// ---------------------------------------------------------------------------
+// Writes the tables for balls of 'ball_diameter' and pockets of
+// 'mouth_width' to 'path', computing grid rows in parallel on 'pool'. Each
+// capture entry is the fraction of supersampled entries around its grid
+// point that drop. Returns false on I/O errors or empty grids.
+// ---------------------------------------------------------------------------
+bool generateOutcomeTables(
+    const std::string& path,
+    double ball_diameter,
+    double mouth_width,
+    const OutcomeTableOptions& options,
+    ThreadPool& pool
+);
+
+// ---------------------------------------------------------------------------
+// Run-time side.
+//
+// - open: maps 'path' and checks it was generated for this ball diameter
+//   and mouth width
+// - throwAngle: interpolated collisionThrow; 0 if no table is open
+// - captureChance: interpolated chance that the ball drops, in [0, 1];
+//   1 if no table is open
+// Arguments outside the grids are clamped to its edges.
+// ---------------------------------------------------------------------------
+class OutcomeTables {
+public:
+    bool open(const std::string& path, double ball_diameter, double mouth_width);
+    bool isOpen() const { return file_.isOpen(); }
+
+    double throwAngle(double cut, double speed) const;
+    double captureChance(double entry_angle, double offset) const;
+
+private:
+    MappedFile file_;
+    OutcomeHeader header_;
+    const float* throw_;
+    const float* capture_;
+};
+
+#endif // OUTCOME_TABLES_H
@@ -0,0 +1,327 @@
+// PlanCache.cpp
+// ===========================================================================
+// Implements the layout hash and the LRU plan cache.
+// ===========================================================================
+
+#include "PlanCache.h"
+#include "CombinationPlanner.h"
+#include "GeometryUtils.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+// ---------------------------------------------------------------------------
+// 64-bit mixing step (splitmix64 finalizer) used to combine quantized
+// coordinates into the layout hash.
+// ---------------------------------------------------------------------------
+static uint64_t mixHash(uint64_t h, uint64_t v) {
+    h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+static int64_t quantize(double v, double tolerance) {
+    return static_cast<int64_t>(std::llround(v / tolerance));
+}
+
+uint64_t hashTableState(
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& childballs,
+    double tolerance
+) {
+    // Quantize and sort children so detector order does not matter
+    std::vector<std::pair<int64_t, int64_t>> cells;
+    cells.reserve(childballs.size());
+    for (const auto& child : childballs) {
+        cells.emplace_back(quantize(child[0], tolerance), quantize(child[1], tolerance));
+    }
+    std::sort(cells.begin(), cells.end());
+
+    uint64_t h = mixHash(0, cells.size());
+    h = mixHash(h, static_cast<uint64_t>(quantize(cueball_pos[0], tolerance)));
+    h = mixHash(h, static_cast<uint64_t>(quantize(cueball_pos[1], tolerance)));
+    for (const auto& cell : cells) {
+        h = mixHash(h, static_cast<uint64_t>(cell.first));
+        h = mixHash(h, static_cast<uint64_t>(cell.second));
+    }
+    return h;
+}
+
+uint64_t hashTableState(const TableState& state, double tolerance) {
+    std::pair<int64_t, int64_t> cells[TABLE_STATE_BALLS];
+    size_t count = 0;
+    for (size_t slot = 0; slot < state.slots; ++slot) {
+        if (!state.hasBall(slot)) continue;
+        cells[count++] = {quantize(state.x[slot], tolerance), quantize(state.y[slot], tolerance)};
+    }
+    std::sort(cells, cells + count);
+
+    uint64_t h = mixHash(0, count);
+    h = mixHash(h, static_cast<uint64_t>(quantize(state.cue_x, tolerance)));
+    h = mixHash(h, static_cast<uint64_t>(quantize(state.cue_y, tolerance)));
+    for (size_t k = 0; k < count; ++k) {
+        h = mixHash(h, static_cast<uint64_t>(cells[k].first));
+        h = mixHash(h, static_cast<uint64_t>(cells[k].second));
+    }
+    return h;
+}
+
+PlanCache::PlanCache(size_t capacity, double tolerance)
+    : capacity_(capacity), tolerance_(tolerance), hits_(0), misses_(0), lookup_micros_(0) {}
+
+bool PlanCache::lookup(uint64_t key, std::vector<ShotCandidate>& ranked) {
+    auto start = std::chrono::steady_clock::now();
+    bool found = false;
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        // Promote entry to most recently used
+        entries_.splice(entries_.begin(), entries_, it->second);
+        ranked = it->second->second;
+        found = true;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    lookup_micros_ += std::chrono::duration<double, std::micro>(end - start).count();
+    if (found) ++hits_; else ++misses_;
+    return found;
+}
+
+void PlanCache::store(uint64_t key, const std::vector<ShotCandidate>& ranked) {
+    if (capacity_ == 0) return;
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        it->second->second = ranked;
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return;
+    }
+
+    // Evict least recently used entry when full
+    if (entries_.size() >= capacity_) {
+        index_.erase(entries_.back().first);
+        entries_.pop_back();
+    }
+    entries_.emplace_front(key, ranked);
+    index_[key] = entries_.begin();
+}
+
+double PlanCache::averageLookupMicros() const {
+    uint64_t total = hits_ + misses_;
+    return total == 0 ? 0.0 : lookup_micros_ / static_cast<double>(total);
+}
+
+// Field parsers for load: false unless the whole field is one finite
+// number in range (a partly written line must not throw)
+static bool parseKey(const std::string& field, uint64_t& value) {
+    if (field.empty() || field[0] == '-') return false;
+    char* end;
+    errno = 0;
+    value = std::strtoull(field.c_str(), &end, 10);
+    return errno == 0 && *end == '\0';
+}
+
+static bool parseDouble(const std::string& field, double& value) {
+    if (field.empty()) return false;
+    char* end;
+    errno = 0;
+    value = std::strtod(field.c_str(), &end);
+    return errno == 0 && *end == '\0' && std::isfinite(value);
+}
+
+static bool parseKind(const std::string& field, ShotKind& kind) {
+    if (field.empty()) return false;
+    char* end;
+    errno = 0;
+    long value = std::strtol(field.c_str(), &end, 10);
+    if (errno != 0 || *end != '\0' || value < DIRECT_SHOT || value > SAFETY_SHOT) return false;
+    kind = static_cast<ShotKind>(value);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// CSV layout (one candidate per line, entries in most-recent-first order):
+// hash,target_x,target_y,hole_x,hole_y,total_distance,kind,aim_margin,
+// object_aim_x,object_aim_y
+// Lines without the object_aim fields (older files) aim at the hole.
+// Malformed lines (e.g. from a write cut short) are skipped.
+// ---------------------------------------------------------------------------
+bool PlanCache::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    std::vector<std::pair<uint64_t, std::vector<ShotCandidate>>> loaded;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        std::string value;
+        std::vector<std::string> fields;
+        while (std::getline(ss, value, ',')) {
+            fields.push_back(value);
+        }
+        if (fields.size() != 8 && fields.size() != 10) continue;
+
+        uint64_t key;
+        double v[10];
+        ShotKind kind;
+        if (!parseKey(fields[0], key) || !parseKind(fields[6], kind)) continue;
+        bool valid = true;
+        for (size_t f = 1; f < fields.size() && valid; ++f) {
+            if (f != 6) valid = parseDouble(fields[f], v[f]);
+        }
+        if (!valid) continue;
+
+        ShotCandidate c;
+        c.target_coords = {v[1], v[2]};
+        c.hole_coords = {v[3], v[4]};
+        c.total_distance = v[5];
+        c.kind = kind;
+        c.aim_margin = v[7];
+        if (fields.size() == 10) {
+            c.object_aim = {v[8], v[9]};
+        } else {
+            c.object_aim = c.hole_coords;
+        }
+
+        // Consecutive lines with the same hash belong to one ranked list
+        if (loaded.empty() || loaded.back().first != key) {
+            loaded.emplace_back(key, std::vector<ShotCandidate>());
+        }
+        loaded.back().second.push_back(c);
+    }
+
+    // Insert oldest first so the file order is restored as LRU order
+    for (auto it = loaded.rbegin(); it != loaded.rend(); ++it) {
+        store(it->first, it->second);
+    }
+    return true;
+}
+
+bool PlanCache::save(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) return false;
+
+    file.precision(17);
+    for (const auto& entry : entries_) {
+        for (const auto& c : entry.second) {
+            file << entry.first << ','
+                 << c.target_coords[0] << ',' << c.target_coords[1] << ','
+                 << c.hole_coords[0] << ',' << c.hole_coords[1] << ','
+                 << c.total_distance << ',' << static_cast<int>(c.kind) << ','
+                 << c.aim_margin << ','
+                 << c.object_aim[0] << ',' << c.object_aim[1] << '\n';
+        }
+    }
+    return true;
+}
+
+// Entry of 'balls' nearest to 'p'
+static const std::vector<double>& nearestBall(
+    const std::vector<std::vector<double>>& balls,
+    const std::vector<double>& p
+) {
+    size_t best = 0;
+    double best_distance = mag(balls[0][0] - p[0], balls[0][1] - p[1]);
+    for (size_t i = 1; i < balls.size(); ++i) {
+        double distance = mag(balls[i][0] - p[0], balls[i][1] - p[1]);
+        if (distance < best_distance) {
+            best_distance = distance;
+            best = i;
+        }
+    }
+    return balls[best];
+}
+
+// Cushion whose line of ball centres passes closest to 'p'
+static const Cushion& nearestCushion(const std::vector<Cushion>& cushions, const std::vector<double>& p) {
+    size_t best = 0;
+    double best_distance = std::abs(INNER_PRODUCT(cushions[0].normal[0], cushions[0].normal[1], p[0], p[1]) -
+                                    cushions[0].centre_offset);
+    for (size_t i = 1; i < cushions.size(); ++i) {
+        const Cushion& c = cushions[i];
+        double distance = std::abs(INNER_PRODUCT(c.normal[0], c.normal[1], p[0], p[1]) - c.centre_offset);
+        if (distance < best_distance) {
+            best_distance = distance;
+            best = i;
+        }
+    }
+    return cushions[best];
+}
+
+// ---------------------------------------------------------------------------
+// Recomputes one cached shot for the current layout; false if its geometry
+// no longer works.
+// ---------------------------------------------------------------------------
+static bool rebaseShot(
+    ShotCandidate& shot,
+    const std::vector<double>& cue,
+    const std::vector<std::vector<double>>& childballs,
+    const TableModel& table,
+    double ball_diameter
+) {
+    const std::vector<double> target = nearestBall(childballs, shot.target_coords);
+    const auto& hole = shot.hole_coords;
+    const double cue_leg = mag(target[0] - cue[0], target[1] - cue[1]);
+    std::vector<double> aim;
+
+    switch (shot.kind) {
+        case DIRECT_SHOT:
+            aim = hole;
+            shot.total_distance = cue_leg + mag(hole[0] - target[0], hole[1] - target[1]);
+            break;
+        case BANK_SHOT:
+            if (table.cushions.empty()) return false;
+            if (!cushionContact(nearestCushion(table.cushions, shot.object_aim), target, hole, aim)) return false;
+            shot.total_distance = cue_leg + mag(aim[0] - target[0], aim[1] - target[1]) +
+                                  mag(hole[0] - aim[0], hole[1] - aim[1]);
+            break;
+        case FLIP_SHOT:
+            if (table.cushions.empty()) return false;
+            if (!cushionContact(nearestCushion(table.cushions, shot.object_aim), cue, target, aim)) return false;
+            shot.total_distance = mag(aim[0] - cue[0], aim[1] - cue[1]) + mag(target[0] - aim[0], target[1] - aim[1]);
+            break;
+        case COMBINATION_SHOT:
+        case KISS_SHOT: {
+            const std::vector<double> second = nearestBall(childballs, secondBallOf(shot, ball_diameter));
+            if (!twoBallContact(shot, second, ball_diameter, aim)) return false;
+            // The pocketed ball's leg starts at B for combinations, at the
+            // kiss point for kisses
+            const auto& last = shot.kind == COMBINATION_SHOT ? second : aim;
+            shot.total_distance = cue_leg + mag(aim[0] - target[0], aim[1] - target[1]) +
+                                  mag(hole[0] - last[0], hole[1] - last[1]);
+            break;
+        }
+        default:
+            return true;
+    }
+    shot.target_coords = target;
+    shot.object_aim = aim;
+    return true;
+}
+
+size_t rebaseCachedPlan(
+    std::vector<ShotCandidate>& ranked,
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& childballs,
+    const TableModel& table,
+    double ball_diameter
+) {
+    if (childballs.empty()) {
+        ranked.clear();
+        return 0;
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < ranked.size(); ++i) {
+        if (rebaseShot(ranked[i], cueball_pos, childballs, table, ball_diameter)) ranked[kept++] = ranked[i];
+    }
+    ranked.resize(kept);
+    return kept;
+}
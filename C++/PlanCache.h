@@ -0,0 +1,113 @@
+// PlanCache.h
+// ===========================================================================
+// Caches ranked shot lists keyed by a hash of the (quantized) table layout.
+//
+// Practice drills present near-identical layouts over and over. Instead of
+// replanning every time, the layout is reduced to a canonical hash and the
+// ranked candidate list from the last plan is reused on a hit.
+//
+// Key parts:
+// - hashTableState: canonical hash over quantized cue/child ball positions,
+//   from ball lists or from a TableState
+// - PlanCache: fixed-capacity LRU map from hash to ranked candidates, with
+//   hit/miss counters and lookup latency, persisted as CSV between runs
+// - rebaseCachedPlan: moves a cached plan onto the balls as they lie now
+// ===========================================================================
+
+#ifndef PLAN_CACHE_H
+#define PLAN_CACHE_H
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "ShotCandidate.h"
+#include "TableModel.h"
+#include "TableState.h"
+
+// ---------------------------------------------------------------------------
+// Computes a canonical hash of a table layout.
+//
+// Every coordinate is quantized to a grid of size 'tolerance' (same units as
+// the CSV inputs), so balls that moved less than one grid cell produce the
+// same key. Child balls are sorted after quantization, which makes the hash
+// independent of the order the detector reported them in. The cue ball is
+// hashed separately from the children since swapping it changes the shot.
+// ---------------------------------------------------------------------------
+uint64_t hashTableState(
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& childballs,
+    double tolerance
+);
+
+// Same hash for the balls present in 'state', without building the lists
+uint64_t hashTableState(const TableState& state, double tolerance);
+
+// ---------------------------------------------------------------------------
+// Least-recently-used cache from layout hash to ranked shot list.
+//
+// - lookup: returns true and fills 'ranked' on a hit, promoting the entry
+// - store: inserts or refreshes an entry, evicting the oldest when full
+// - load / save: read and write the cache as CSV so it survives between
+//   program runs (one line per candidate, most recently used first)
+//
+// Counters (hits, misses) and the accumulated lookup time are exposed so the
+// benefit of the cache can be checked during a session.
+// ---------------------------------------------------------------------------
+class PlanCache {
+public:
+    PlanCache(size_t capacity, double tolerance);
+
+    double tolerance() const { return tolerance_; }
+
+    bool lookup(uint64_t key, std::vector<ShotCandidate>& ranked);
+    void store(uint64_t key, const std::vector<ShotCandidate>& ranked);
+
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    size_t size() const { return entries_.size(); }
+    uint64_t hits() const { return hits_; }
+    uint64_t misses() const { return misses_; }
+    // Average time spent in lookup(), in microseconds
+    double averageLookupMicros() const;
+
+private:
+    typedef std::pair<uint64_t, std::vector<ShotCandidate>> Entry;
+
+    size_t capacity_;
+    double tolerance_;
+    std::list<Entry> entries_;  // front = most recently used
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+    uint64_t hits_;
+    uint64_t misses_;
+    double lookup_micros_;
+};
+
+// ---------------------------------------------------------------------------
+// Moves a plan returned by PlanCache::lookup onto the current layout.
+//
+// A hit only means every ball lies in the same grid cell as when the plan
+// was stored, so the cached coordinates can be up to a cell off. Each
+// shot's balls are snapped to the nearest entry of 'childballs' (B of
+// two-ball shots too), and what depends on them is recomputed from the
+// current cue ball and balls:
+// - object_aim: the hole for direct shots, the cushion contact for bank
+//   and flip shots (on the cushion the cached contact lies on), the ghost
+//   ball or kiss point for two-ball shots
+// - total_distance, from the recomputed points
+// aim_margin is kept. Shots whose cushion contact no longer lands on the
+// cushion, or whose kiss no longer exists, are dropped; the order of the
+// rest is kept. Returns the number of shots left.
+// ---------------------------------------------------------------------------
+size_t rebaseCachedPlan(
+    std::vector<ShotCandidate>& ranked,
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& childballs,
+    const TableModel& table,
+    double ball_diameter
+);
+
+#endif // PLAN_CACHE_H
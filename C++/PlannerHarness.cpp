@@ -0,0 +1,994 @@
+// PlannerHarness.cpp
+// ===========================================================================
+// Implements corpus generation and the precision/speed comparison of the
+// templated planners.
+// ===========================================================================
+
+#include "PlannerHarness.h"
+#include "AnytimePlanner.h"
+#include "ShotPlanner.h"
+#include "FlipPlanner.h"
+#include "GhostBallSolver.h"
+#include "OutcomeTables.h"
+#include "ScratchFilter.h"
+#include "ShotSearch.h"
+#include "BallSimulator.h"
+#include "BatchRollout.h"
+#include "PlanCache.h"
+#include "TableState.h"
+#include "ThreadPool.h"
+#include "TranspositionTable.h"
+#include "GeometryUtils.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+#include <utility>
+
+std::vector<PlannerScenario> generateScenarioCorpus(
+    const std::vector<std::vector<double>>& holes,
+    const std::vector<std::vector<double>>& walls,
+    int count,
+    int max_balls,
+    double ball_diameter,
+    unsigned seed
+) {
+    // Table area = bounding box of the pockets, shrunk by one ball
+    double min_x = holes[0][0], max_x = holes[0][0];
+    double min_y = holes[0][1], max_y = holes[0][1];
+    for (const auto& hole : holes) {
+        min_x = std::min(min_x, hole[0]);
+        max_x = std::max(max_x, hole[0]);
+        min_y = std::min(min_y, hole[1]);
+        max_y = std::max(max_y, hole[1]);
+    }
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> pick_x(min_x + ball_diameter, max_x - ball_diameter);
+    std::uniform_real_distribution<double> pick_y(min_y + ball_diameter, max_y - ball_diameter);
+    std::uniform_int_distribution<int> pick_count(1, max_balls);
+
+    std::vector<PlannerScenario> corpus;
+    for (int i = 0; i < count; ++i) {
+        PlannerScenario scenario;
+        scenario.holes = holes;
+        scenario.walls = walls;
+
+        int balls = pick_count(rng) + 1;  // + cue ball
+        std::vector<std::vector<double>> placed;
+        while (static_cast<int>(placed.size()) < balls) {
+            double x = pick_x(rng);
+            double y = pick_y(rng);
+            bool overlaps = false;
+            for (const auto& p : placed) {
+                if (mag(p[0] - x, p[1] - y) < ball_diameter) {
+                    overlaps = true;
+                    break;
+                }
+            }
+            if (!overlaps) placed.push_back({x, y});
+        }
+        scenario.cueball = placed[0];
+        scenario.childballs.assign(placed.begin() + 1, placed.end());
+        corpus.push_back(scenario);
+    }
+    return corpus;
+}
+
+// ---------------------------------------------------------------------------
+// Layout converted to one coordinate type.
+// ---------------------------------------------------------------------------
+template <typename Scalar>
+struct TypedScenario {
+    std::vector<std::vector<Scalar>> cueballs;
+    std::vector<std::vector<Scalar>> childballs;
+    std::vector<std::vector<Scalar>> holes;
+    std::vector<std::vector<Scalar>> walls;
+};
+
+template <typename Scalar>
+static std::vector<std::vector<Scalar>> convertPoints(const std::vector<std::vector<double>>& points) {
+    std::vector<std::vector<Scalar>> out;
+    for (const auto& p : points) {
+        out.push_back({ScalarTraits<Scalar>::fromMillimeters(p[0]),
+                       ScalarTraits<Scalar>::fromMillimeters(p[1])});
+    }
+    return out;
+}
+
+template <typename Scalar>
+static TypedScenario<Scalar> convertScenario(const PlannerScenario& scenario) {
+    TypedScenario<Scalar> typed;
+    typed.cueballs = convertPoints<Scalar>({scenario.cueball});
+    typed.childballs = convertPoints<Scalar>(scenario.childballs);
+    typed.holes = convertPoints<Scalar>(scenario.holes);
+    typed.walls = convertPoints<Scalar>(scenario.walls);
+    return typed;
+}
+
+template <typename Scalar>
+static int indexOf(const std::vector<std::vector<Scalar>>& points, const std::vector<Scalar>& p) {
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (points[i] == p) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+// ---------------------------------------------------------------------------
+// Decisions of one planner variant on one layout, by ball/hole/wall index
+// so they can be compared across coordinate types.
+// best = (is_flip, child or target index, hole or wall index)
+// ---------------------------------------------------------------------------
+struct PlannerDecision {
+    std::vector<std::pair<int, int>> direct;
+    std::vector<std::pair<int, int>> flips;
+    std::vector<int> best;
+};
+
+template <typename Scalar>
+static PlannerDecision decide(const TypedScenario<Scalar>& s, Scalar bound_radius) {
+    typedef typename ScalarTraits<Scalar>::Real Real;
+    PlannerDecision decision;
+    Real best_distance = 0;
+
+    auto shots = selectClearShots(s.cueballs, s.holes, s.childballs, bound_radius);
+    for (const auto& shot : shots) {
+        int c = indexOf(s.childballs, shot.first);
+        int h = indexOf(s.holes, shot.second);
+        decision.direct.emplace_back(c, h);
+        const auto& cue = s.cueballs[0];
+        Real distance = mag(shot.first[0] - shot.second[0], shot.first[1] - shot.second[1]) +
+                        mag(cue[0] - shot.first[0], cue[1] - shot.first[1]);
+        if (decision.best.empty() || distance < best_distance) {
+            best_distance = distance;
+            decision.best = {0, c, h};
+        }
+    }
+
+    // Same loop as evaluateFlipShots, keeping the wall index
+    for (size_t w = 0; w < s.walls.size(); ++w) {
+        for (size_t t = 0; t < s.childballs.size(); ++t) {
+            BasicFlipShot<Scalar> fs;
+            if (!computeFlipShot(s.cueballs[0], s.childballs[t], s.walls[w], fs)) continue;
+            if (isFlipObstructed(s.cueballs[0], fs, s.childballs, bound_radius)) continue;
+            decision.flips.emplace_back(static_cast<int>(w), static_cast<int>(t));
+            if (shots.empty() && (decision.best.empty() || fs.total_distance < best_distance)) {
+                best_distance = fs.total_distance;
+                decision.best = {1, static_cast<int>(t), static_cast<int>(w)};
+            }
+        }
+    }
+
+    std::sort(decision.direct.begin(), decision.direct.end());
+    std::sort(decision.flips.begin(), decision.flips.end());
+    return decision;
+}
+
+// ---------------------------------------------------------------------------
+// Decisions and timing for one coordinate type over the whole corpus.
+// ---------------------------------------------------------------------------
+template <typename Scalar>
+static double runVariant(
+    const std::vector<PlannerScenario>& corpus,
+    double bound_radius,
+    int repeats,
+    std::vector<PlannerDecision>& decisions
+) {
+    Scalar radius = ScalarTraits<Scalar>::fromMillimeters(bound_radius);
+    std::vector<TypedScenario<Scalar>> typed;
+    for (const auto& scenario : corpus) {
+        typed.push_back(convertScenario<Scalar>(scenario));
+    }
+
+    decisions.clear();
+    for (const auto& s : typed) {
+        decisions.push_back(decide(s, radius));
+    }
+
+    // Time the planner calls only (no conversion or bookkeeping)
+    volatile size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (const auto& s : typed) {
+            sink = sink + selectClearShots(s.cueballs, s.holes, s.childballs, radius).size();
+            sink = sink + evaluateFlipShots(s.cueballs[0], s.childballs, s.childballs, s.walls, radius).size();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double micros = std::chrono::duration<double, std::micro>(end - start).count();
+    return micros / (static_cast<double>(repeats) * static_cast<double>(corpus.size()));
+}
+
+static PrecisionReport compareDecisions(
+    const std::string& name,
+    const std::vector<PlannerDecision>& reference,
+    const std::vector<PlannerDecision>& variant,
+    double micros_per_plan,
+    double reference_micros
+) {
+    PrecisionReport report;
+    report.scalar_name = name;
+    report.scenarios = static_cast<int>(reference.size());
+    report.direct_diverged = 0;
+    report.flip_diverged = 0;
+    report.best_diverged = 0;
+    for (size_t i = 0; i < reference.size(); ++i) {
+        bool direct = reference[i].direct != variant[i].direct;
+        bool flip = reference[i].flips != variant[i].flips;
+        bool best = reference[i].best != variant[i].best;
+        report.direct_diverged += direct;
+        report.flip_diverged += flip;
+        report.best_diverged += best;
+        if (direct || flip || best) report.diverged_scenarios.push_back(static_cast<int>(i));
+    }
+    report.micros_per_plan = micros_per_plan;
+    report.speedup = micros_per_plan > 0 ? reference_micros / micros_per_plan : 0;
+    return report;
+}
+
+std::vector<PrecisionReport> comparePlannerPrecision(
+    const std::vector<PlannerScenario>& corpus,
+    double bound_radius,
+    int repeats
+) {
+    std::vector<PlannerDecision> reference, as_float, as_fixed;
+    double t_double = runVariant<double>(corpus, bound_radius, repeats, reference);
+    double t_float = runVariant<float>(corpus, bound_radius, repeats, as_float);
+    double t_fixed = runVariant<FixedPoint>(corpus, bound_radius, repeats, as_fixed);
+
+    std::vector<PrecisionReport> reports;
+    reports.push_back(compareDecisions("double", reference, reference, t_double, t_double));
+    reports.push_back(compareDecisions("float", reference, as_float, t_float, t_double));
+    reports.push_back(compareDecisions("fixed 0.1mm", reference, as_fixed, t_fixed, t_double));
+    return reports;
+}
+
+ClearanceReport compareClearance(
+    const std::vector<PlannerScenario>& corpus,
+    double bound_radius,
+    int repeats
+) {
+    ClearanceReport report = {0, 0, 0, 0, 0, 0};
+    ClearanceStats stats = {0, 0};
+    for (const auto& s : corpus) {
+        for (const auto& child : s.childballs) {
+            ++report.segments;
+            if (isPathObstructed(s.cueball[0], s.cueball[1], child[0], child[1], s.childballs, bound_radius, &stats)) {
+                ++report.blocked;
+            }
+            for (const auto& hole : s.holes) {
+                ++report.segments;
+                if (isPathObstructed(child[0], child[1], hole[0], hole[1], s.childballs, bound_radius, &stats)) {
+                    ++report.blocked;
+                }
+            }
+        }
+    }
+    report.obstacles_tested = stats.obstacles_tested;
+    report.box_rejected = stats.box_rejected;
+    report.box_reject_rate = stats.obstacles_tested
+        ? static_cast<double>(stats.box_rejected) / stats.obstacles_tested : 0;
+    if (report.segments == 0) return report;
+
+    volatile int sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (const auto& s : corpus) {
+            for (const auto& child : s.childballs) {
+                sink = sink + isPathObstructed(s.cueball[0], s.cueball[1], child[0], child[1], s.childballs, bound_radius);
+                for (const auto& hole : s.holes) {
+                    sink = sink + isPathObstructed(child[0], child[1], hole[0], hole[1], s.childballs, bound_radius);
+                }
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    report.nanos_per_segment = std::chrono::duration<double, std::nano>(end - start).count() /
+                               (static_cast<double>(repeats) * report.segments);
+    return report;
+}
+
+// Cue ball first, then the child balls, as BallSimulator::reset takes them
+static std::vector<std::vector<double>> simulatorBalls(const PlannerScenario& s) {
+    std::vector<std::vector<double>> balls;
+    balls.push_back(s.cueball);
+    balls.insert(balls.end(), s.childballs.begin(), s.childballs.end());
+    return balls;
+}
+
+// ---------------------------------------------------------------------------
+// Places 'balls' (from simulatorBalls) in 'sim' and plays the strike: the
+// cue ball is sent at the first child ball to roll 'strike_roll' mm.
+// ---------------------------------------------------------------------------
+static void simulateStrike(BallSimulator& sim, const std::vector<std::vector<double>>& balls, double strike_roll) {
+    sim.reset(balls);
+    if (balls.size() < 2) return;
+    double dx = balls[1][0] - balls[0][0];
+    double dy = balls[1][1] - balls[0][1];
+    double length = mag(dx, dy);
+    double speed = sim.speedForRoll(strike_roll);
+    sim.strike(0, dx / length * speed, dy / length * speed);
+    sim.run();
+}
+
+BroadphaseReport compareBroadphase(
+    const std::vector<PlannerScenario>& corpus,
+    double bound_radius,
+    double pocket_mouth,
+    double strike_roll,
+    int repeats
+) {
+    BroadphaseReport report = {static_cast<int>(corpus.size()), 0, 0, 0, 0, 0, 0};
+    if (corpus.empty()) return report;
+
+    std::vector<TableModel> tables;
+    std::vector<std::vector<std::vector<double>>> layouts;
+    for (const auto& s : corpus) {
+        tables.push_back(buildTableModel(s.holes, s.walls, pocket_mouth, bound_radius / 2));
+        layouts.push_back(simulatorBalls(s));
+    }
+
+    size_t events = 0, naive_tests = 0, broadphase_tests = 0;
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        BallSimulator naive(tables[i], bound_radius / 2, false);
+        BallSimulator swept(tables[i], bound_radius / 2, true);
+        simulateStrike(naive, layouts[i], strike_roll);
+        simulateStrike(swept, layouts[i], strike_roll);
+        bool same = naive.stats().events == swept.stats().events;
+        for (size_t b = 0; b < naive.ballCount(); ++b) {
+            double x1, y1, x2, y2;
+            naive.position(b, x1, y1);
+            swept.position(b, x2, y2);
+            if (x1 != x2 || y1 != y2 || naive.state(b) != swept.state(b)) same = false;
+        }
+        if (!same) ++report.mismatches;
+        events += swept.stats().events;
+        naive_tests += naive.stats().pair_tests;
+        broadphase_tests += swept.stats().pair_tests;
+    }
+
+    double rollouts = static_cast<double>(repeats) * static_cast<double>(corpus.size());
+    double micros[2];
+    for (int mode = 0; mode < 2; ++mode) {
+        volatile size_t sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r) {
+            for (size_t i = 0; i < corpus.size(); ++i) {
+                BallSimulator sim(tables[i], bound_radius / 2, mode == 1);
+                simulateStrike(sim, layouts[i], strike_roll);
+                sink = sink + sim.stats().events;
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        micros[mode] = std::chrono::duration<double, std::micro>(end - start).count() / rollouts;
+    }
+
+    double n = static_cast<double>(corpus.size());
+    report.events = events / n;
+    report.naive_pair_tests = naive_tests / n;
+    report.broadphase_pair_tests = broadphase_tests / n;
+    report.naive_micros = micros[0];
+    report.broadphase_micros = micros[1];
+    return report;
+}
+
+SimulatorPoolReport measureSimulatorPool(
+    const std::vector<PlannerScenario>& corpus,
+    double bound_radius,
+    double pocket_mouth,
+    double strike_roll,
+    int repeats,
+    size_t (*allocation_count)()
+) {
+    SimulatorPoolReport report = {static_cast<int>(corpus.size()), 0, 0, 0, 0, 0};
+    if (corpus.empty()) return report;
+
+    std::vector<TableModel> tables;
+    std::vector<std::vector<std::vector<double>>> layouts;
+    for (const auto& s : corpus) {
+        tables.push_back(buildTableModel(s.holes, s.walls, pocket_mouth, bound_radius / 2));
+        layouts.push_back(simulatorBalls(s));
+    }
+    // The pool: one simulator per table, built before timing starts
+    std::vector<BallSimulator> pool;
+    pool.reserve(tables.size());
+    for (const auto& table : tables) pool.emplace_back(table, bound_radius / 2);
+
+    double rollouts = static_cast<double>(repeats) * static_cast<double>(corpus.size());
+    size_t stale = 0;
+    volatile size_t sink = 0;
+
+    size_t allocations = allocation_count();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        for (int r = 0; r < repeats; ++r) {
+            BallSimulator sim(tables[i], bound_radius / 2);
+            simulateStrike(sim, layouts[i], strike_roll);
+            sink = sink + sim.stats().events;
+        }
+    }
+    auto fresh_end = std::chrono::steady_clock::now();
+    report.fresh_allocations = (allocation_count() - allocations) / rollouts;
+
+    allocations = allocation_count();
+    auto pooled_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        for (int r = 0; r < repeats; ++r) {
+            simulateStrike(pool[i], layouts[i], strike_roll);
+            sink = sink + pool[i].stats().events;
+            stale += pool[i].stats().stale_events;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    report.pooled_allocations = (allocation_count() - allocations) / rollouts;
+
+    report.stale_events = stale / rollouts;
+    report.fresh_micros = std::chrono::duration<double, std::micro>(fresh_end - start).count() / rollouts;
+    report.pooled_micros = std::chrono::duration<double, std::micro>(end - pooled_start).count() / rollouts;
+    return report;
+}
+
+// ---------------------------------------------------------------------------
+// Variants of the shot at the first child ball: the aim sweeps the angles
+// that still touch it (cut up to 90 degrees) and the roll steps through
+// [min_roll, max_roll] in a different order, so aims and rolls mix.
+// ---------------------------------------------------------------------------
+static std::vector<RolloutVariant> shotVariants(
+    const PlannerScenario& s, double bound_radius, int count, double min_roll, double max_roll
+) {
+    std::vector<RolloutVariant> variants;
+    double dx = s.childballs[0][0] - s.cueball[0];
+    double dy = s.childballs[0][1] - s.cueball[1];
+    double length = mag(dx, dy);
+    double centre = std::atan2(dy, dx);
+    double spread = std::asin(std::min(1.0, bound_radius / length));
+    for (int v = 0; v < count; ++v) {
+        double f = count > 1 ? static_cast<double>(v) / (count - 1) : 0.5;
+        double angle = centre + (2 * f - 1) * spread;
+        double g = static_cast<double>((v * 7) % count) / count;
+        variants.push_back({std::cos(angle), std::sin(angle), min_roll + g * (max_roll - min_roll)});
+    }
+    return variants;
+}
+
+BatchRolloutReport compareBatchRollout(
+    const std::vector<PlannerScenario>& corpus,
+    double bound_radius,
+    double pocket_mouth,
+    int variants_per_layout,
+    double min_roll,
+    double max_roll,
+    int repeats
+) {
+    BatchRolloutReport report = {0, 0, 0, 0, 0};
+    std::vector<TableModel> tables;
+    std::vector<std::vector<RolloutVariant>> variants;
+    std::vector<const PlannerScenario*> layouts;
+    for (const auto& s : corpus) {
+        if (s.childballs.empty()) continue;
+        tables.push_back(buildTableModel(s.holes, s.walls, pocket_mouth, bound_radius / 2));
+        variants.push_back(shotVariants(s, bound_radius, variants_per_layout, min_roll, max_roll));
+        layouts.push_back(&s);
+    }
+    if (layouts.empty()) return report;
+
+    std::vector<RolloutOutcome> batch(variants_per_layout);
+    for (size_t i = 0; i < layouts.size(); ++i) {
+        BatchRollout rollout(tables[i], layouts[i]->cueball, layouts[i]->childballs, bound_radius);
+        rollout.run(variants[i].data(), variants[i].size(), batch.data());
+        for (size_t v = 0; v < variants[i].size(); ++v) {
+            if (!sameOutcome(batch[v], rollout.reference(variants[i][v]))) ++report.mismatches;
+            if (batch[v].target >= 0) ++report.contacts;
+        }
+        report.rollouts += static_cast<int>(variants[i].size());
+    }
+
+    double rollouts = static_cast<double>(repeats) * report.rollouts;
+    double seconds[2];
+    for (int mode = 0; mode < 2; ++mode) {
+        volatile int sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r) {
+            for (size_t i = 0; i < layouts.size(); ++i) {
+                BatchRollout rollout(tables[i], layouts[i]->cueball, layouts[i]->childballs, bound_radius);
+                if (mode == 0) {
+                    for (size_t v = 0; v < variants[i].size(); ++v) {
+                        sink = sink + rollout.reference(variants[i][v]).cue_bounces;
+                    }
+                } else {
+                    rollout.run(variants[i].data(), variants[i].size(), batch.data());
+                    sink = sink + batch[0].cue_bounces;
+                }
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        seconds[mode] = std::chrono::duration<double>(end - start).count();
+    }
+    report.scalar_per_second = rollouts / seconds[0];
+    report.batch_per_second = rollouts / seconds[1];
+    return report;
+}
+
+TableStateReport measureTableStateBranching(
+    const std::vector<PlannerScenario>& corpus,
+    double tolerance,
+    int repeats
+) {
+    TableStateReport report = {0, static_cast<int>(sizeof(TableState)), 0, 0, 0};
+    std::vector<TableState> states;
+    std::vector<const PlannerScenario*> layouts;
+    for (const auto& s : corpus) {
+        TableState state;
+        if (!makeTableState(s.cueball, s.childballs, state)) continue;
+        states.push_back(state);
+        layouts.push_back(&s);
+        report.branches += static_cast<int>(s.childballs.size());
+    }
+    if (layouts.empty()) return report;
+
+    // The state hash after each branch edit against the list hash
+    for (size_t i = 0; i < layouts.size(); ++i) {
+        const PlannerScenario& s = *layouts[i];
+        TableStateStack stack(states[i], 1);
+        for (size_t k = 0; k < s.childballs.size(); ++k) {
+            stack.branch();
+            stack.top().moveCueBall(s.childballs[k][0], s.childballs[k][1]);
+            stack.top().removeBall(k);
+            std::vector<std::vector<double>> rest = s.childballs;
+            rest.erase(rest.begin() + k);
+            if (hashTableState(stack.top(), tolerance) != hashTableState(s.childballs[k], rest, tolerance)) {
+                ++report.hash_mismatches;
+            }
+            stack.rollback();
+        }
+    }
+
+    double branches = static_cast<double>(repeats) * report.branches;
+    volatile double sink = 0;
+    double total = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (size_t i = 0; i < layouts.size(); ++i) {
+            const PlannerScenario& s = *layouts[i];
+            for (size_t k = 0; k < s.childballs.size(); ++k) {
+                std::vector<double> cue = s.childballs[k];
+                std::vector<std::vector<double>> rest = s.childballs;
+                rest.erase(rest.begin() + k);
+                sink = sink + cue[0] + static_cast<double>(rest.size());
+            }
+        }
+    }
+    std::vector<TableStateStack> stacks;
+    for (const auto& state : states) stacks.emplace_back(state, 1);
+    auto middle = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (auto& stack : stacks) {
+            for (size_t k = 0; k < stack.top().slots; ++k) {
+                stack.branch();
+                TableState& branch = stack.top();
+                branch.moveCueBall(branch.x[k], branch.y[k]);
+                branch.removeBall(k);
+                total += branch.cue_x + branch.ballCount();
+                stack.rollback();
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    sink = total;
+    report.list_nanos = std::chrono::duration<double, std::nano>(middle - start).count() / branches;
+    report.state_nanos = std::chrono::duration<double, std::nano>(end - middle).count() / branches;
+    return report;
+}
+
+// Entry the transposition benchmark stores for 'key'
+static TranspositionEntry benchmarkEntry(uint64_t key) {
+    TranspositionEntry entry;
+    entry.value = static_cast<float>(key % 100000) / 1000.0f;
+    entry.shot = static_cast<uint16_t>((key >> 20) & 0x7fff);
+    entry.depth = static_cast<uint8_t>((key >> 40) & 15);
+    return entry;
+}
+
+static bool sameEntry(const TranspositionEntry& a, const TranspositionEntry& b) {
+    return a.value == b.value && a.shot == b.shot && a.depth == b.depth;
+}
+
+TranspositionReport compareTranspositionTables(
+    const std::vector<PlannerScenario>& corpus,
+    double tolerance,
+    int threads,
+    size_t operations_per_thread,
+    size_t memory_bytes
+) {
+    std::vector<uint64_t> keys;
+    for (const auto& s : corpus) {
+        TableState state;
+        if (!makeTableState(s.cueball, s.childballs, state)) continue;
+        TableStateStack stack(state, 1);
+        keys.push_back(hashTableState(stack.top(), tolerance));
+        for (size_t k = 0; k < state.slots; ++k) {
+            stack.branch();
+            stack.top().moveCueBall(state.x[k], state.y[k]);
+            stack.top().removeBall(k);
+            keys.push_back(hashTableState(stack.top(), tolerance));
+            stack.rollback();
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    TranspositionTable table(memory_bytes);
+    TranspositionReport report = {threads, static_cast<size_t>(threads) * operations_per_thread,
+                                  keys.size(), table.memoryBytes(), 0, 0, 0, 0, 0};
+    if (keys.empty() || threads <= 0) return report;
+
+    ThreadPool pool(static_cast<size_t>(threads));
+    std::mutex map_mutex;
+    std::unordered_map<uint64_t, TranspositionEntry> map;
+
+    // mode 0: lock-free table, mode 1: mutex map
+    double seconds[2];
+    double hit_rate[2];
+    std::atomic<size_t> wrong(0);
+    for (int mode = 0; mode < 2; ++mode) {
+        std::atomic<size_t> probes(0), hits(0);
+        auto task = [&](size_t t) {
+            std::mt19937_64 rng(t + 1);
+            size_t my_probes = 0, my_hits = 0, my_wrong = 0;
+            for (size_t op = 0; op < operations_per_thread; ++op) {
+                uint64_t r = rng();
+                uint64_t key = keys[r % keys.size()];
+                bool is_store = (r >> 62) == 0;
+                TranspositionEntry entry;
+                if (is_store) {
+                    entry = benchmarkEntry(key);
+                    if (mode == 0) {
+                        table.store(key, entry);
+                    } else {
+                        std::lock_guard<std::mutex> lock(map_mutex);
+                        map[key] = entry;
+                    }
+                    continue;
+                }
+                bool found;
+                if (mode == 0) {
+                    found = table.probe(key, entry);
+                } else {
+                    std::lock_guard<std::mutex> lock(map_mutex);
+                    auto it = map.find(key);
+                    found = it != map.end();
+                    if (found) entry = it->second;
+                }
+                ++my_probes;
+                if (found) {
+                    ++my_hits;
+                    if (!sameEntry(entry, benchmarkEntry(key))) ++my_wrong;
+                }
+            }
+            probes += my_probes;
+            hits += my_hits;
+            wrong += my_wrong;
+        };
+        auto start = std::chrono::steady_clock::now();
+        pool.parallelFor(static_cast<size_t>(threads), task);
+        auto end = std::chrono::steady_clock::now();
+        seconds[mode] = std::chrono::duration<double>(end - start).count();
+        hit_rate[mode] = probes > 0 ? static_cast<double>(hits) / static_cast<double>(probes) : 0;
+    }
+
+    double operations = static_cast<double>(report.operations);
+    report.lock_free_hit_rate = hit_rate[0];
+    report.map_hit_rate = hit_rate[1];
+    report.wrong_entries = wrong;
+    report.lock_free_ops_per_second = operations / seconds[0];
+    report.mutex_ops_per_second = operations / seconds[1];
+    return report;
+}
+
+// Cue aim errors sampled by compareAimMargins: from AIM_SAMPLE_START, each
+// step AIM_SAMPLE_RATIO times the last, up to AIM_SAMPLE_LIMIT (radians)
+static const double AIM_SAMPLE_START = 1e-6;
+static const double AIM_SAMPLE_RATIO = 1 + 1.0 / 64;
+static const double AIM_SAMPLE_LIMIT = 1.5;
+
+// ---------------------------------------------------------------------------
+// True if the cue ball at (cx, cy), sent along the unit vector (ax, ay),
+// hits the target at (tx, ty) and sends it within 'margin' radians of the
+// unit direction (ux0, uy0).
+// ---------------------------------------------------------------------------
+static bool aimPots(
+    double cx, double cy, double tx, double ty, double ax, double ay,
+    double ball_diameter, double ux0, double uy0, double margin
+) {
+    double wx = tx - cx;
+    double wy = ty - cy;
+    double along = wx * ax + wy * ay;
+    double off2 = wx * wx + wy * wy - along * along;
+    if (along <= 0 || off2 >= ball_diameter * ball_diameter) return false;
+    double s = along - std::sqrt(ball_diameter * ball_diameter - off2);
+    double ux = wx - s * ax;
+    double uy = wy - s * ay;
+    return std::abs(std::atan2(ux0 * uy - uy0 * ux, ux0 * ux + uy0 * uy)) <= margin;
+}
+
+// Smallest sampled cue aim error (either side) that does not pot shot 'i'
+static double sampledCueMargin(const GhostBallBatch& batch, size_t i, double ball_diameter, double margin) {
+    double ux0 = (batch.target_x[i] - batch.ghost_x[i]) / ball_diameter;
+    double uy0 = (batch.target_y[i] - batch.ghost_y[i]) / ball_diameter;
+    double delta = AIM_SAMPLE_START;
+    for (; delta < AIM_SAMPLE_LIMIT; delta *= AIM_SAMPLE_RATIO) {
+        for (int side = -1; side <= 1; side += 2) {
+            double c = std::cos(side * delta);
+            double s = std::sin(side * delta);
+            double ax = batch.aim_x[i] * c - batch.aim_y[i] * s;
+            double ay = batch.aim_x[i] * s + batch.aim_y[i] * c;
+            if (!aimPots(batch.cue_x[i], batch.cue_y[i], batch.target_x[i], batch.target_y[i],
+                         ax, ay, ball_diameter, ux0, uy0, margin)) {
+                return delta;
+            }
+        }
+    }
+    return delta;
+}
+
+// Solves 'shots' from 'cueball' into a fresh batch, with their cue margins
+static void solveShotMargins(
+    const std::vector<double>& cueball,
+    const std::vector<ShotCandidate>& shots,
+    double bound_radius,
+    GhostBallBatch& batch
+) {
+    batch = GhostBallBatch();
+    for (const auto& shot : shots) {
+        addGhostBallShot(batch, cueball, shot.target_coords, shot.object_aim, shot.aim_margin);
+    }
+    solveGhostBalls(batch, bound_radius);
+}
+
+AimMarginReport compareAimMargins(
+    const std::vector<PlannerScenario>& corpus,
+    double bound_radius,
+    double pocket_mouth,
+    size_t max_shots,
+    int repeats
+) {
+    AimMarginReport report = {0, 0, 0, 0, 0, 0};
+    std::vector<const PlannerScenario*> layouts;
+    std::vector<std::vector<ShotCandidate>> shots;
+    for (const auto& s : corpus) {
+        TableModel table = buildTableModel(s.holes, s.walls, pocket_mouth, bound_radius / 2);
+        PlanStats stats;
+        std::vector<ShotCandidate> direct;
+        for (const auto& shot : planShots(s.cueball, s.childballs, table, bound_radius, max_shots, stats)) {
+            if (shot.kind == DIRECT_SHOT && shot.aim_margin > 0) direct.push_back(shot);
+        }
+        if (direct.empty()) continue;
+        layouts.push_back(&s);
+        shots.push_back(direct);
+    }
+
+    double error_sum = 0;
+    int margin_agree = 0, distance_agree = 0, pairs = 0;
+    for (size_t l = 0; l < layouts.size(); ++l) {
+        GhostBallBatch batch;
+        solveShotMargins(layouts[l]->cueball, shots[l], bound_radius, batch);
+
+        std::vector<double> analytic, sampled, distance;
+        for (size_t i = 0; i < shots[l].size(); ++i) {
+            if (batch.cue_margin[i] <= 0) continue;
+            analytic.push_back(batch.cue_margin[i]);
+            sampled.push_back(sampledCueMargin(batch, i, bound_radius, shots[l][i].aim_margin));
+            distance.push_back(shots[l][i].total_distance);
+            error_sum += std::abs(analytic.back() - sampled.back()) / sampled.back();
+        }
+        report.shots += static_cast<int>(analytic.size());
+        for (size_t i = 0; i < sampled.size(); ++i) {
+            for (size_t j = i + 1; j < sampled.size(); ++j) {
+                if (sampled[i] == sampled[j]) continue;
+                ++pairs;
+                if ((analytic[i] - analytic[j]) * (sampled[i] - sampled[j]) > 0) ++margin_agree;
+                if ((distance[j] - distance[i]) * (sampled[i] - sampled[j]) > 0) ++distance_agree;
+            }
+        }
+    }
+    if (report.shots == 0) return report;
+    report.mean_relative_error = error_sum / report.shots;
+    report.margin_pair_agreement = pairs ? static_cast<double>(margin_agree) / pairs : 1;
+    report.distance_pair_agreement = pairs ? static_cast<double>(distance_agree) / pairs : 1;
+
+    size_t shot_count = 0;
+    for (const auto& list : shots) shot_count += list.size();
+    double timed_shots = static_cast<double>(repeats) * static_cast<double>(shot_count);
+    volatile double sink = 0;
+    GhostBallBatch batch;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (size_t l = 0; l < layouts.size(); ++l) {
+            solveShotMargins(layouts[l]->cueball, shots[l], bound_radius, batch);
+            sink = sink + batch.cue_margin[0];
+        }
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (size_t l = 0; l < layouts.size(); ++l) {
+            solveShotMargins(layouts[l]->cueball, shots[l], bound_radius, batch);
+            for (size_t i = 0; i < shots[l].size(); ++i) {
+                sink = sink + sampledCueMargin(batch, i, bound_radius, shots[l][i].aim_margin);
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    report.analytic_nanos = std::chrono::duration<double, std::nano>(middle - start).count() / timed_shots;
+    report.sampled_nanos = std::chrono::duration<double, std::nano>(end - middle).count() / timed_shots;
+    return report;
+}
+
+OutcomeTableReport compareOutcomeTables(
+    const std::string& path,
+    double ball_diameter,
+    double mouth_width,
+    int samples,
+    unsigned seed
+) {
+    OutcomeTableReport report = {0, 0, 0, 0, 0, 0};
+    const OutcomeTableOptions options = defaultOutcomeTableOptions();
+    ThreadPool pool;
+    auto start = std::chrono::steady_clock::now();
+    if (!generateOutcomeTables(path, ball_diameter, mouth_width, options, pool)) return report;
+    report.generate_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    OutcomeTables tables;
+    if (!tables.open(path, ball_diameter, mouth_width) || samples <= 0) return report;
+
+    struct Query {
+        double cut, speed, angle, offset;
+    };
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<Query> queries(samples);
+    for (auto& q : queries) {
+        q.cut = unit(rng) * std::acos(0.0);
+        q.speed = unit(rng) * options.max_speed;
+        q.angle = (2 * unit(rng) - 1) * options.max_entry_angle;
+        q.offset = (unit(rng) - 0.5) * mouth_width;
+    }
+
+    int agree = 0;
+    for (const auto& q : queries) {
+        double error = std::abs(tables.throwAngle(q.cut, q.speed) - collisionThrow(q.cut, q.speed));
+        report.throw_max_error = std::max(report.throw_max_error, error);
+        report.throw_mean_error += error / samples;
+        bool predicted = tables.captureChance(q.angle, q.offset) >= 0.5;
+        if (predicted == simulateCapture(q.angle, q.offset, ball_diameter, mouth_width)) ++agree;
+    }
+    report.capture_agreement = static_cast<double>(agree) / samples;
+
+    volatile double sink = 0;
+    auto table_start = std::chrono::steady_clock::now();
+    for (const auto& q : queries) {
+        sink = sink + tables.throwAngle(q.cut, q.speed) + tables.captureChance(q.angle, q.offset);
+    }
+    auto model_start = std::chrono::steady_clock::now();
+    for (const auto& q : queries) {
+        sink = sink + collisionThrow(q.cut, q.speed) + simulateCapture(q.angle, q.offset, ball_diameter, mouth_width);
+    }
+    auto end = std::chrono::steady_clock::now();
+    report.table_nanos = std::chrono::duration<double, std::nano>(model_start - table_start).count() / samples;
+    report.model_nanos = std::chrono::duration<double, std::nano>(end - model_start).count() / samples;
+    return report;
+}
+
+// ---------------------------------------------------------------------------
+// Rolls the stun path of 'contact' out among 'obstacles'. Returns true if
+// the cue ball is pocketed, with the cushions it took on the way in
+// 'bounces'.
+// ---------------------------------------------------------------------------
+static bool stunScratches(
+    const TableModel& table,
+    const CueContact& contact,
+    const std::vector<std::vector<double>>& obstacles,
+    double bound_radius,
+    int& bounces
+) {
+    bounces = 0;
+    double tx = contact.in_x - contact.cos_cut * contact.line_x;
+    double ty = contact.in_y - contact.cos_cut * contact.line_y;
+    double tangent = std::sqrt(tx * tx + ty * ty);
+    double roll = contact.remaining * (1 - contact.cos_cut * contact.cos_cut);
+    if (tangent < 1e-9 || roll <= 0) return false;
+    double end_x, end_y;
+    return rollOnTable(table, contact.x, contact.y, tx / tangent, ty / tangent, roll, obstacles,
+                       bound_radius, end_x, end_y, bounces) == ROLL_POCKETED;
+}
+
+ScratchFilterReport compareScratchPrefilter(
+    const std::vector<PlannerScenario>& corpus,
+    double bound_radius,
+    double pocket_mouth,
+    size_t max_shots,
+    int repeats
+) {
+    ScratchFilterReport report = {0, 0, 0, 0, 0, 0, 0, 0};
+    std::vector<const PlannerScenario*> layouts;
+    std::vector<TableModel> tables;
+    std::vector<std::vector<ShotCandidate>> shots;
+    std::vector<std::vector<CueContact>> contacts;
+    for (const auto& s : corpus) {
+        TableModel table = buildTableModel(s.holes, s.walls, pocket_mouth, bound_radius / 2);
+        ShotSearch search(s.cueball, s.childballs, table, bound_radius);
+        std::vector<ShotCandidate> found;
+        std::vector<CueContact> layout;
+        CueContact contact;
+        for (const auto& shot : search.search(DIRECT_TIER | CUSHION_TIER | COMBINATION_TIER, max_shots)) {
+            if (!cueContact(shot, s.cueball, bound_radius, VALIDATION_SPEED_MARGIN, contact)) continue;
+            found.push_back(shot);
+            layout.push_back(contact);
+        }
+        if (layout.empty()) continue;
+        layouts.push_back(&s);
+        tables.push_back(table);
+        shots.push_back(found);
+        contacts.push_back(layout);
+        report.shots += static_cast<int>(layout.size());
+    }
+    if (report.shots == 0) return report;
+
+    int caught = 0, stun_flags = 0, confirmed = 0, flagged = 0;
+    for (size_t l = 0; l < tables.size(); ++l) {
+        ScratchBatch batch;
+        for (const auto& c : contacts[l]) addScratchShot(batch, c);
+        flagScratchRisk(batch, tables[l].pockets, bound_radius / 2);
+        for (size_t i = 0; i < contacts[l].size(); ++i) {
+            int bounces;
+            bool scratch = stunScratches(tables[l], contacts[l][i], {}, bound_radius, bounces);
+            if (scratch) ++report.rollout_scratches;
+            if (scratch && bounces == 0) {
+                ++report.straight_scratches;
+                if (batch.stun_risk[i] != 0) ++caught;
+            }
+            if (batch.stun_risk[i] != 0) {
+                ++stun_flags;
+                if (scratch) ++confirmed;
+            }
+            if (batch.stun_risk[i] != 0 || batch.roll_risk[i] != 0) ++flagged;
+        }
+    }
+    report.stun_recall = report.straight_scratches ? static_cast<double>(caught) / report.straight_scratches : 1;
+    report.stun_precision = stun_flags ? static_cast<double>(confirmed) / stun_flags : 1;
+    report.flag_rate = static_cast<double>(flagged) / report.shots;
+
+    // Both sides start from the shots, as in the planner: the prefilter
+    // fills its batch, the rollout gathers the balls left on the table
+    double timed_shots = static_cast<double>(repeats) * report.shots;
+    volatile double sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (size_t l = 0; l < tables.size(); ++l) {
+            ScratchBatch batch;
+            for (const auto& c : contacts[l]) addScratchShot(batch, c);
+            flagScratchRisk(batch, tables[l].pockets, bound_radius / 2);
+            sink = sink + batch.stun_risk[0];
+        }
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (size_t l = 0; l < tables.size(); ++l) {
+            const auto& balls = layouts[l]->childballs;
+            for (size_t i = 0; i < contacts[l].size(); ++i) {
+                const auto& target = shots[l][i].target_coords;
+                std::vector<std::vector<double>> others;
+                others.reserve(balls.size());
+                for (const auto& b : balls) {
+                    if (b[0] != target[0] || b[1] != target[1]) others.push_back(b);
+                }
+                int bounces;
+                sink = sink + stunScratches(tables[l], contacts[l][i], others, bound_radius, bounces);
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    report.filter_nanos = std::chrono::duration<double, std::nano>(middle - start).count() / timed_shots;
+    report.rollout_nanos = std::chrono::duration<double, std::nano>(end - middle).count() / timed_shots;
+    return report;
+}
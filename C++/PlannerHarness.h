@@ -0,0 +1,348 @@
+// PlannerHarness.h
+// ===========================================================================
+// Offline harness for comparing planner variants over a scenario corpus.
+//
+// The planners are templated on the coordinate type (double, float,
+// FixedPoint). This harness runs each variant over the same set of table
+// layouts and reports:
+// - where its decisions (clear direct shots, clear flip shots, selected
+//   shot) diverge from the double reference
+// - how long a plan takes, and the speedup relative to double
+//
+// It also measures how many obstacles the clearance test's bounding-box
+// prefilter rejects, and compares the ball simulator with and without its
+// sort-and-sweep broadphase, the allocations and speed of pooled
+// simulators, the batch rollout engine against its scalar reference,
+// TableState branching against copying ball lists, the lock-free
+// transposition table against a mutex map, the analytic cue margin of
+// direct shots against sampling the cue aim, the throw and capture lookup
+// tables against their physics, and the scratch prefilter against rolling
+// the cue ball out.
+//
+// Used by planner_bench.cpp; not part of the robot control loop.
+// ===========================================================================
+
+#ifndef PLANNER_HARNESS_H
+#define PLANNER_HARNESS_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// One table layout, in the same units and format as the CSV inputs.
+// ---------------------------------------------------------------------------
+struct PlannerScenario {
+    std::vector<double> cueball;
+    std::vector<std::vector<double>> childballs;
+    std::vector<std::vector<double>> holes;
+    std::vector<std::vector<double>> walls;
+};
+
+// ---------------------------------------------------------------------------
+// Generates 'count' random layouts on the table spanned by 'holes'.
+// Each layout has a cue ball and 1..max_balls child balls placed uniformly
+// inside the pockets' bounding box without overlapping ('ball_diameter'
+// apart). The same seed always produces the same corpus.
+// ---------------------------------------------------------------------------
+std::vector<PlannerScenario> generateScenarioCorpus(
+    const std::vector<std::vector<double>>& holes,
+    const std::vector<std::vector<double>>& walls,
+    int count,
+    int max_balls,
+    double ball_diameter,
+    unsigned seed
+);
+
+// ---------------------------------------------------------------------------
+// Result for one coordinate type:
+// - direct_diverged / flip_diverged: scenarios whose set of clear direct
+//   (child, hole) or flip (wall, target) pairs differs from double
+// - best_diverged: scenarios where a different shot would be selected
+// - diverged_scenarios: corpus indices with any divergence
+// - micros_per_plan: selectClearShots + evaluateFlipShots per layout
+// - speedup: double time divided by this variant's time
+// ---------------------------------------------------------------------------
+struct PrecisionReport {
+    std::string scalar_name;
+    int scenarios;
+    int direct_diverged;
+    int flip_diverged;
+    int best_diverged;
+    std::vector<int> diverged_scenarios;
+    double micros_per_plan;
+    double speedup;
+};
+
+// ---------------------------------------------------------------------------
+// Runs the double, float and FixedPoint planners over 'corpus' and returns
+// one report per variant (double first, as the reference). Each layout is
+// planned 'repeats' times for timing.
+// ---------------------------------------------------------------------------
+std::vector<PrecisionReport> comparePlannerPrecision(
+    const std::vector<PlannerScenario>& corpus,
+    double bound_radius,
+    int repeats
+);
+
+// ---------------------------------------------------------------------------
+// Result of running isPathObstructed (double) on every cue->child and
+// child->hole segment of the corpus, with ClearanceStats collected:
+// - segments / blocked: segments tested and how many were obstructed
+// - obstacles_tested / box_rejected: the ClearanceStats totals
+// - box_reject_rate: box_rejected / obstacles_tested, the share of
+//   obstacles that never reach the exact capsule test
+// - nanos_per_segment: time per isPathObstructed call
+// ---------------------------------------------------------------------------
+struct ClearanceReport {
+    long long segments;
+    long long blocked;
+    long long obstacles_tested;
+    long long box_rejected;
+    double box_reject_rate;
+    double nanos_per_segment;
+};
+
+ClearanceReport compareClearance(
+    const std::vector<PlannerScenario>& corpus,
+    double bound_radius,
+    int repeats
+);
+
+// ---------------------------------------------------------------------------
+// Result of simulating one strike per layout with BallSimulator, testing
+// every pair after each event vs the SweepAndPrune broadphase:
+// - mismatches: layouts whose final ball states differ (must be 0)
+// - events: events per rollout
+// - naive_pair_tests / broadphase_pair_tests: exact collision time tests
+//   per rollout
+// - naive_micros / broadphase_micros: time per rollout
+// The cue ball is sent at the first child ball to roll 'strike_roll' mm.
+// ---------------------------------------------------------------------------
+struct BroadphaseReport {
+    int rollouts;
+    int mismatches;
+    double events;
+    double naive_pair_tests;
+    double broadphase_pair_tests;
+    double naive_micros;
+    double broadphase_micros;
+};
+
+BroadphaseReport compareBroadphase(
+    const std::vector<PlannerScenario>& corpus,
+    double bound_radius,
+    double pocket_mouth,
+    double strike_roll,
+    int repeats
+);
+
+// ---------------------------------------------------------------------------
+// Result of the same strikes as compareBroadphase played on a new
+// BallSimulator per rollout vs one pooled simulator per layout, reset and
+// reused on every repeat:
+// - fresh_allocations / pooled_allocations: heap allocations per rollout
+//   (pooled must be 0)
+// - stale_events: superseded event queue entries dropped per rollout
+// - fresh_micros / pooled_micros: time per rollout
+// 'allocation_count' returns the process's allocation count so far (the
+// caller counts them, e.g. in a replaced operator new).
+// ---------------------------------------------------------------------------
+struct SimulatorPoolReport {
+    int rollouts;
+    double fresh_allocations;
+    double pooled_allocations;
+    double stale_events;
+    double fresh_micros;
+    double pooled_micros;
+};
+
+SimulatorPoolReport measureSimulatorPool(
+    const std::vector<PlannerScenario>& corpus,
+    double bound_radius,
+    double pocket_mouth,
+    double strike_roll,
+    int repeats,
+    size_t (*allocation_count)()
+);
+
+// ---------------------------------------------------------------------------
+// Result of rolling out perturbed variants of one shot per layout with
+// BatchRollout, batched vs the scalar reference:
+// - rollouts: variants rolled out per pass over the corpus
+// - mismatches: variants whose outcomes differ (must be 0)
+// - contacts: variants whose cue ball hit a ball
+// - scalar_per_second / batch_per_second: rollouts per second (one core)
+// The shot aims the cue ball at the first child ball; the variants spread
+// the aim over every cut from full to thin on both sides and the roll over
+// [min_roll, max_roll].
+// ---------------------------------------------------------------------------
+struct BatchRolloutReport {
+    int rollouts;
+    int mismatches;
+    int contacts;
+    double scalar_per_second;
+    double batch_per_second;
+};
+
+BatchRolloutReport compareBatchRollout(
+    const std::vector<PlannerScenario>& corpus,
+    double bound_radius,
+    double pocket_mouth,
+    int variants_per_layout,
+    double min_roll,
+    double max_roll,
+    int repeats
+);
+
+// ---------------------------------------------------------------------------
+// Cost of one search branch per child ball of every layout (at most
+// TABLE_STATE_BALLS children): pot the ball, move the cue ball to its
+// spot, then undo.
+// - branches: branches per pass over the corpus
+// - state_bytes: sizeof(TableState)
+// - hash_mismatches: branches whose TableState hash differs from the
+//   ball-list hash of the same layout (must be 0)
+// - list_nanos: copying the cue and child ball vectors and editing them
+// - state_nanos: TableStateStack branch, edit and rollback
+// ---------------------------------------------------------------------------
+struct TableStateReport {
+    int branches;
+    int state_bytes;
+    int hash_mismatches;
+    double list_nanos;
+    double state_nanos;
+};
+
+TableStateReport measureTableStateBranching(
+    const std::vector<PlannerScenario>& corpus,
+    double tolerance,
+    int repeats
+);
+
+// ---------------------------------------------------------------------------
+// Result of hammering a TranspositionTable and a mutex-protected
+// std::unordered_map with the same random probes (3 in 4) and stores from
+// 'threads' threads at once. Keys are hashTableState of every layout with
+// at most TABLE_STATE_BALLS children and of each of its pot-one-ball
+// branches; the entry stored for a key is a function of the key.
+// - keys: distinct states hashed
+// - table_bytes: memory of the transposition table
+// - lock_free_hit_rate / map_hit_rate: probes that found their key
+// - wrong_entries: hits whose entry is not the one stored for the key
+//   (must be 0: torn slots must read as misses)
+// - lock_free_ops_per_second / mutex_ops_per_second: total throughput
+// ---------------------------------------------------------------------------
+struct TranspositionReport {
+    int threads;
+    size_t operations;
+    size_t keys;
+    size_t table_bytes;
+    double lock_free_hit_rate;
+    double map_hit_rate;
+    size_t wrong_entries;
+    double lock_free_ops_per_second;
+    double mutex_ops_per_second;
+};
+
+TranspositionReport compareTranspositionTables(
+    const std::vector<PlannerScenario>& corpus,
+    double tolerance,
+    int threads,
+    size_t operations_per_thread,
+    size_t memory_bytes
+);
+
+// ---------------------------------------------------------------------------
+// Result of scoring the direct shots planShots ranks for each layout (up to
+// 'max_shots') by their analytic cue margin (solveGhostBalls) vs sampling:
+// the sampled margin is the smallest cue aim error, on a grid growing 1/64
+// per step on both sides of the aim, that misses the target or sends it
+// further off its pocket direction than the shot's aim_margin.
+// - shots: direct shots scored (cuts under 90 degrees)
+// - mean_relative_error: mean |analytic - sampled| / sampled
+// - margin_pair_agreement / distance_pair_agreement: pairs of shots of one
+//   layout that the analytic margin (larger first) or total_distance
+//   (shorter first) order the same way as the sampled margin
+// - analytic_nanos / sampled_nanos: time per shot
+// ---------------------------------------------------------------------------
+struct AimMarginReport {
+    int shots;
+    double mean_relative_error;
+    double margin_pair_agreement;
+    double distance_pair_agreement;
+    double analytic_nanos;
+    double sampled_nanos;
+};
+
+AimMarginReport compareAimMargins(
+    const std::vector<PlannerScenario>& corpus,
+    double bound_radius,
+    double pocket_mouth,
+    size_t max_shots,
+    int repeats
+);
+
+// ---------------------------------------------------------------------------
+// Result of generating outcome tables (default options) at 'path' and
+// comparing their lookups with the models at 'samples' random points:
+// - generate_seconds: time to generate the file (all cores)
+// - throw_max_error / throw_mean_error: |throwAngle - collisionThrow|
+//   (radians) over cuts up to 90 degrees and speeds up to the grid's
+// - capture_agreement: share of entries (angle and offset over the grid,
+//   either side) where captureChance >= 0.5 matches simulateCapture
+// - table_nanos / model_nanos: one throw plus one capture answer
+// ---------------------------------------------------------------------------
+struct OutcomeTableReport {
+    double generate_seconds;
+    double throw_max_error;
+    double throw_mean_error;
+    double capture_agreement;
+    double table_nanos;
+    double model_nanos;
+};
+
+OutcomeTableReport compareOutcomeTables(
+    const std::string& path,
+    double ball_diameter,
+    double mouth_width,
+    int samples,
+    unsigned seed
+);
+
+// ---------------------------------------------------------------------------
+// Result of running the scratch prefilter (ScratchFilter) over the shots
+// ShotSearch finds in each layout (all tiers, up to max_shots), against
+// rolling the stun path out on the table with rollOnTable, the model
+// validation uses:
+// - shots: shots with a cue ball contact (cuts under 90 degrees)
+// - rollout_scratches: shots whose stun rollout pockets the cue ball,
+//   ignoring other balls as the prefilter does
+// - straight_scratches: those pocketed before any cushion, the ones a
+//   straight path can catch
+// - stun_recall: share of straight scratches the stun path flags
+// - stun_precision: share of stun flags the rollout confirms
+// - flag_rate: share of shots flagged by the stun or the roll path
+// - filter_nanos / rollout_nanos: time per shot; the rollout is timed as
+//   validation runs it, with the other balls as obstacles
+// ---------------------------------------------------------------------------
+struct ScratchFilterReport {
+    int shots;
+    int rollout_scratches;
+    int straight_scratches;
+    double stun_recall;
+    double stun_precision;
+    double flag_rate;
+    double filter_nanos;
+    double rollout_nanos;
+};
+
+ScratchFilterReport compareScratchPrefilter(
+    const std::vector<PlannerScenario>& corpus,
+    double bound_radius,
+    double pocket_mouth,
+    size_t max_shots,
+    int repeats
+);
+
+#endif // PLANNER_HARNESS_H
@@ -0,0 +1,195 @@
+// PocketModel.cpp
+// ===========================================================================
+// Implements the pocket jaw model and the acceptance-window test.
+// ===========================================================================
+
+#include "PocketModel.h"
+#include "GeometryUtils.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+static const double kPi = 3.14159265358979323846;
+
+std::vector<Pocket> buildPockets(
+    const std::vector<std::vector<double>>& holes,
+    double mouth_width
+) {
+    std::vector<Pocket> pockets;
+    if (holes.empty()) return pockets;
+
+    double centre_x = 0, centre_y = 0;
+    for (const auto& hole : holes) {
+        centre_x += hole[0];
+        centre_y += hole[1];
+    }
+    centre_x /= holes.size();
+    centre_y /= holes.size();
+
+    for (const auto& hole : holes) {
+        double fx = centre_x - hole[0];
+        double fy = centre_y - hole[1];
+        double norm = mag(fx, fy);
+        if (norm > 0) {
+            fx /= norm;
+            fy /= norm;
+        }
+        // Mouth runs perpendicular to the facing direction
+        double half = mouth_width / 2;
+        Pocket p;
+        p.center = hole;
+        p.facing = {fx, fy};
+        p.jaw_a = {hole[0] - fy * half, hole[1] + fx * half};
+        p.jaw_b = {hole[0] + fy * half, hole[1] - fx * half};
+        pockets.push_back(p);
+    }
+    return pockets;
+}
+
+bool pocketAcceptance(
+    const Pocket& p,
+    double x, double y,
+    double bound_radius,
+    double& lo, double& hi
+) {
+    double hx = p.center[0] - x;
+    double hy = p.center[1] - y;
+    // The ball must come from the table side of the mouth
+    if (INNER_PRODUCT(-hx, -hy, p.facing[0], p.facing[1]) <= 0) return false;
+
+    // Jaw directions relative to the hole direction, narrowed so the ball
+    // centre passes at least one ball radius inside each jaw
+    const double jaw_clearance = bound_radius / 2;
+    double hole_dir = std::atan2(hy, hx);
+    double ax = p.jaw_a[0] - x, ay = p.jaw_a[1] - y;
+    double bx = p.jaw_b[0] - x, by = p.jaw_b[1] - y;
+    double a_off = std::remainder(std::atan2(ay, ax) - hole_dir, 2 * kPi);
+    double b_off = std::remainder(std::atan2(by, bx) - hole_dir, 2 * kPi);
+    double a_shrink = std::asin(std::min(1.0, jaw_clearance / mag(ax, ay)));
+    double b_shrink = std::asin(std::min(1.0, jaw_clearance / mag(bx, by)));
+    if (a_off < b_off) {
+        lo = a_off + a_shrink;
+        hi = b_off - b_shrink;
+    } else {
+        lo = b_off + b_shrink;
+        hi = a_off - a_shrink;
+    }
+    return lo < hi;
+}
+
+// ---------------------------------------------------------------------------
+// Occlusion cone of one ball seen from the child, as unit vectors: the
+// direction to the ball and the two edges of the cone, plus cos of its
+// half-angle. No angles, so the per-pocket pass below needs no trig.
+// ---------------------------------------------------------------------------
+struct Occluder {
+    double ux, uy;
+    double lo_x, lo_y;  // edge turned clockwise from u
+    double hi_x, hi_y;  // edge turned counter-clockwise from u
+    double cos_half;
+    double distance;
+};
+
+// ---------------------------------------------------------------------------
+// Windows are tested in the frame of the direction h from the child to the
+// pocket centre: a unit vector v there is (c, s) = (v . h, h x v), with s
+// > 0 to the left. Every edge that limits the window lies within half a
+// turn of h on its own side, where a larger c means a smaller angle to h,
+// so the nearest edges on each side are found by comparing c alone and
+// only the narrower side needs an atan2 for the margin.
+// ---------------------------------------------------------------------------
+void evaluatePocketWindows(
+    size_t child,
+    const std::vector<std::vector<double>>& balls,
+    const std::vector<Pocket>& pockets,
+    double bound_radius,
+    std::vector<PocketWindow>& windows
+) {
+    const double cx = balls[child][0];
+    const double cy = balls[child][1];
+
+    // Step 1: occlusion cones of all other balls, computed once per child
+    std::vector<Occluder> occluders;
+    occluders.reserve(balls.size());
+    for (size_t j = 0; j < balls.size(); ++j) {
+        if (j == child) continue;
+        double dx = balls[j][0] - cx;
+        double dy = balls[j][1] - cy;
+        double d = mag(dx, dy);
+        if (d < 1e-9) continue;
+        double ux = dx / d;
+        double uy = dy / d;
+        double sin_half = std::min(1.0, bound_radius / d);
+        double cos_half = std::sqrt(1 - sin_half * sin_half);
+        occluders.push_back({ux, uy,
+                             ux * cos_half + uy * sin_half, uy * cos_half - ux * sin_half,
+                             ux * cos_half - uy * sin_half, uy * cos_half + ux * sin_half,
+                             cos_half, d});
+    }
+
+    // Step 2: per pocket, the jaw window around the centre line narrowed by
+    // every cone closer than the pocket
+    const double jaw_clearance = bound_radius / 2;
+    windows.assign(pockets.size(), PocketWindow{false, 0});
+    for (size_t h = 0; h < pockets.size(); ++h) {
+        const Pocket& p = pockets[h];
+        double hx = p.center[0] - cx;
+        double hy = p.center[1] - cy;
+        // The ball must come from the table side of the mouth
+        if (INNER_PRODUCT(-hx, -hy, p.facing[0], p.facing[1]) <= 0) continue;
+        double hole_dist = mag(hx, hy);
+        hx /= hole_dist;
+        hy /= hole_dist;
+
+        // Jaws: the centre lies between them, so one is on each side. Each
+        // is turned inwards until the ball clears it by its radius.
+        double ax = p.jaw_a[0] - cx, ay = p.jaw_a[1] - cy;
+        double bx = p.jaw_b[0] - cx, by = p.jaw_b[1] - cy;
+        double a_len = mag(ax, ay);
+        double b_len = mag(bx, by);
+        if (a_len < 1e-9 || b_len < 1e-9) continue;
+        double a_c = (ax * hx + ay * hy) / a_len, a_s = (hx * ay - hy * ax) / a_len;
+        double b_c = (bx * hx + by * hy) / b_len, b_s = (hx * by - hy * bx) / b_len;
+        double a_sin = std::min(1.0, jaw_clearance / a_len);
+        double b_sin = std::min(1.0, jaw_clearance / b_len);
+        double a_cos = std::sqrt(1 - a_sin * a_sin);
+        double b_cos = std::sqrt(1 - b_sin * b_sin);
+        if (a_s > b_s) {
+            std::swap(a_c, b_c);
+            std::swap(a_s, b_s);
+            std::swap(a_sin, b_sin);
+            std::swap(a_cos, b_cos);
+        }
+        // Right edge (s < 0) turned left, left edge turned right
+        double right_c = a_c * a_cos - a_s * a_sin, right_s = a_c * a_sin + a_s * a_cos;
+        double left_c = b_c * b_cos + b_s * b_sin, left_s = b_s * b_cos - b_c * b_sin;
+        if (right_s >= 0 || left_s <= 0) continue;
+
+        bool clear = true;
+        for (const auto& occ : occluders) {
+            if (occ.distance >= hole_dist) continue;
+            double u_c = occ.ux * hx + occ.uy * hy;
+            // The cone covers the centre line
+            if (u_c >= occ.cos_half) {
+                clear = false;
+                break;
+            }
+            double lo_c = occ.lo_x * hx + occ.lo_y * hy, lo_s = hx * occ.lo_y - hy * occ.lo_x;
+            double hi_c = occ.hi_x * hx + occ.hi_y * hy, hi_s = hx * occ.hi_y - hy * occ.hi_x;
+            // Each edge limits the side it lies on: the near edge of a cone
+            // on the left limits the left side, and its far edge the right
+            // side too if the cone wraps round behind the child
+            if (hx * occ.uy - hy * occ.ux >= 0) {
+                if (lo_c > left_c) { left_c = lo_c; left_s = lo_s; }
+                if (hi_s < 0 && hi_c > right_c) { right_c = hi_c; right_s = hi_s; }
+            } else {
+                if (hi_c > right_c) { right_c = hi_c; right_s = hi_s; }
+                if (lo_s > 0 && lo_c > left_c) { left_c = lo_c; left_s = lo_s; }
+            }
+        }
+        if (!clear) continue;
+
+        windows[h].reachable = true;
+        windows[h].margin = left_c > right_c ? std::atan2(left_s, left_c) : std::atan2(-right_s, right_c);
+    }
+}
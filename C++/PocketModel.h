@@ -0,0 +1,99 @@
+// PocketModel.h
+// ===========================================================================
+// Models each pocket as a mouth between two jaws instead of a single point,
+// and tests child->pocket feasibility as an angular interval problem.
+//
+// Seen from a child ball, a pocket accepts the directions between its two
+// jaws, narrowed so the ball clears each jaw by its radius (the acceptance
+// window). Every other ball between the child and the pocket blocks a cone
+// of directions (the occlusion intervals). The shot is aimed at the pocket
+// centre, as every planner sends it: it is feasible if that direction is
+// inside the acceptance window and outside every cone, and the angle from
+// it to the nearest window edge or cone is the angular margin of the shot.
+//
+// Key parts:
+// - buildPockets: derives jaw points from holes.csv positions
+// - pocketAcceptance: jaw window for a ball at any position
+// - evaluatePocketWindows: tests one child against all pockets in one pass,
+//   computing the occlusion cones only once (as vectors, so the pass over
+//   the pockets needs no trig)
+// ===========================================================================
+
+#ifndef POCKET_MODEL_H
+#define POCKET_MODEL_H
+
+#include <cstddef>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// One pocket:
+// - center: pocket position as read from holes.csv
+// - jaw_a / jaw_b: the two ends of the pocket mouth
+// - facing: unit vector from the pocket towards the table centre; balls must
+//   approach from this side
+// ---------------------------------------------------------------------------
+struct Pocket {
+    std::vector<double> center;
+    std::vector<double> jaw_a;
+    std::vector<double> jaw_b;
+    std::vector<double> facing;
+};
+
+// ---------------------------------------------------------------------------
+// Builds the pocket model from the hole positions.
+// The table centre is taken as the centroid of the holes; each mouth is a
+// segment of 'mouth_width' centred on the hole and perpendicular to the
+// direction from the hole to the table centre (diagonal for corner pockets,
+// straight across for side pockets).
+// ---------------------------------------------------------------------------
+std::vector<Pocket> buildPockets(
+    const std::vector<std::vector<double>>& holes,
+    double mouth_width
+);
+
+// ---------------------------------------------------------------------------
+// Result for one (child, pocket) pair:
+// - reachable: the child sent at the pocket centre enters the mouth without
+//   touching a jaw or another ball
+// - margin: how far (radians) its direction may turn from the pocket
+//   centre, to either side, and still do so
+// ---------------------------------------------------------------------------
+struct PocketWindow {
+    bool reachable;
+    double margin;
+};
+
+// ---------------------------------------------------------------------------
+// Acceptance window of pocket 'p' for a ball centred at (x, y), ignoring
+// other balls: the directions between the jaws, narrowed so the ball clears
+// each jaw by half of 'bound_radius'. 'lo' and 'hi' are angles in radians
+// relative to the direction from (x, y) to the pocket centre.
+//
+// Returns false if the ball is behind the mouth or the window is empty.
+// ---------------------------------------------------------------------------
+bool pocketAcceptance(
+    const Pocket& p,
+    double x, double y,
+    double bound_radius,
+    double& lo, double& hi
+);
+
+// ---------------------------------------------------------------------------
+// Tests child ball balls[child] against every pocket at once.
+//
+// - balls: all child balls (occluders); the child itself is skipped
+// - bound_radius: clearance margin between ball centres (ball diameter),
+//   used for the occlusion cones; half of it is the jaw clearance
+//
+// Only balls closer to the child than the pocket centre occlude it. The
+// output has one entry per pocket, in the same order as 'pockets'.
+// ---------------------------------------------------------------------------
+void evaluatePocketWindows(
+    size_t child,
+    const std::vector<std::vector<double>>& balls,
+    const std::vector<Pocket>& pockets,
+    double bound_radius,
+    std::vector<PocketWindow>& windows
+);
+
+#endif // POCKET_MODEL_H
@@ -0,0 +1,185 @@
+// RunOutPlanner.cpp
+// ===========================================================================
+// Implements the subset DP for run-out order.
+// ===========================================================================
+
+#include "RunOutPlanner.h"
+#include "BallMask.h"
+#include "GeometryUtils.h"
+#include "ShotCandidate.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+// Packed DP choice: target ball in the low nibble, pocket in the high one
+static const uint8_t kNoChoice = 0xFF;
+
+// Subsets handed to one pool task at a time
+static const size_t kSubsetsPerTask = 256;
+
+// ---------------------------------------------------------------------------
+// One playable pot for a fixed (from, target): its cost, pocket and the
+// balls that must be gone for the target->pocket corridor to be open.
+// ---------------------------------------------------------------------------
+struct PotOption {
+    float cost;
+    uint8_t pocket;
+    BallMask pocket_blockers;
+};
+
+bool planRunOut(
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& balls,
+    const std::vector<Pocket>& pockets,
+    double bound_radius,
+    ThreadPool& pool,
+    ThreadPool::Clock::time_point deadline,
+    RunOutPlan& plan
+) {
+    plan.complete = false;
+    plan.difficulty = std::numeric_limits<double>::infinity();
+    plan.steps.clear();
+    plan.states = 0;
+
+    const size_t n = balls.size();
+    if (n > MAX_RUN_OUT_BALLS || pockets.size() > 15) return false;
+    if (n == 0) {
+        plan.complete = true;
+        plan.difficulty = 0;
+        return true;
+    }
+
+    // Shot sources: balls 0..n-1 (cue ball resting on a potted ball's spot)
+    // and the cue ball's real position as source n
+    const size_t sources = n + 1;
+    auto sourcePos = [&](size_t from) -> const std::vector<double>& {
+        return from == n ? cueball_pos : balls[from];
+    };
+
+    // Step 1: corridor masks and sorted pot options per (from, target)
+    std::vector<BallMask> cue_blockers(sources * n, 0);
+    // Options of pair (from, j) are pots[pot_begin[p], pot_begin[p + 1])
+    // with p = from * n + j
+    std::vector<PotOption> pots;
+    std::vector<uint32_t> pot_begin(sources * n + 1, 0);
+    std::vector<BallMask> pocket_blockers(n * pockets.size());
+    std::vector<double> pocket_margin(n * pockets.size(), 0);
+    for (size_t j = 0; j < n; ++j) {
+        for (size_t h = 0; h < pockets.size(); ++h) {
+            const auto& hole = pockets[h].center;
+            pocket_blockers[j * pockets.size() + h] =
+                segmentBlockers(balls[j][0], balls[j][1], hole[0], hole[1], balls, bound_radius) & ~ballBit(j);
+            double lo, hi;
+            if (pocketAcceptance(pockets[h], balls[j][0], balls[j][1], bound_radius, lo, hi) && lo < 0 && hi > 0) {
+                pocket_margin[j * pockets.size() + h] = std::min(-lo, hi);
+            }
+        }
+    }
+    for (size_t from = 0; from < sources; ++from) {
+        const auto& start = sourcePos(from);
+        for (size_t j = 0; j < n; ++j) {
+            pot_begin[from * n + j] = static_cast<uint32_t>(pots.size());
+            if (j == from) continue;
+            const auto& target = balls[j];
+            BallMask others = ~ballBit(j);
+            if (from < n) others &= ~ballBit(from);
+            cue_blockers[from * n + j] =
+                segmentBlockers(start[0], start[1], target[0], target[1], balls, bound_radius) & others;
+
+            double cue_leg = mag(target[0] - start[0], target[1] - start[1]);
+            size_t first = pots.size();
+            for (size_t h = 0; h < pockets.size(); ++h) {
+                double margin = pocket_margin[j * pockets.size() + h];
+                if (margin <= 0) continue;
+                const auto& hole = pockets[h].center;
+                if (!angleBelow(target[0] - start[0], target[1] - start[1],
+                                hole[0] - target[0], hole[1] - target[1], CUT_ANGLE_COS_LIMIT)) continue;
+                double length = cue_leg + mag(hole[0] - target[0], hole[1] - target[1]);
+                BallMask blockers = pocket_blockers[j * pockets.size() + h];
+                if (from < n) blockers &= ~ballBit(from);
+                pots.push_back({static_cast<float>(shotDifficulty(length, margin)), static_cast<uint8_t>(h), blockers});
+            }
+            std::sort(pots.begin() + first, pots.end(),
+                [](const PotOption& a, const PotOption& b) { return a.cost < b.cost; });
+        }
+    }
+
+    pot_begin[sources * n] = static_cast<uint32_t>(pots.size());
+
+    // Step 2: DP tables, state (S, from) at S * sources + from
+    const size_t subsets = size_t(1) << n;
+    const BallMask full = subsets - 1;
+    const float infinite = std::numeric_limits<float>::infinity();
+    std::vector<float> cost(subsets * sources, infinite);
+    std::vector<uint8_t> choice(subsets * sources, kNoChoice);
+    for (size_t from = 0; from < sources; ++from) cost[from] = 0;
+
+    std::vector<std::vector<uint32_t>> layers(n + 1);
+    for (size_t s = 1; s < subsets; ++s) layers[countBalls(s)].push_back(static_cast<uint32_t>(s));
+
+    // Balls still on the table are S; the cue ball rests on 'from', which
+    // is potted (or is the real cue position for the full table)
+    auto solveState = [&](BallMask S, size_t from) {
+        float best = infinite;
+        uint8_t best_choice = kNoChoice;
+        for (BallMask rest = S; rest; rest &= rest - 1) {
+            size_t j = lowestBall(rest);
+            if (cue_blockers[from * n + j] & S) continue;
+            size_t pair = from * n + j;
+            for (size_t o = pot_begin[pair]; o < pot_begin[pair + 1]; ++o) {
+                const PotOption& pot = pots[o];
+                if (pot.pocket_blockers & S) continue;
+                // Options are sorted, so the first open one is the cheapest
+                float total = pot.cost + cost[(S ^ ballBit(j)) * sources + j];
+                if (total < best) {
+                    best = total;
+                    best_choice = static_cast<uint8_t>(j | (pot.pocket << 4));
+                }
+                break;
+            }
+        }
+        cost[S * sources + from] = best;
+        choice[S * sources + from] = best_choice;
+    };
+
+    for (size_t k = 1; k < n; ++k) {
+        const std::vector<uint32_t>& layer = layers[k];
+        size_t tasks = (layer.size() + kSubsetsPerTask - 1) / kSubsetsPerTask;
+        size_t done = pool.parallelFor(tasks, [&](size_t t) {
+            size_t end = std::min(layer.size(), (t + 1) * kSubsetsPerTask);
+            for (size_t i = t * kSubsetsPerTask; i < end; ++i) {
+                BallMask S = layer[i];
+                // 'from' is any potted ball
+                for (BallMask potted = full & ~S; potted; potted &= potted - 1) {
+                    solveState(S, lowestBall(potted));
+                }
+            }
+        }, deadline);
+        if (done < tasks) return false;
+        plan.states += layer.size() * (n - k);
+    }
+    if (ThreadPool::Clock::now() >= deadline) return false;
+    solveState(full, n);
+    plan.states += 1;
+    plan.complete = true;
+
+    // Step 3: follow the choices from the full table
+    float total = cost[full * sources + n];
+    if (total == infinite) return false;
+    plan.difficulty = total;
+    BallMask S = full;
+    size_t from = n;
+    while (S) {
+        uint8_t c = choice[S * sources + from];
+        size_t j = c & 0x0F;
+        size_t h = c >> 4;
+        const auto& start = sourcePos(from);
+        const auto& hole = pockets[h].center;
+        double length = mag(balls[j][0] - start[0], balls[j][1] - start[1]) +
+                        mag(hole[0] - balls[j][0], hole[1] - balls[j][1]);
+        plan.steps.push_back({j, h, length, pocket_margin[j * pockets.size() + h]});
+        S ^= ballBit(j);
+        from = j;
+    }
+    return true;
+}
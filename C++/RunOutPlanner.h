@@ -0,0 +1,91 @@
+// RunOutPlanner.h
+// ===========================================================================
+// Plans the order to pot all remaining balls (the run-out) instead of only
+// the shortest next shot.
+//
+// With n balls left there are n! orders, but the cost of finishing only
+// depends on which balls are still on the table and where the cue ball is.
+// A dynamic program over subsets therefore solves it in 2^n * n states:
+//   cost(S, from) = min over j in S of
+//                   shot(from -> j, with the balls of S in the way)
+//                   + cost(S without j, j)
+// where 'from' is the ball potted last. The cue ball is assumed to stop
+// where that ball was (a stop shot leaves it one diameter short, at the
+// ghost position).
+//
+// Shot costs are shotDifficulty of the best direct shot. Whether a shot is
+// open depends on the subset only through which balls are in its way, so
+// the corridor tests are done once per (from, target, pocket) as ball masks
+// (BallMask) and each DP transition is a few AND instructions.
+//
+// Subsets are processed in layers of equal size; all subsets of one layer
+// are independent, so each layer is split across a ThreadPool. Costs are
+// stored as float and choices packed into one byte per state.
+// ===========================================================================
+
+#ifndef RUN_OUT_PLANNER_H
+#define RUN_OUT_PLANNER_H
+
+#include <cstddef>
+#include <vector>
+#include "PocketModel.h"
+#include "ThreadPool.h"
+
+// Largest number of balls the run-out DP accepts (2^15 * 16 states)
+const size_t MAX_RUN_OUT_BALLS = 15;
+
+// ---------------------------------------------------------------------------
+// One shot of the run-out:
+// - ball / pocket: indices into the planRunOut arguments
+// - total_distance: cue ball position -> ball -> pocket centre
+// - aim_margin: jaw window margin towards the pocket centre (radians)
+// ---------------------------------------------------------------------------
+struct RunOutStep {
+    size_t ball;
+    size_t pocket;
+    double total_distance;
+    double aim_margin;
+};
+
+// ---------------------------------------------------------------------------
+// Result of planRunOut:
+// - complete: the DP finished before the deadline
+// - difficulty: sum of shotDifficulty over the steps (infinite if the
+//   balls cannot all be potted with direct shots)
+// - steps: the best order; steps[0] is the shot to play now
+// - states: DP states evaluated
+// ---------------------------------------------------------------------------
+struct RunOutPlan {
+    bool complete;
+    double difficulty;
+    std::vector<RunOutStep> steps;
+    size_t states;
+};
+
+// ---------------------------------------------------------------------------
+// Plans the run-out of 'balls' from the cue ball at 'cueball_pos'.
+//
+// - pockets: pocket model; at most 15 pockets
+// - bound_radius: clearance margin (ball diameter)
+// - pool / deadline: threads for the subset layers, and the time after
+//   which the DP gives up
+//
+// A shot from -> j -> pocket is playable if the cut passes
+// CUT_ANGLE_COS_LIMIT, the ball heads inside the pocket's jaw window, and
+// no ball still on the table lies in either corridor.
+//
+// Returns true if every ball can be potted in some order; 'plan' is then
+// filled. Returns false with plan.complete == false when the deadline hit,
+// or if there are more than MAX_RUN_OUT_BALLS balls.
+// ---------------------------------------------------------------------------
+bool planRunOut(
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& balls,
+    const std::vector<Pocket>& pockets,
+    double bound_radius,
+    ThreadPool& pool,
+    ThreadPool::Clock::time_point deadline,
+    RunOutPlan& plan
+);
+
+#endif // RUN_OUT_PLANNER_H
@@ -0,0 +1,242 @@
+// SafetyPlanner.cpp
+// ===========================================================================
+// Implements safety shot sampling, the stun-shot outcome model and scoring.
+// ===========================================================================
+
+#include "SafetyPlanner.h"
+#include "ShotPlanner.h"
+#include "ShotSearch.h"
+#include "VisibilitySweep.h"
+#include "GeometryUtils.h"
+#include <algorithm>
+#include <cmath>
+
+SafetyOptions defaultSafetyOptions() {
+    SafetyOptions options;
+    options.roll_distances = {300, 600, 900, 1200};
+    options.aims_per_target = 9;
+    options.budget = std::chrono::microseconds(20000);
+    return options;
+}
+
+// ---------------------------------------------------------------------------
+// One sampled shot and its predicted outcome.
+// ---------------------------------------------------------------------------
+struct SafetySample {
+    size_t target;
+    double aim;           // cue direction (radians)
+    double roll_distance;
+    bool simulated;
+    bool legal;
+    bool scored;
+    double contact_x, contact_y;
+    double cue_x, cue_y;
+    double target_x, target_y;
+    double cut_angle;
+    int opponent_pots;
+    double exposure;
+};
+
+// ---------------------------------------------------------------------------
+// Predicts where both balls stop for one sample and sets 'legal'.
+// ---------------------------------------------------------------------------
+static void simulateSample(
+    SafetySample& s,
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& childballs,
+    const TableModel& table,
+    double bound_radius
+) {
+    s.simulated = true;
+    s.legal = false;
+    const double ax = std::cos(s.aim);
+    const double ay = std::sin(s.aim);
+    const auto& target = childballs[s.target];
+
+    // Cue ball travel to contact: one diameter from the target centre
+    double wx = target[0] - cueball_pos[0];
+    double wy = target[1] - cueball_pos[1];
+    double along = ax * wx + ay * wy;
+    double offset = ax * wy - ay * wx;
+    double half_chord_sq = bound_radius * bound_radius - offset * offset;
+    if (half_chord_sq <= 0) return;
+    double travel = along - std::sqrt(half_chord_sq);
+    if (travel <= 0 || travel >= s.roll_distance) return;
+
+    s.contact_x = cueball_pos[0] + travel * ax;
+    s.contact_y = cueball_pos[1] + travel * ay;
+    double ux = (target[0] - s.contact_x) / bound_radius;
+    double uy = (target[1] - s.contact_y) / bound_radius;
+    double cos_cut = std::min(1.0, std::max(-1.0, ax * ux + ay * uy));
+    s.cut_angle = std::acos(cos_cut);
+
+    std::vector<std::vector<double>> others;
+    others.reserve(childballs.size());
+    for (size_t i = 0; i < childballs.size(); ++i) {
+        if (i != s.target) others.push_back(childballs[i]);
+    }
+
+    // Stun shot: the remaining roll splits as cos^2 / sin^2 of the cut
+    double remaining = s.roll_distance - travel;
+    int bounces = 0;
+    double target_roll = remaining * cos_cut * cos_cut;
+    if (rollOnTable(table, target[0], target[1], ux, uy, target_roll, others, bound_radius,
+                    s.target_x, s.target_y, bounces) != ROLL_STOPPED) return;
+
+    double tx = ax - cos_cut * ux;
+    double ty = ay - cos_cut * uy;
+    double tangent = mag(tx, ty);
+    s.cue_x = s.contact_x;
+    s.cue_y = s.contact_y;
+    if (tangent > 1e-9) {
+        double cue_roll = remaining * (1 - cos_cut * cos_cut);
+        if (rollOnTable(table, s.contact_x, s.contact_y, tx / tangent, ty / tangent, cue_roll, others,
+                        bound_radius, s.cue_x, s.cue_y, bounces) != ROLL_STOPPED) return;
+    }
+    if (bounces == 0) return;
+
+    // Resting places must not overlap another ball (no second collision)
+    if (mag(s.cue_x - s.target_x, s.cue_y - s.target_y) < bound_radius) return;
+    for (const auto& ball : others) {
+        if (mag(ball[0] - s.cue_x, ball[1] - s.cue_y) < bound_radius) return;
+        if (mag(ball[0] - s.target_x, ball[1] - s.target_y) < bound_radius) return;
+    }
+    s.legal = true;
+}
+
+// ---------------------------------------------------------------------------
+// Scores a legal sample by planning the opponent's shots on the new layout.
+// Left unscored if 'cancel' expires during the plan.
+// ---------------------------------------------------------------------------
+static void scoreSample(
+    SafetySample& s,
+    const std::vector<std::vector<double>>& childballs,
+    const TableModel& table,
+    double bound_radius,
+    const CancellationToken& cancel
+) {
+    std::vector<std::vector<double>> layout = childballs;
+    layout[s.target] = {s.target_x, s.target_y};
+    PlanStats plan_stats;
+    std::vector<ShotCandidate> ranked = planShots({s.cue_x, s.cue_y}, layout, table, bound_radius, 4, plan_stats, &cancel);
+    // A cut-short plan would undercount the opponent's pots
+    if (plan_stats.cancelled) return;
+
+    s.opponent_pots = 0;
+    s.exposure = 0;
+    for (const auto& shot : ranked) {
+        if (shot.aim_margin <= 0) continue;
+        ++s.opponent_pots;
+        s.exposure = std::max(s.exposure, shot.aim_margin / shot.total_distance);
+    }
+    s.scored = true;
+}
+
+// True if scored sample 'a' is a better safety than 'b'
+static bool saferThan(const SafetySample& a, const SafetySample& b) {
+    if (a.opponent_pots != b.opponent_pots) return a.opponent_pots < b.opponent_pots;
+    return a.exposure < b.exposure;
+}
+
+bool planSafetyShot(
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& childballs,
+    const TableModel& table,
+    double bound_radius,
+    const SafetyOptions& options,
+    ThreadPool& pool,
+    SafetyShot& shot,
+    SafetyStats& stats,
+    const CancellationToken* cancel
+) {
+    // The own budget, capped by the caller's token
+    CancellationToken budget(ThreadPool::Clock::now() + options.budget, cancel);
+    ThreadPool::Clock::time_point deadline = budget.deadline();
+    if (cancel) deadline = std::min(deadline, cancel->deadline());
+    stats.samples = 0;
+    stats.simulated = 0;
+    stats.legal = 0;
+    stats.scored = 0;
+    stats.deadline_hit = false;
+
+    std::vector<VisibleTarget> visible = sweepVisibleTargets(cueball_pos, childballs, bound_radius);
+    if (visible.empty() || options.roll_distances.empty()) return false;
+
+    // Step 1: samples in (target, direction, strength) order
+    const int aims = std::max(1, options.aims_per_target);
+    std::vector<SafetySample> samples;
+    samples.reserve(visible.size() * aims * options.roll_distances.size());
+    for (const auto& v : visible) {
+        for (int j = 0; j < aims; ++j) {
+            double aim = v.window_lo + (j + 0.5) / aims * (v.window_hi - v.window_lo);
+            for (double roll : options.roll_distances) {
+                SafetySample s = {};
+                s.target = v.ball;
+                s.aim = aim;
+                s.roll_distance = roll;
+                samples.push_back(s);
+            }
+        }
+    }
+    stats.samples = samples.size();
+
+    // Step 2: predict outcomes (cheap), then score legal ones (a full plan
+    // each); both poll the token per sample, and scoring inside the plan
+    size_t simulated = 0;
+    pool.parallelFor(samples.size(), [&](size_t i) {
+        if (!budget.expired()) simulateSample(samples[i], cueball_pos, childballs, table, bound_radius);
+    }, deadline);
+
+    std::vector<size_t> legal;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        if (samples[i].simulated) ++simulated;
+        if (samples[i].legal) legal.push_back(i);
+    }
+    pool.parallelFor(legal.size(), [&](size_t i) {
+        if (!budget.expired()) scoreSample(samples[legal[i]], childballs, table, bound_radius, budget);
+    }, deadline);
+    size_t scored = 0;
+    for (size_t i : legal) {
+        if (samples[i].scored) ++scored;
+    }
+
+    stats.simulated = simulated;
+    stats.legal = legal.size();
+    stats.scored = scored;
+    stats.deadline_hit = simulated < samples.size() || scored < legal.size();
+
+    // Step 3: best scored sample, else first legal, else a full hit on the
+    // first hittable ball at the largest strength
+    const SafetySample* best = nullptr;
+    for (size_t i : legal) {
+        const SafetySample& s = samples[i];
+        if (!s.scored) continue;
+        if (!best || saferThan(s, *best)) best = &s;
+    }
+    if (!best && !legal.empty()) best = &samples[legal.front()];
+
+    SafetySample fallback = {};
+    if (!best) {
+        const auto& target = childballs[visible.front().ball];
+        double distance = mag(target[0] - cueball_pos[0], target[1] - cueball_pos[1]);
+        fallback.target = visible.front().ball;
+        fallback.roll_distance = *std::max_element(options.roll_distances.begin(), options.roll_distances.end());
+        fallback.contact_x = cueball_pos[0] + (target[0] - cueball_pos[0]) * (distance - bound_radius) / distance;
+        fallback.contact_y = cueball_pos[1] + (target[1] - cueball_pos[1]) * (distance - bound_radius) / distance;
+        fallback.cue_x = fallback.contact_x;
+        fallback.cue_y = fallback.contact_y;
+        fallback.target_x = target[0];
+        fallback.target_y = target[1];
+        best = &fallback;
+    }
+
+    shot.target = best->target;
+    shot.contact = {best->contact_x, best->contact_y};
+    shot.cue_end = {best->cue_x, best->cue_y};
+    shot.target_end = {best->target_x, best->target_y};
+    shot.roll_distance = best->roll_distance;
+    shot.cut_angle = best->cut_angle;
+    shot.opponent_pots = best->scored ? best->opponent_pots : -1;
+    shot.exposure = best->scored ? best->exposure : 0;
+    return true;
+}
@@ -0,0 +1,118 @@
+// SafetyPlanner.h
+// ===========================================================================
+// Fallback for layouts where the shot search finds nothing to pot: picks a
+// legal contact shot that leaves the opponent as little as possible.
+//
+// Candidate shots are sampled per directly hittable ball (VisibilitySweep):
+// several cue directions across the ball's free window, each at several
+// strike strengths. A simple stun-shot model predicts where both balls
+// stop:
+// - the target leaves along the line of centres with cos^2 of the cut of
+//   the remaining roll, the cue ball along the tangent line with sin^2
+// - balls bounce off the cushions of the TableModel (reflected direction)
+// - samples where a ball drops into a pocket mouth or runs into another
+//   ball are dropped, since the model cannot predict them
+// A shot is legal if a ball reaches a cushion after the contact. Each
+// legal sample is scored by running planShots for the opponent on the
+// resulting layout: fewer pots left, then a smaller exposure, is better.
+//
+// Sampling runs on a ThreadPool and stops at the earlier of its own budget
+// and the caller's cancellation token, so a decision is always available
+// within the frame budget: the best scored sample if any finished,
+// otherwise the first legal one.
+// ===========================================================================
+
+#ifndef SAFETY_PLANNER_H
+#define SAFETY_PLANNER_H
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+#include "CancellationToken.h"
+#include "TableModel.h"
+#include "ThreadPool.h"
+
+// ---------------------------------------------------------------------------
+// Sampling settings:
+// - roll_distances: cue ball travel budgets to try (mm the cue ball would
+//   roll without hitting anything; also the strike power)
+// - aims_per_target: cue directions spread across each target's window
+// - budget: time allowed for planSafetyShot (less if the caller's token
+//   expires first)
+// ---------------------------------------------------------------------------
+struct SafetyOptions {
+    std::vector<double> roll_distances;
+    int aims_per_target;
+    std::chrono::microseconds budget;
+};
+
+// ---------------------------------------------------------------------------
+// Defaults used by main.cpp: 4 strengths, 9 directions, 20 ms.
+// ---------------------------------------------------------------------------
+SafetyOptions defaultSafetyOptions();
+
+// ---------------------------------------------------------------------------
+// Chosen safety shot:
+// - target: index of the ball hit first
+// - contact: cue ball centre at contact (the cue ball is sent straight at it)
+// - cue_end / target_end: predicted resting places
+// - roll_distance: strike strength (see SafetyOptions)
+// - cut_angle: radians, 0 = full hit
+// - opponent_pots: opponent shots with a positive aim margin after this
+//   shot (among the first four ranked by planShots); -1 if not scored
+// - exposure: largest aim_margin / total_distance among those shots
+//   (radians per mm, larger is easier for the opponent)
+// ---------------------------------------------------------------------------
+struct SafetyShot {
+    size_t target;
+    std::vector<double> contact;
+    std::vector<double> cue_end;
+    std::vector<double> target_end;
+    double roll_distance;
+    double cut_angle;
+    int opponent_pots;
+    double exposure;
+};
+
+// ---------------------------------------------------------------------------
+// Counters for one call:
+// - samples: sampled (target, direction, strength) triples
+// - simulated / legal: samples whose outcome was predicted, and how many
+//   of those were legal
+// - scored: legal samples scored before the deadline
+// - deadline_hit: the budget or the token stopped sampling or scoring early
+// ---------------------------------------------------------------------------
+struct SafetyStats {
+    size_t samples;
+    size_t simulated;
+    size_t legal;
+    size_t scored;
+    bool deadline_hit;
+};
+
+// ---------------------------------------------------------------------------
+// Plans a safety shot for the cue ball at 'cueball_pos'.
+//
+// - bound_radius: ball diameter (contact distance and clearance margin)
+// - pool: threads used for sampling and scoring
+// - cancel: optional caller token (e.g. the frame budget); polled per
+//   sample and inside each sample's opponent plan, on top of
+//   options.budget
+//
+// If no sample is legal, the full hit on the first hittable ball at the
+// largest strength is returned unscored. Returns false only if the cue ball
+// cannot hit any ball.
+// ---------------------------------------------------------------------------
+bool planSafetyShot(
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& childballs,
+    const TableModel& table,
+    double bound_radius,
+    const SafetyOptions& options,
+    ThreadPool& pool,
+    SafetyShot& shot,
+    SafetyStats& stats,
+    const CancellationToken* cancel = nullptr
+);
+
+#endif // SAFETY_PLANNER_H
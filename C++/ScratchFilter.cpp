@@ -0,0 +1,175 @@
+// ScratchFilter.cpp
+// ===========================================================================
+// Implements the cue ball contact model and the batched scratch prefilter.
+// ===========================================================================
+
+#include "ScratchFilter.h"
+#include "GeometryUtils.h"
+#include <algorithm>
+#include <cmath>
+
+// Share of the normal speed a rolling cue ball keeps after contact
+static const double ROLL_FOLLOW = 5.0 / 7.0;
+
+bool cueContact(
+    const ShotCandidate& shot,
+    const std::vector<double>& cueball_pos,
+    double bound_radius,
+    double speed_margin,
+    CueContact& contact
+) {
+    const auto& target = shot.target_coords;
+
+    // Flip shots reach the target from the wall contact and hit it full
+    double fx = cueball_pos[0];
+    double fy = cueball_pos[1];
+    double cue_path = 0;
+    double ux, uy;
+    if (shot.kind == FLIP_SHOT) {
+        fx = shot.object_aim[0];
+        fy = shot.object_aim[1];
+        cue_path = mag(fx - cueball_pos[0], fy - cueball_pos[1]);
+        ux = target[0] - fx;
+        uy = target[1] - fy;
+    } else {
+        ux = shot.object_aim[0] - target[0];
+        uy = shot.object_aim[1] - target[1];
+    }
+    double u_len = mag(ux, uy);
+    if (u_len < 1e-9) return false;
+    ux /= u_len;
+    uy /= u_len;
+
+    double gx = target[0] - ux * bound_radius;
+    double gy = target[1] - uy * bound_radius;
+    double ix = gx - fx;
+    double iy = gy - fy;
+    double in_len = mag(ix, iy);
+    if (in_len < 1e-9) return false;
+    ix /= in_len;
+    iy /= in_len;
+    double cos_cut = std::min(1.0, ix * ux + iy * uy);
+    if (cos_cut <= 0) return false;
+
+    cue_path += mag(target[0] - fx, target[1] - fy);
+    double target_path = std::max(0.0, shot.total_distance - cue_path);
+
+    contact.x = gx;
+    contact.y = gy;
+    contact.in_x = ix;
+    contact.in_y = iy;
+    contact.line_x = ux;
+    contact.line_y = uy;
+    contact.cos_cut = cos_cut;
+    contact.remaining = speed_margin * target_path / (cos_cut * cos_cut);
+    return true;
+}
+
+void addScratchShot(ScratchBatch& batch, const CueContact& contact) {
+    batch.x.push_back(contact.x);
+    batch.y.push_back(contact.y);
+    batch.stun_x.push_back(contact.in_x - contact.cos_cut * contact.line_x);
+    batch.stun_y.push_back(contact.in_y - contact.cos_cut * contact.line_y);
+    batch.roll_x.push_back(contact.in_x - ROLL_FOLLOW * contact.cos_cut * contact.line_x);
+    batch.roll_y.push_back(contact.in_y - ROLL_FOLLOW * contact.cos_cut * contact.line_y);
+    batch.remaining.push_back(contact.remaining);
+}
+
+// ---------------------------------------------------------------------------
+// 1 in risk[i] if the path from (x[i], y[i]) along (dx[i], dy[i]) crosses
+// the window from (ax, ay) along (ex, ey) heading against 'facing' before
+// it stops; left unchanged otherwise.
+//
+// The path is x + s * d and the window a + t * e. Both parameters are
+// ratios of cross products over den = d x e; flipping all three to make
+// den positive leaves the tests as comparisons without a division, so
+// parallel paths (den = 0) and stun paths of full hits (d = 0) fail them.
+// The path stops at s * |d| = remaining * |d|^2: the stun and roll speeds
+// are |d| times the contact speed, and the roll goes with the square.
+//
+// risk is a double array so the final select is a blend of two double
+// vectors: SSE2 has no way to widen a double compare mask into an integer
+// lane, and with one g++ leaves the loop scalar. With the restrict
+// pointers and the planner flags (.vscode/tasks.json) it vectorizes on
+// the SSE2 baseline without runtime alias checks.
+// ---------------------------------------------------------------------------
+static void flagPath(
+    size_t n,
+    const double* __restrict x, const double* __restrict y,
+    const double* __restrict dx, const double* __restrict dy,
+    const double* __restrict remaining,
+    double ax, double ay,
+    double ex, double ey,
+    double facing_x, double facing_y,
+    double* __restrict risk
+) {
+    for (size_t i = 0; i < n; ++i) {
+        double wx = ax - x[i];
+        double wy = ay - y[i];
+        double den = dx[i] * ey - dy[i] * ex;
+        double s_num = wx * ey - wy * ex;
+        double t_num = wx * dy[i] - wy * dx[i];
+        double sign = den < 0 ? -1.0 : 1.0;
+        den *= sign;
+        s_num *= sign;
+        t_num *= sign;
+        double limit = remaining[i] * std::sqrt(dx[i] * dx[i] + dy[i] * dy[i]);
+        bool hit = (den > 0) & (s_num > 0) & (s_num <= limit * den) &
+                   (t_num >= 0) & (t_num <= den) &
+                   (dx[i] * facing_x + dy[i] * facing_y < 0);
+        risk[i] = hit ? 1.0 : risk[i];
+    }
+}
+
+void flagScratchRisk(ScratchBatch& batch, const std::vector<Pocket>& pockets, double ball_radius) {
+    const size_t n = batch.x.size();
+    batch.stun_risk.assign(n, 0.0);
+    batch.roll_risk.assign(n, 0.0);
+
+    for (const Pocket& p : pockets) {
+        double ex = p.jaw_b[0] - p.jaw_a[0];
+        double ey = p.jaw_b[1] - p.jaw_a[1];
+        double width = mag(ex, ey);
+        // No window left once the ball clears both jaws
+        if (width <= 2 * ball_radius) continue;
+        double ax = p.jaw_a[0] + ex / width * ball_radius;
+        double ay = p.jaw_a[1] + ey / width * ball_radius;
+        ex *= (width - 2 * ball_radius) / width;
+        ey *= (width - 2 * ball_radius) / width;
+
+        flagPath(n, batch.x.data(), batch.y.data(), batch.stun_x.data(), batch.stun_y.data(),
+                 batch.remaining.data(), ax, ay, ex, ey, p.facing[0], p.facing[1], batch.stun_risk.data());
+        flagPath(n, batch.x.data(), batch.y.data(), batch.roll_x.data(), batch.roll_y.data(),
+                 batch.remaining.data(), ax, ay, ex, ey, p.facing[0], p.facing[1], batch.roll_risk.data());
+    }
+}
+
+size_t dropScratchRisks(
+    std::vector<ShotCandidate>& shots,
+    const std::vector<double>& cueball_pos,
+    const std::vector<Pocket>& pockets,
+    double bound_radius,
+    double speed_margin
+) {
+    ScratchBatch batch;
+    std::vector<size_t> index;
+    CueContact contact;
+    for (size_t i = 0; i < shots.size(); ++i) {
+        if (!cueContact(shots[i], cueball_pos, bound_radius, speed_margin, contact)) continue;
+        addScratchShot(batch, contact);
+        index.push_back(i);
+    }
+    flagScratchRisk(batch, pockets, bound_radius / 2);
+
+    std::vector<bool> risky(shots.size(), false);
+    for (size_t k = 0; k < index.size(); ++k) {
+        risky[index[k]] = batch.stun_risk[k] != 0 || batch.roll_risk[k] != 0;
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < shots.size(); ++i) {
+        if (!risky[i]) shots[kept++] = shots[i];
+    }
+    size_t dropped = shots.size() - kept;
+    shots.resize(kept);
+    return dropped;
+}
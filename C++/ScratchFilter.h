@@ -0,0 +1,114 @@
+// ScratchFilter.h
+// ===========================================================================
+// Cheap geometric prefilter for scratches: shots whose cue ball is likely
+// to follow the object ball into a pocket after contact.
+//
+// Rolling a shot out on the table (validateShot in AnytimePlanner) is the
+// expensive part of scoring it. Before that, every candidate's cue ball
+// run after contact is projected as two straight paths from the ghost-ball
+// position:
+// - stun: along the tangent line, in - cos(cut) * line, with sin^2 of the
+//   cut of the remaining roll (the stun-shot model of validateShot)
+// - natural roll: a rolling cue ball bends forward until it rolls along
+//   in - 5/7 cos(cut) * line (2/7 of the normal speed comes back through
+//   the spin), and rolls on with that share of the remaining roll
+// A path is flagged if it crosses a pocket's acceptance window, the mouth
+// between the jaws narrowed by the ball radius on each side (as in
+// pocketAcceptance), moving towards the pocket, before it stops.
+//
+// Other balls and cushion rebounds are ignored, so the filter errs towards
+// flagging. Candidates are stored as structure-of-arrays and the test is
+// a branch-free loop over them per pocket, with the flags stored as
+// doubles so every lane array has the same type; g++ vectorizes it on the
+// SSE2 baseline with the planner flags (-O3 -fno-math-errno
+// -fno-trapping-math, .vscode/tasks.json). At -O2 it runs scalar.
+//
+// Key parts:
+// - cueContact: cue ball state at contact for any shot kind
+// - ScratchBatch / addScratchShot / flagScratchRisk: the batched filter
+// - dropScratchRisks: the filter applied to a list of shots
+// ===========================================================================
+
+#ifndef SCRATCH_FILTER_H
+#define SCRATCH_FILTER_H
+
+#include <cstddef>
+#include <vector>
+#include "PocketModel.h"
+#include "ShotCandidate.h"
+
+// ---------------------------------------------------------------------------
+// Cue ball at contact (stun-shot model):
+// - x, y: cue ball centre (the ghost ball)
+// - in_x/y: unit direction it arrives from
+// - line_x/y: unit line of centres, the target's direction
+// - cos_cut: cosine of the cut angle (> 0)
+// - remaining: roll left in the cue ball, sized so the target's cos^2 share
+//   covers 'speed_margin' times its path
+// ---------------------------------------------------------------------------
+struct CueContact {
+    double x, y;
+    double in_x, in_y;
+    double line_x, line_y;
+    double cos_cut;
+    double remaining;
+};
+
+// ---------------------------------------------------------------------------
+// Contact for 'shot' from 'cueball_pos': the cue ball hits target_coords
+// towards object_aim (flip shots come off the wall contact in object_aim
+// and hit the target full). Returns false for degenerate shots and cuts of
+// 90 degrees or more.
+// ---------------------------------------------------------------------------
+bool cueContact(
+    const ShotCandidate& shot,
+    const std::vector<double>& cueball_pos,
+    double bound_radius,
+    double speed_margin,
+    CueContact& contact
+);
+
+// ---------------------------------------------------------------------------
+// Batch of candidates, one index per shot.
+//
+// Inputs (filled by addScratchShot): ghost x/y, stun and natural-roll path
+// directions (not normalized) and the remaining roll.
+//
+// Results (filled by flagScratchRisk), 1.0 or 0.0 per shot:
+// - stun_risk: the stun path runs into a pocket window
+// - roll_risk: the natural-roll path does
+// ---------------------------------------------------------------------------
+struct ScratchBatch {
+    std::vector<double> x, y;
+    std::vector<double> stun_x, stun_y;
+    std::vector<double> roll_x, roll_y;
+    std::vector<double> remaining;
+
+    std::vector<double> stun_risk;
+    std::vector<double> roll_risk;
+};
+
+// Appends the paths of one contact to the batch
+void addScratchShot(ScratchBatch& batch, const CueContact& contact);
+
+// ---------------------------------------------------------------------------
+// Tests every shot in the batch against every pocket.
+// - ball_radius: jaw clearance on each side of the mouth
+// ---------------------------------------------------------------------------
+void flagScratchRisk(ScratchBatch& batch, const std::vector<Pocket>& pockets, double ball_radius);
+
+// ---------------------------------------------------------------------------
+// Removes from 'shots' every shot whose stun or natural-roll path runs into
+// a pocket (one flagScratchRisk batch; jaw clearance half of
+// 'bound_radius'), keeping the order of the rest. Shots without a cue ball
+// contact are kept. Returns how many were removed.
+// ---------------------------------------------------------------------------
+size_t dropScratchRisks(
+    std::vector<ShotCandidate>& shots,
+    const std::vector<double>& cueball_pos,
+    const std::vector<Pocket>& pockets,
+    double bound_radius,
+    double speed_margin
+);
+
+#endif // SCRATCH_FILTER_H
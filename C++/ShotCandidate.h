@@ -0,0 +1,102 @@
+// ShotCandidate.h
+// ===========================================================================
+// Defines the common record used to rank shots coming out of the planners.
+//
+// The direct-shot planner (ShotPlanner), the wall-bounce planner
+// (FlipPlanner), the bank planner (BankPlanner), the combination planner
+// (CombinationPlanner) and the safety planner (SafetyPlanner) produce
+// candidates in their own formats;
+// the shot search converts them into ShotCandidate so they can be ranked,
+// cached and executed the same way.
+// ===========================================================================
+
+#ifndef SHOT_CANDIDATE_H
+#define SHOT_CANDIDATE_H
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// How the target ball reaches the hole. The values are stored in the plan
+// cache file, so existing entries must keep their numbers.
+// - DIRECT_SHOT: cue ball hits the target straight into the hole
+// - FLIP_SHOT: cue ball banks off a wall onto the target
+// - COMBINATION_SHOT: target is driven into a second ball, which is pocketed
+// - KISS_SHOT: target glances off a second ball into the hole
+// - BANK_SHOT: target banks off a cushion into the hole
+// - SAFETY_SHOT: no pot; legal contact leaving the opponent little
+//   (SafetyPlanner)
+// ---------------------------------------------------------------------------
+enum ShotKind {
+    DIRECT_SHOT = 0,
+    FLIP_SHOT = 1,
+    COMBINATION_SHOT = 2,
+    KISS_SHOT = 3,
+    BANK_SHOT = 4,
+    SAFETY_SHOT = 5
+};
+
+inline const char* shotKindName(ShotKind kind) {
+    switch (kind) {
+        case DIRECT_SHOT: return "direct";
+        case FLIP_SHOT: return "flip";
+        case COMBINATION_SHOT: return "combination";
+        case KISS_SHOT: return "kiss";
+        case BANK_SHOT: return "bank";
+        case SAFETY_SHOT: return "safety";
+    }
+    return "unknown";
+}
+
+// ---------------------------------------------------------------------------
+// Structure representing one executable shot:
+// - target_coords: location of the child ball to strike
+// - hole_coords: hole the pocketed ball is aimed at; for safety shots the
+//   predicted resting place of the target
+// - total_distance: length of the ball paths (cue->target->...->hole, ball
+//   centres), used for ranking and for strike power in executeStrike
+// - kind: planner that produced the shot
+// - aim_margin: angular margin of the leg into the pocket in radians (how
+//   far the pocketed ball's direction may deviate and still enter the
+//   pocket mouth); 0 when the ball is not headed inside the mouth
+// - object_aim: point the target ball must be sent towards; the hole for
+//   direct shots, the contact position against the second ball for
+//   combination and kiss shots, the cushion contact for bank shots. For
+//   flip shots it is the wall contact the cue ball itself is sent to, for
+//   safety shots the cue ball centre at contact.
+// ---------------------------------------------------------------------------
+struct ShotCandidate {
+    std::vector<double> target_coords;
+    std::vector<double> hole_coords;
+    double total_distance;
+    ShotKind kind;
+    double aim_margin;
+    std::vector<double> object_aim;
+};
+
+// ---------------------------------------------------------------------------
+// Difficulty of potting a ball over a path of 'total_distance' with
+// 'aim_margin' radians of tolerance at the pocket: mm of path per radian
+// of margin, so long and tight shots score high. Infinite without margin.
+// ---------------------------------------------------------------------------
+inline double shotDifficulty(double total_distance, double aim_margin) {
+    if (aim_margin <= 0) return std::numeric_limits<double>::infinity();
+    return total_distance / aim_margin;
+}
+
+// Standard deviation of the pocketed ball's direction per mm of shot path
+// (radians); 0.02 rad for a 1 m shot
+const double AIM_ERROR_RAD_PER_MM = 2e-5;
+
+// ---------------------------------------------------------------------------
+// Estimated chance of potting a shot of the given shotDifficulty: the
+// probability that a normal direction error with standard deviation
+// AIM_ERROR_RAD_PER_MM * total_distance stays within the aim margin.
+// ---------------------------------------------------------------------------
+inline double shotSuccessEstimate(double difficulty) {
+    if (!(difficulty < std::numeric_limits<double>::infinity())) return 0;
+    return std::erf(1.0 / (1.4142135623730951 * AIM_ERROR_RAD_PER_MM * difficulty));
+}
+
+#endif // SHOT_CANDIDATE_H
@@ -6,98 +6,138 @@
 
 #include "ShotPlanner.h"
 #include "GeometryUtils.h"
+#include "BallMask.h"
 #include <cmath>
 #include <limits>
 
+template <typename Scalar>
 bool isPathObstructed(
-    double x1, double y1, double x2, double y2,
-    const std::vector<std::vector<double>>& obstacles,
-    double bound_radius
+    Scalar x1, Scalar y1, Scalar x2, Scalar y2,
+    const std::vector<std::vector<Scalar>>& obstacles,
+    typename NonDeduced<Scalar>::type bound_radius,
+    ClearanceStats* stats
 ) {
+    SegmentBox<Scalar> box = segmentBox(x1, y1, x2, y2, bound_radius);
+    bool blocked = false;
+    long long tested = 0;
+    long long rejected = 0;
+
     for (const auto& obs : obstacles) {
-        double obs_x = obs[0];
-        double obs_y = obs[1];       
-        // Calculate perpendicular distance to line (x1,y1)->(x2,y2)
-        double d = dis(x2 - x1, y2 - y1, x1, y1, obs_x, obs_y);
+        Scalar obs_x = obs[0];
+        Scalar obs_y = obs[1];
         if ((obs_x==x2 && obs_y==y2) || (obs_x==x1 && obs_y==y1)) {
-            continue;   
+            continue;
         }
-        // If close enough to line AND within the segment bounds, it's an obstruction
-        if (std::abs(d) < bound_radius) {
-            double mag_target = mag(x2 - x1, y2 - y1);
-            double mag_obs = mag(obs_x - x1, obs_y - y1);
-            if (mag_obs < mag_target) return true;
+        ++tested;
+        // Cheap reject: outside the corridor's bounding box
+        if (outsideBox(box, obs_x, obs_y)) {
+            ++rejected;
+            continue;
         }
+        // Exact test: inside the capsule around the segment
+        if (insideCapsule(x1, y1, x2, y2, obs_x, obs_y, bound_radius)) {
+            blocked = true;
+            break;
+        }
+    }
+
+    if (stats) {
+        stats->obstacles_tested += tested;
+        stats->box_rejected += rejected;
     }
-    return false;
+    return blocked;
 }
 
-std::vector<std::pair<std::vector<double>, std::vector<double>>> selectClearShots(
-    const std::vector<std::vector<double>>& cueballs,
-    const std::vector<std::vector<double>>& holes,
-    const std::vector<std::vector<double>>& childballs,
-    double bound_radius
+template <typename Scalar>
+bool isCutAngleFeasible(
+    const std::vector<Scalar>& cueball_pos,
+    const std::vector<Scalar>& child,
+    const std::vector<Scalar>& hole
 ) {
-    //check if there is an obstacle between childball and holes
-    std::vector<std::pair<std::vector<double>, std::vector<double>>> child_hole_result;
-    //check if there is an obstacle between cueball and childball
-    std::vector<std::pair<std::vector<double>, std::vector<double>>> cue_child_result;
-    std::vector<std::pair<std::vector<double>, std::vector<double>>> result;
-    // For every childball, check all hole paths
-    for (const auto& child : childballs) {
-        for (const auto& hole : holes) {
-            if (!isPathObstructed(child[0], child[1], hole[0], hole[1], childballs, bound_radius)) {
-                child_hole_result.emplace_back(child, hole);  // Add valid shot
-            }
+    //angle is big enough to make collision (angle < 110 deg, compared via cosine)
+    return angleBelow(child[0]-cueball_pos[0], child[1]-cueball_pos[1],
+                      hole[0]-child[0], hole[1]-child[1], CUT_ANGLE_COS_LIMIT);
+}
+
+template <typename Scalar>
+std::vector<std::pair<std::vector<Scalar>, std::vector<Scalar>>> selectClearShots(
+    const std::vector<std::vector<Scalar>>& cueballs,
+    const std::vector<std::vector<Scalar>>& holes,
+    const std::vector<std::vector<Scalar>>& childballs,
+    typename NonDeduced<Scalar>::type bound_radius
+) {
+    std::vector<std::pair<std::vector<Scalar>, std::vector<Scalar>>> result;
+
+    // Children are handled in blocks of 64, one bit per child
+    for (size_t first = 0; first < childballs.size(); first += MAX_MASK_BALLS) {
+        BallBoard board = buildBallBoard(cueballs[0], holes, childballs, first, bound_radius);
+
+        // a shot is valid if the child is hit from the cue ball, its
+        // corridor to the hole is clear and the cut angle is playable
+        std::vector<BallMask> valid(holes.size());
+        BallMask any_valid = 0;
+        for (size_t h = 0; h < holes.size(); ++h) {
+            valid[h] = board.cue_visible & board.hole_reachable[h] & board.cut_feasible[h];
+            any_valid |= valid[h];
+            result.reserve(result.size() + countBalls(valid[h]));
         }
-    }
-     for (const auto& child : childballs) {
-        for (const auto& hole : holes) {
-            if (!isPathObstructed(child[0], child[1], cueballs[0][0], cueballs[0][1], childballs, bound_radius)) {
-                //angle is big enough to make collision
-                double angle2 = std::abs(acos(COS_VAL(child[0]-cueballs[0][0],child[1]-cueballs[0][1],hole[0]-child[0],hole[1]-child[1])) * 180 / 3.1415926);
-                if (angle2 < 110 ){
-                        cue_child_result.emplace_back(cueballs, child);  // Add valid shot
-                    }
+
+        // Emit in child-major order, as the pairwise planner did
+        for (BallMask left = any_valid; left != 0; left &= left - 1) {
+            size_t bit = lowestBall(left);
+            for (size_t h = 0; h < holes.size(); ++h) {
+                if (hasBall(valid[h], bit)) {
+                    result.emplace_back(childballs[first + bit], holes[h]);
+                }
             }
         }
     }
 
-    for (const auto& child_hole : child_hole_result) {
-        const std::vector<double>& child_ball = child_hole.first;   
-        const std::vector<double>& hole_coord = child_hole.second;  
+    return result;
+}
 
-        for (const auto& cue_child : cue_child_result) {
-            const std::vector<double>& cue_ball = cue_child.first;  
+std::vector<std::pair<std::vector<double>, std::vector<double>>> selectClearShots(
+    const std::vector<std::vector<double>>& cueballs,
+    const std::vector<Pocket>& pockets,
+    const std::vector<std::vector<double>>& childballs,
+    double bound_radius
+) {
+    std::vector<std::pair<std::vector<double>, std::vector<double>>> result;
+    std::vector<PocketWindow> windows;
+    const std::vector<double>& cue = cueballs[0];
 
-            // if the child ball coordinates match the cue ball coordinates
-            // (considering floating-point precision)
-            // and the size of child_ball matches the size of cue_ball
-            // then we can assume they are the same ball
-            // This is a simplification, in practice you might want to check more conditions
-            // such as distance or specific properties of the balls.
-            // Here we assume child_ball is a child ball and cue_ball is the cue ball.
-            // If the child ball coordinates match the cue ball coordinates
-            // we can consider it a valid shot. 
-            if (child_ball.size() == cue_ball.size()) {
-                bool is_same = true;
-                for (int i = 0; i < child_ball.size(); ++i) {
-                    if (std::abs(child_ball[i] - cue_ball[i]) > 1e-9) {  // 考慮浮點數精度
-                        is_same = false;
-                        break;
-                    }
-                }
+    for (size_t c = 0; c < childballs.size(); ++c) {
+        const std::vector<double>& child = childballs[c];
+        // check if there is an obstacle between cueball and childball
+        if (isPathObstructed(child[0], child[1], cue[0], cue[1], childballs, bound_radius)) continue;
 
-                // if the child ball matches the child ball coordinates
-                // then we can consider it a valid shot
-                // and add it to the result
-                if (is_same) {
-                    result.emplace_back(child_ball, hole_coord);
-                    break;  
-                }
+        // check every pocket mouth at once against the other balls
+        evaluatePocketWindows(c, childballs, pockets, bound_radius, windows);
+        for (size_t h = 0; h < pockets.size(); ++h) {
+            if (windows[h].reachable && isCutAngleFeasible(cue, child, pockets[h].center)) {
+                result.emplace_back(child, pockets[h].center);  // Add valid shot
             }
         }
     }
-
     return result;
 }
+
+// ---------------------------------------------------------------------------
+// Explicit instantiations for the supported coordinate types.
+// ---------------------------------------------------------------------------
+#define INSTANTIATE_SHOT_PLANNER(Scalar)                                        \
+    template bool isPathObstructed<Scalar>(                                      \
+        Scalar, Scalar, Scalar, Scalar,                                          \
+        const std::vector<std::vector<Scalar>>&, Scalar, ClearanceStats*);       \
+    template bool isCutAngleFeasible<Scalar>(                                    \
+        const std::vector<Scalar>&, const std::vector<Scalar>&,                  \
+        const std::vector<Scalar>&);                                             \
+    template std::vector<std::pair<std::vector<Scalar>, std::vector<Scalar>>>   \
+    selectClearShots<Scalar>(                                                    \
+        const std::vector<std::vector<Scalar>>&,                                 \
+        const std::vector<std::vector<Scalar>>&,                                 \
+        const std::vector<std::vector<Scalar>>&, Scalar);
+
+INSTANTIATE_SHOT_PLANNER(double)
+INSTANTIATE_SHOT_PLANNER(float)
+INSTANTIATE_SHOT_PLANNER(FixedPoint)
@@ -5,29 +5,68 @@
 //
 // Key functions:
 // - isPathObstructed: checks if a straight path is blocked.
+// - isCutAngleFeasible: checks the cue->child->hole cut angle.
 // - selectClearShots: returns all non-blocked child ball-to-hole shots.
+//
+// All functions are templates on the coordinate type (double, float or
+// FixedPoint); the definitions and explicit instantiations live in
+// ShotPlanner.cpp.
 // ===========================================================================
 
 #ifndef SHOT_PLANNER_H
 #define SHOT_PLANNER_H
 
 #include <vector>
+#include "GeometryUtils.h"
+#include "PocketModel.h"
+
+// ---------------------------------------------------------------------------
+// Counters for the clearance test, used to measure how many obstacles the
+// bounding-box prefilter rejects before the exact capsule test:
+// - obstacles_tested: obstacles examined (endpoints excluded)
+// - box_rejected: obstacles rejected by the bounding box alone
+// ---------------------------------------------------------------------------
+struct ClearanceStats {
+    long long obstacles_tested;
+    long long box_rejected;
+};
 
 // ---------------------------------------------------------------------------
 // Checks if a path from point (x1, y1) to (x2, y2) is obstructed by any
 // object in 'obstacles' based on their proximity to the path.
-// 
-// Each obstacle is treated as a circle with radius 'bound_radius'.
-// The function calculates the perpendicular distance from each obstacle to
-// the path and compares it to the radius. Also checks that the obstacle is
-// within the segment length (not beyond the shot).
+//
+// The path is treated as a capsule: every point within 'bound_radius' of
+// the segment (x1, y1)-(x2, y2), including the round caps at both ends.
+// Obstacles outside the segment's inflated bounding box are rejected with
+// plain compares; the rest get the exact point-to-segment distance.
+// Obstacles sitting exactly on an endpoint are the balls being shot at or
+// from and are ignored.
+//
+// Used by both the direct-shot planner and the flip planner.
+// If 'stats' is given, the prefilter counters are accumulated into it.
 //
 // Returns true if any obstacle blocks the path; false otherwise.
 // ---------------------------------------------------------------------------
+template <typename Scalar>
 bool isPathObstructed(
-    double x1, double y1, double x2, double y2,
-    const std::vector<std::vector<double>>& obstacles,
-    double bound_radius
+    Scalar x1, Scalar y1, Scalar x2, Scalar y2,
+    const std::vector<std::vector<Scalar>>& obstacles,
+    typename NonDeduced<Scalar>::type bound_radius,
+    ClearanceStats* stats = nullptr
+);
+
+// ---------------------------------------------------------------------------
+// Checks whether the cue ball can send the child ball towards the hole.
+//
+// The angle between the cue->child vector and the child->hole vector must
+// stay below 110 degrees, otherwise the cut is too thin to pocket the ball.
+// Evaluated with angleBelow() against cos(110 deg), so no acos is needed.
+// ---------------------------------------------------------------------------
+template <typename Scalar>
+bool isCutAngleFeasible(
+    const std::vector<Scalar>& cueball_pos,
+    const std::vector<Scalar>& child,
+    const std::vector<Scalar>& hole
 );
 
 // ---------------------------------------------------------------------------
@@ -36,6 +75,10 @@ bool isPathObstructed(
 // by any other balls.
 //
 // This function is used to build a candidate list of possible direct shots.
+// The clearance and cut-angle results are collected as bitboards (see
+// BallMask.h), so a (child, hole) pair is valid when its bit survives
+//   cue_visible & hole_reachable[hole] & cut_feasible[hole]
+// The cue->child leg is tested once per child rather than once per hole.
 //
 // Arguments:
 // - cueballs: positions of child balls (usually same as obstacles)
@@ -45,9 +88,26 @@ bool isPathObstructed(
 //
 // Returns a list of pairs where each pair = (child ball position, hole position)
 // ---------------------------------------------------------------------------
+template <typename Scalar>
+std::vector<std::pair<std::vector<Scalar>, std::vector<Scalar>>> selectClearShots(
+    const std::vector<std::vector<Scalar>>& cueballs,
+    const std::vector<std::vector<Scalar>>& holes,
+    const std::vector<std::vector<Scalar>>& obstacles,
+    typename NonDeduced<Scalar>::type bound_radius
+);
+
+// ---------------------------------------------------------------------------
+// Same as selectClearShots above, but with pockets modelled by their jaws
+// (see PocketModel.h). Instead of one isPathObstructed call per
+// (child, hole) pair, each child's acceptance windows for all pockets are
+// evaluated at once and tested against the occlusion intervals of the
+// other balls. The cue->child leg is tested once per child.
+//
+// Returns pairs of (child ball position, pocket centre).
+// ---------------------------------------------------------------------------
 std::vector<std::pair<std::vector<double>, std::vector<double>>> selectClearShots(
     const std::vector<std::vector<double>>& cueballs,
-    const std::vector<std::vector<double>>& holes,
+    const std::vector<Pocket>& pockets,
     const std::vector<std::vector<double>>& obstacles,
     double bound_radius
 );
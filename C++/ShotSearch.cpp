@@ -0,0 +1,259 @@
+// ShotSearch.cpp
+// ===========================================================================
+// Implements best-first shot search with distance lower bounds.
+// ===========================================================================
+
+#include "ShotSearch.h"
+#include "ShotPlanner.h"
+#include "FlipPlanner.h"
+#include "CombinationPlanner.h"
+#include "BankPlanner.h"
+#include "BallMask.h"
+#include "GeometryUtils.h"
+#include <algorithm>
+
+// ---------------------------------------------------------------------------
+// Inserts 'shot' into 'ranked' (sorted by total_distance, ties keep insertion
+// order) and trims the list to 'max_shots'.
+// ---------------------------------------------------------------------------
+static void insertRanked(std::vector<ShotCandidate>& ranked, const ShotCandidate& shot, size_t max_shots) {
+    auto pos = std::upper_bound(ranked.begin(), ranked.end(), shot,
+        [](const ShotCandidate& a, const ShotCandidate& b) {
+            return a.total_distance < b.total_distance;
+        });
+    ranked.insert(pos, shot);
+    if (ranked.size() > max_shots) ranked.pop_back();
+}
+
+// ---------------------------------------------------------------------------
+// True once 'bound' can no longer place a shot into a full ranked list.
+// ---------------------------------------------------------------------------
+static bool cannotWin(const std::vector<ShotCandidate>& ranked, double bound, size_t max_shots) {
+    return ranked.size() >= max_shots && bound >= ranked.back().total_distance;
+}
+
+ShotSearch::ShotSearch(
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& childballs,
+    const TableModel& table,
+    double bound_radius
+) : cueball_pos_(cueball_pos), childballs_(childballs), table_(table),
+    bound_radius_(bound_radius),
+    cue_leg_clear_(childballs.size(), -1), pocket_windows_(childballs.size()),
+    stats_{0, 0, 0, false}, exhaustive_tests_(0) {}
+
+// ---------------------------------------------------------------------------
+// One segment test against every child ball, counted in the stats.
+// ---------------------------------------------------------------------------
+bool ShotSearch::segmentBlocked(double x1, double y1, double x2, double y2) {
+    ++stats_.segment_tests;
+    return isPathObstructed(x1, y1, x2, y2, childballs_, bound_radius_);
+}
+
+// ---------------------------------------------------------------------------
+// cue->child result does not depend on the hole, so it is tested once per
+// child and shared by every tier.
+// ---------------------------------------------------------------------------
+bool ShotSearch::cueLegClear(size_t c) {
+    int& clear = cue_leg_clear_[c];
+    if (clear < 0) {
+        const auto& child = childballs_[c];
+        clear = segmentBlocked(child[0], child[1], cueball_pos_[0], cueball_pos_[1]) ? 0 : 1;
+    }
+    return clear == 1;
+}
+
+// ---------------------------------------------------------------------------
+// Pocket windows are evaluated for all pockets of a child on first use.
+// ---------------------------------------------------------------------------
+const PocketWindow& ShotSearch::pocketWindow(size_t c, size_t h) {
+    std::vector<PocketWindow>& windows = pocket_windows_[c];
+    if (windows.empty()) {
+        evaluatePocketWindows(c, childballs_, table_.pockets, bound_radius_, windows);
+    }
+    ++stats_.segment_tests;
+    return windows[h];
+}
+
+std::vector<ShotCandidate> ShotSearch::search(unsigned tiers, size_t max_shots, const CancellationToken* cancel) {
+    std::vector<ShotCandidate> ranked;
+    stats_.cancelled = false;
+    if (max_shots == 0) return ranked;
+    const std::vector<double>& cueball_pos = cueball_pos_;
+    const std::vector<std::vector<double>>& childballs = childballs_;
+    const std::vector<Pocket>& pockets = table_.pockets;
+    const double bound_radius = bound_radius_;
+    auto expired = [&]() {
+        if (!stats_.cancelled && cancel && cancel->expired()) stats_.cancelled = true;
+        return stats_.cancelled;
+    };
+
+    // ---- Direct shots -----------------------------------------------------
+    // Lower bound = cue->child + child->pocket, which needs no obstacle checks.
+    if (tiers & DIRECT_TIER) {
+        struct DirectCandidate {
+            size_t child;
+            size_t hole;
+            double bound;
+        };
+        std::vector<DirectCandidate> direct;
+        for (size_t c = 0; c < childballs.size(); ++c) {
+            const auto& child = childballs[c];
+            double cue_leg = mag(child[0] - cueball_pos[0], child[1] - cueball_pos[1]);
+            for (size_t h = 0; h < pockets.size(); ++h) {
+                const auto& hole = pockets[h].center;
+                direct.push_back({c, h, cue_leg + mag(hole[0] - child[0], hole[1] - child[1])});
+            }
+        }
+        stats_.candidates += static_cast<int>(direct.size());
+        // selectClearShots answers child->pocket and cue->child for every pair
+        exhaustive_tests_ += 2 * static_cast<int>(direct.size());
+
+        std::stable_sort(direct.begin(), direct.end(),
+            [](const DirectCandidate& a, const DirectCandidate& b) { return a.bound < b.bound; });
+
+        for (const auto& cand : direct) {
+            if (cannotWin(ranked, cand.bound, max_shots)) break;
+            if (expired()) break;
+
+            const auto& child = childballs[cand.child];
+            const auto& hole = pockets[cand.hole].center;
+            if (!isCutAngleFeasible(cueball_pos, child, hole)) continue;
+
+            const PocketWindow& window = pocketWindow(cand.child, cand.hole);
+            if (!window.reachable) continue;
+            if (!cueLegClear(cand.child)) continue;
+
+            insertRanked(ranked, {child, hole, cand.bound, DIRECT_SHOT, window.margin, hole}, max_shots);
+        }
+    }
+
+    if (!(tiers & (CUSHION_TIER | COMBINATION_TIER)) || expired()) {
+        stats_.skipped_segment_tests = exhaustive_tests_ - stats_.segment_tests;
+        return ranked;
+    }
+
+    // ---- Flip, bank, combination and kiss shots ----------------------------
+    // These are ranked together. Their geometry is pure arithmetic and the
+    // path length is the bound; obstacles are only checked later.
+    std::vector<FlipShot> flips;
+    if (tiers & CUSHION_TIER) {
+        for (const auto& cushion : table_.cushions) {
+            for (const auto& target : childballs) {
+                FlipShot fs;
+                if (computeFlipShot(cueball_pos, target, cushion, fs)) flips.push_back(fs);
+            }
+        }
+    }
+    // Bank and two-ball shots only start from balls the cue ball can reach
+    // (cached from the direct tier). Their pocket legs are checked with ball
+    // masks (the balls of the shot have left their spots), so they need at
+    // most 64 balls.
+    std::vector<BankShot> banks;
+    std::vector<CombinationShot> combos;
+    if (childballs.size() <= MAX_MASK_BALLS) {
+        std::vector<bool> strikable(childballs.size());
+        for (size_t c = 0; c < childballs.size() && !expired(); ++c) strikable[c] = cueLegClear(c);
+        if (tiers & CUSHION_TIER) {
+            banks = generateBankShots(cueball_pos, childballs, pockets, buildCushionLines(table_), bound_radius, strikable, cancel);
+        }
+        if (tiers & COMBINATION_TIER) {
+            combos = generateCombinationShots(cueball_pos, childballs, pockets, bound_radius, strikable, cancel);
+        }
+    }
+    stats_.candidates += static_cast<int>(flips.size() + banks.size() + combos.size());
+    // A flip needs cue->wall and wall->target for every pair; bank and
+    // two-ball shots need two more answers each (to the contact, then into
+    // the pocket)
+    exhaustive_tests_ += 2 * static_cast<int>(flips.size() + banks.size() + combos.size());
+
+    struct IndirectCandidate {
+        double bound;
+        ShotKind kind;
+        size_t index;
+    };
+    std::vector<IndirectCandidate> indirect;
+    indirect.reserve(flips.size() + banks.size() + combos.size());
+    for (size_t i = 0; i < flips.size(); ++i) indirect.push_back({flips[i].total_distance, FLIP_SHOT, i});
+    for (size_t i = 0; i < banks.size(); ++i) indirect.push_back({banks[i].total_distance, BANK_SHOT, i});
+    for (size_t i = 0; i < combos.size(); ++i) indirect.push_back({combos[i].total_distance, combos[i].kind, i});
+
+    std::stable_sort(indirect.begin(), indirect.end(),
+        [](const IndirectCandidate& a, const IndirectCandidate& b) { return a.bound < b.bound; });
+
+    for (const auto& cand : indirect) {
+        if (cannotWin(ranked, cand.bound, max_shots)) break;
+        if (expired()) break;
+
+        if (cand.kind == FLIP_SHOT) {
+            // Same two segments as isFlipObstructed: cue -> wall, wall -> target
+            const FlipShot& fs = flips[cand.index];
+            const auto& contact = fs.wall_contact_point;
+            if (segmentBlocked(cueball_pos[0], cueball_pos[1], contact[0], contact[1])) continue;
+            if (segmentBlocked(contact[0], contact[1], fs.target_coords[0], fs.target_coords[1])) continue;
+
+            double margin;
+            size_t h = assignFlipPocket(fs, pockets, bound_radius, margin);
+            if (h == pockets.size()) continue;
+            insertRanked(ranked, {fs.target_coords, pockets[h].center, fs.total_distance, FLIP_SHOT, margin, contact}, max_shots);
+            continue;
+        }
+
+        if (cand.kind == BANK_SHOT) {
+            const BankShot& bs = banks[cand.index];
+            const auto& target = childballs[bs.target];
+            const auto& contact = bs.contact;
+            const auto& hole = pockets[bs.pocket].center;
+            if (segmentBlocked(target[0], target[1], contact[0], contact[1])) continue;
+            // The target has left its spot when it comes off the cushion
+            ++stats_.segment_tests;
+            if (segmentBlockers(contact[0], contact[1], hole[0], hole[1], childballs, bound_radius) & ~ballBit(bs.target)) continue;
+
+            insertRanked(ranked, {target, hole, bs.total_distance, BANK_SHOT, bs.aim_margin, contact}, max_shots);
+            continue;
+        }
+
+        const CombinationShot& cs = combos[cand.index];
+        const auto& first = childballs[cs.first];
+        const auto& contact = cs.contact;
+        const auto& hole = pockets[cs.pocket].center;
+
+        // A's run to the contact may only touch A and B themselves
+        BallMask others = ~(ballBit(cs.first) | ballBit(cs.second));
+        ++stats_.segment_tests;
+        if (segmentBlockers(first[0], first[1], contact[0], contact[1], childballs, bound_radius) & others) continue;
+
+        double margin = cs.aim_margin;
+        if (cs.kind == COMBINATION_SHOT) {
+            const PocketWindow& window = pocketWindow(cs.second, cs.pocket);
+            if (!window.reachable) continue;
+            margin = window.margin;
+        } else {
+            ++stats_.segment_tests;
+            if (segmentBlockers(contact[0], contact[1], hole[0], hole[1], childballs, bound_radius) & others) continue;
+        }
+
+        insertRanked(ranked, {first, hole, cs.total_distance, cs.kind, margin, contact}, max_shots);
+    }
+
+    stats_.skipped_segment_tests = exhaustive_tests_ - stats_.segment_tests;
+    return ranked;
+}
+
+std::vector<ShotCandidate> planShots(
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& childballs,
+    const TableModel& table,
+    double bound_radius,
+    size_t max_shots,
+    PlanStats& stats,
+    const CancellationToken* cancel
+) {
+    ShotSearch search(cueball_pos, childballs, table, bound_radius);
+    std::vector<ShotCandidate> ranked = search.search(DIRECT_TIER, max_shots, cancel);
+    if (ranked.empty() && !search.stats().cancelled) {
+        ranked = search.search(CUSHION_TIER | COMBINATION_TIER, max_shots, cancel);
+    }
+    stats = search.stats();
+    return ranked;
+}
@@ -0,0 +1,147 @@
+// ShotSearch.h
+// ===========================================================================
+// Best-first (branch-and-bound) search over direct and flip shot candidates.
+//
+// selectClearShots and evaluateFlipShots run the full obstruction test on
+// every (child, hole) and (wall, target) pair, even when the pair is too
+// long to ever be selected. planShots instead:
+// - computes a cheap lower bound on total_distance for every candidate
+//   (cue->ball + ball->pocket for direct shots, unfolded mirror path length
+//   for flip shots) without touching the obstacle list
+// - visits candidates in increasing bound order
+// - runs segment obstruction tests only while the bound can still beat the
+//   ranked shots found so far
+//
+// Child->pocket feasibility comes from the pocket acceptance windows
+// (PocketModel), evaluated for all pockets of a child at once the first
+// time one of its candidates is examined.
+//
+// Direct shots keep priority, as in main.cpp: the second tier (flip shots
+// ranked together with the bank shots of BankPlanner and the combination
+// and kiss shots of CombinationPlanner) is only searched if no direct shot
+// is clear. It reuses the per-ball cue-leg and pocket-window results of the
+// first tier. Flip shots get a real pocket from assignFlipPocket.
+//
+// The ShotSearch class exposes the tiers separately (direct, single
+// cushion, two-ball) over shared caches, with a CancellationToken polled
+// once per candidate, for callers that escalate through the tiers under a
+// deadline (AnytimePlanner). planShots is the plain two-tier search on top.
+// ===========================================================================
+
+#ifndef SHOT_SEARCH_H
+#define SHOT_SEARCH_H
+
+#include <cstddef>
+#include <vector>
+#include "CancellationToken.h"
+#include "PocketModel.h"
+#include "TableModel.h"
+#include "ShotCandidate.h"
+
+// ---------------------------------------------------------------------------
+// Counters reported by planShots for one plan:
+// - candidates: candidate pairs generated (before pruning)
+// - segment_tests: cue->child, flip and two-ball path segments tested
+//   against the obstacles, plus child->pocket answers consulted (all
+//   pockets of a child are evaluated together, so each answer is cheaper
+//   than a segment test)
+// - skipped_segment_tests: segment tests the exhaustive planners would have
+//   run (selectClearShots, then two tests per flip, bank or two-ball
+//   shot) that were pruned
+// - cancelled: the cancellation token expired before the search finished;
+//   the shots returned are the best found up to then
+// ---------------------------------------------------------------------------
+struct PlanStats {
+    int candidates;
+    int segment_tests;
+    int skipped_segment_tests;
+    bool cancelled;
+};
+
+// ---------------------------------------------------------------------------
+// Shot families searched by ShotSearch::search, combined as bit flags:
+// - DIRECT_TIER: cue ball straight onto the target, target into the hole
+// - CUSHION_TIER: one cushion on the way (flip shots, and bank shots on
+//   tables with at most 64 balls)
+// - COMBINATION_TIER: two object balls (combination and kiss shots); only
+//   on tables with at most 64 balls
+// ---------------------------------------------------------------------------
+enum ShotTier {
+    DIRECT_TIER = 1,
+    CUSHION_TIER = 2,
+    COMBINATION_TIER = 4
+};
+
+// ---------------------------------------------------------------------------
+// Best-first search over one layout, tier by tier. Cue-leg clearance and
+// pocket windows are cached per ball across search() calls, so searching
+// the direct tier and then the indirect tiers costs the same as one
+// planShots call. The layout and table are referenced, not copied, and
+// must outlive the search.
+// ---------------------------------------------------------------------------
+class ShotSearch {
+public:
+    ShotSearch(
+        const std::vector<double>& cueball_pos,
+        const std::vector<std::vector<double>>& childballs,
+        const TableModel& table,
+        double bound_radius
+    );
+
+    // -----------------------------------------------------------------------
+    // Finds the 'max_shots' shortest clear shots of the given tiers (ShotTier
+    // flags), ranked together by total_distance. If 'cancel' expires the
+    // best shots found so far are returned and stats().cancelled is set.
+    // -----------------------------------------------------------------------
+    std::vector<ShotCandidate> search(unsigned tiers, size_t max_shots, const CancellationToken* cancel = nullptr);
+
+    // Counters accumulated over every search() call so far; 'cancelled'
+    // refers to the last call
+    const PlanStats& stats() const { return stats_; }
+
+private:
+    bool segmentBlocked(double x1, double y1, double x2, double y2);
+    bool cueLegClear(size_t c);
+    const PocketWindow& pocketWindow(size_t c, size_t h);
+
+    const std::vector<double>& cueball_pos_;
+    const std::vector<std::vector<double>>& childballs_;
+    const TableModel& table_;
+    double bound_radius_;
+
+    std::vector<int> cue_leg_clear_;                        // -1 = not tested
+    std::vector<std::vector<PocketWindow>> pocket_windows_; // empty = not evaluated
+    PlanStats stats_;
+    int exhaustive_tests_;
+};
+
+// ---------------------------------------------------------------------------
+// Finds the 'max_shots' shortest clear shots, ranked by total_distance.
+//
+// Parameters:
+// - cueball_pos: position of the cueball (mother ball)
+// - childballs: child balls (targets and obstacles)
+// - table: pockets, and the cushions used for flip and bank shots, built by
+//   buildTableModel()
+// - bound_radius: clearance margin (typically ball diameter)
+// - max_shots: number of ranked shots to return
+// - stats: filled with the counters described above
+// - cancel: optional; polled once per candidate, see ShotSearch::search
+//
+// Returns the same shots, in the same order, as ranking the full output of
+// the pocket version of selectClearShots (or, when that is empty, of every
+// clear flip shot off a cushion with an assigned pocket, plus every clear
+// bank and two-ball shot) and keeping the first 'max_shots'. Bank and
+// two-ball shots are skipped on tables with more than 64 balls.
+// ---------------------------------------------------------------------------
+std::vector<ShotCandidate> planShots(
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& childballs,
+    const TableModel& table,
+    double bound_radius,
+    size_t max_shots,
+    PlanStats& stats,
+    const CancellationToken* cancel = nullptr
+);
+
+#endif // SHOT_SEARCH_H
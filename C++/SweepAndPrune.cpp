@@ -0,0 +1,92 @@
+// SweepAndPrune.cpp
+// ===========================================================================
+// Implements the incremental sort-and-sweep broadphase.
+// ===========================================================================
+
+#include "SweepAndPrune.h"
+
+void SweepAndPrune::reset(size_t count) {
+    ends_.resize(2 * count);
+    position_.resize(2 * count);
+    for (size_t e = 0; e < 2 * count; ++e) {
+        ends_[e] = {0.0, static_cast<uint32_t>(e)};
+        position_[e] = e;
+    }
+    x_overlap_.assign(count, 0);
+    min_y_.assign(count, 0.0);
+    max_y_.assign(count, 0.0);
+    swaps_ = 0;
+}
+
+void SweepAndPrune::reserve(size_t count) {
+    ends_.reserve(2 * count);
+    position_.reserve(2 * count);
+    x_overlap_.reserve(count);
+    min_y_.reserve(count);
+    max_y_.reserve(count);
+}
+
+// ---------------------------------------------------------------------------
+// Swaps ends_[left] and ends_[left + 1]. If a min end and a max end of two
+// different balls change order, their x intervals start or stop
+// overlapping: min moving before the other's max starts it, max moving
+// before the other's min ends it.
+// ---------------------------------------------------------------------------
+void SweepAndPrune::swapEndpoints(size_t left) {
+    Endpoint a = ends_[left];      // moves right
+    Endpoint b = ends_[left + 1];  // moves left
+    size_t ball_a = a.id >> 1;
+    size_t ball_b = b.id >> 1;
+    if (ball_a != ball_b) {
+        bool a_max = a.id & 1;
+        bool b_max = b.id & 1;
+        if (!b_max && a_max) {
+            x_overlap_[ball_a] |= ballBit(ball_b);
+            x_overlap_[ball_b] |= ballBit(ball_a);
+        } else if (b_max && !a_max) {
+            x_overlap_[ball_a] &= ~ballBit(ball_b);
+            x_overlap_[ball_b] &= ~ballBit(ball_a);
+        }
+    }
+    ends_[left] = b;
+    ends_[left + 1] = a;
+    position_[b.id] = left;
+    position_[a.id] = left + 1;
+    ++swaps_;
+}
+
+void SweepAndPrune::moveEndpoint(size_t index, double value) {
+    ends_[index].value = value;
+    while (index > 0 && ends_[index - 1].value > value) {
+        swapEndpoints(index - 1);
+        --index;
+    }
+    while (index + 1 < ends_.size() && ends_[index + 1].value < value) {
+        swapEndpoints(index);
+        ++index;
+    }
+}
+
+void SweepAndPrune::update(size_t i, double min_x, double min_y, double max_x, double max_y) {
+    size_t lo = position_[2 * i];
+    size_t hi = position_[2 * i + 1];
+    // Move the leading end first so the min end never passes its own max
+    if (min_x < ends_[lo].value) {
+        moveEndpoint(lo, min_x);
+        moveEndpoint(position_[2 * i + 1], max_x);
+    } else {
+        moveEndpoint(hi, max_x);
+        moveEndpoint(position_[2 * i], min_x);
+    }
+    min_y_[i] = min_y;
+    max_y_[i] = max_y;
+}
+
+BallMask SweepAndPrune::overlaps(size_t i) const {
+    BallMask result = 0;
+    for (BallMask m = x_overlap_[i]; m; m &= m - 1) {
+        size_t j = lowestBall(m);
+        if (min_y_[j] <= max_y_[i] && min_y_[i] <= max_y_[j]) result |= ballBit(j);
+    }
+    return result;
+}
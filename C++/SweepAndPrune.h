@@ -0,0 +1,71 @@
+// SweepAndPrune.h
+// ===========================================================================
+// Incremental sort-and-sweep broadphase for the ball simulator.
+//
+// Every ball owns an axis-aligned box (its swept bounds: the stretch of
+// table it covers until its next own event, grown by the ball radius).
+// The box ends on the x axis are kept in one sorted list, and for each
+// pair of balls a bit records whether their x intervals overlap.
+//
+// Between events only the balls involved change their boxes, and only by
+// a little, so update() moves the ends of one box to their new place by
+// insertion (swapping neighbours). Each swap of a min end with a max end
+// of another ball starts or ends one x overlap, so the overlap bits stay
+// exact without ever testing all pairs. overlaps() then only checks the
+// y intervals of the balls already overlapping in x.
+//
+// Ball sets are BallMask bitboards, so at most MAX_MASK_BALLS balls.
+// ===========================================================================
+
+#ifndef SWEEP_AND_PRUNE_H
+#define SWEEP_AND_PRUNE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "BallMask.h"
+
+class SweepAndPrune {
+public:
+    SweepAndPrune() : swaps_(0) {}
+
+    // -----------------------------------------------------------------------
+    // Starts over with 'count' balls, all with an empty box at the origin
+    // (overlapping nothing). Keeps the allocated storage.
+    // -----------------------------------------------------------------------
+    void reset(size_t count);
+
+    // Allocates storage for up to 'count' balls, so reset() and update()
+    // with at most that many never allocate
+    void reserve(size_t count);
+
+    // -----------------------------------------------------------------------
+    // Moves ball i's box to [min_x, max_x] x [min_y, max_y] (min <= max).
+    // Cost is proportional to the number of box ends passed.
+    // -----------------------------------------------------------------------
+    void update(size_t i, double min_x, double min_y, double max_x, double max_y);
+
+    // Balls whose boxes overlap ball i's box (i itself excluded)
+    BallMask overlaps(size_t i) const;
+
+    // Neighbour swaps done by update() since the last reset()
+    size_t swaps() const { return swaps_; }
+
+private:
+    // One end of a box on the x axis; id = 2 * ball + (1 for the max end)
+    struct Endpoint {
+        double value;
+        uint32_t id;
+    };
+
+    void moveEndpoint(size_t index, double value);
+    void swapEndpoints(size_t left);
+
+    std::vector<Endpoint> ends_;     // sorted by value
+    std::vector<size_t> position_;   // index in ends_ per endpoint id
+    std::vector<BallMask> x_overlap_;
+    std::vector<double> min_y_, max_y_;
+    size_t swaps_;
+};
+
+#endif // SWEEP_AND_PRUNE_H
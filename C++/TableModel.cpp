@@ -0,0 +1,198 @@
+// TableModel.cpp
+// ===========================================================================
+// Builds cushion segments and their reflection matrices.
+// ===========================================================================
+
+#include "TableModel.h"
+#include "GeometryUtils.h"
+#include "ShotPlanner.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// ---------------------------------------------------------------------------
+// Fills the reflection matrix of 'c' for the line normal . p = centre_offset:
+// p' = p - 2 (normal . p - centre_offset) normal
+// ---------------------------------------------------------------------------
+static void setReflection(Cushion& c) {
+    double nx = c.normal[0];
+    double ny = c.normal[1];
+    double k = c.centre_offset;
+    c.reflect[0] = 1 - 2 * nx * nx;
+    c.reflect[1] = -2 * nx * ny;
+    c.reflect[2] = 2 * k * nx;
+    c.reflect[3] = -2 * nx * ny;
+    c.reflect[4] = 1 - 2 * ny * ny;
+    c.reflect[5] = 2 * k * ny;
+}
+
+TableModel buildTableModel(
+    const std::vector<std::vector<double>>& holes,
+    const std::vector<std::vector<double>>& walls,
+    double mouth_width,
+    double ball_radius
+) {
+    TableModel table;
+    table.pockets = buildPockets(holes, mouth_width);
+    if (holes.empty()) return table;
+
+    double centre_x = 0, centre_y = 0;
+    for (const auto& hole : holes) {
+        centre_x += hole[0];
+        centre_y += hole[1];
+    }
+    centre_x /= holes.size();
+    centre_y /= holes.size();
+
+    const double half_mouth = mouth_width / 2;
+    std::vector<std::pair<double, double>> rails; // (normal angle, offset) already built
+
+    for (const auto& wall : walls) {
+        double nx = centre_x - wall[0];
+        double ny = centre_y - wall[1];
+        double norm = mag(nx, ny);
+        if (norm <= 0) continue;
+        nx /= norm;
+        ny /= norm;
+        double offset = nx * wall[0] + ny * wall[1];
+
+        // Skip rails already built from another point on the same line
+        double angle = std::atan2(ny, nx);
+        bool seen = false;
+        for (const auto& r : rails) {
+            if (std::abs(std::remainder(r.first - angle, 6.28318530717958647692)) < 1e-6 &&
+                std::abs(r.second - offset) < 1e-6) {
+                seen = true;
+                break;
+            }
+        }
+        if (seen) continue;
+        rails.emplace_back(angle, offset);
+
+        // Along-rail direction with the table on the left
+        double dx = ny;
+        double dy = -nx;
+        double origin = dx * wall[0] + dy * wall[1];
+
+        // Pockets on this rail, by position along it
+        std::vector<double> cuts;
+        double lo = 0, hi = 0;
+        bool any = false;
+        for (const auto& hole : holes) {
+            double along = dx * hole[0] + dy * hole[1] - origin;
+            if (!any || along < lo) lo = along;
+            if (!any || along > hi) hi = along;
+            any = true;
+            if (std::abs(nx * hole[0] + ny * hole[1] - offset) <= half_mouth) {
+                cuts.push_back(along);
+            }
+        }
+        std::sort(cuts.begin(), cuts.end());
+        // Rails with no pocket at an end run to the table's extent
+        if (cuts.empty() || cuts.front() > lo) cuts.insert(cuts.begin(), lo - half_mouth);
+        if (cuts.back() < hi) cuts.push_back(hi + half_mouth);
+
+        // One cushion between each pair of neighbouring pockets
+        for (size_t i = 0; i + 1 < cuts.size(); ++i) {
+            double a = cuts[i] + half_mouth;
+            double b = cuts[i + 1] - half_mouth;
+            if (a >= b) continue;
+            Cushion c;
+            c.start = {wall[0] + dx * a, wall[1] + dy * a};
+            c.end = {wall[0] + dx * b, wall[1] + dy * b};
+            c.normal = {nx, ny};
+            c.offset = offset;
+            c.centre_offset = offset + ball_radius;
+            setReflection(c);
+            table.cushions.push_back(c);
+        }
+    }
+    return table;
+}
+
+bool cushionContact(
+    const Cushion& c,
+    const std::vector<double>& from,
+    const std::vector<double>& to,
+    std::vector<double>& contact
+) {
+    const double nx = c.normal[0];
+    const double ny = c.normal[1];
+    double s_from = nx * from[0] + ny * from[1] - c.centre_offset;
+    double s_to = nx * to[0] + ny * to[1] - c.centre_offset;
+    if (s_from <= 0 || s_to <= 0) return false;
+
+    double mx, my;
+    mirrorPoint(c, to[0], to[1], mx, my);
+    // The contact divides the unfolded path in the ratio of the distances
+    double frac = s_from / (s_from + s_to);
+    double cx = from[0] + frac * (mx - from[0]);
+    double cy = from[1] + frac * (my - from[1]);
+
+    // Must land between the cushion ends (measured along the rail)
+    double dx = c.end[0] - c.start[0];
+    double dy = c.end[1] - c.start[1];
+    double along = (cx - c.start[0]) * dx + (cy - c.start[1]) * dy;
+    if (along < 0 || along > dx * dx + dy * dy) return false;
+
+    contact = {cx, cy};
+    return true;
+}
+
+RollResult rollOnTable(
+    const TableModel& table,
+    double x, double y, double dx, double dy, double distance,
+    const std::vector<std::vector<double>>& obstacles,
+    double bound_radius,
+    double& end_x, double& end_y, int& bounces
+) {
+    for (int leg = 0; leg <= MAX_ROLL_BOUNCES; ++leg) {
+        end_x = x;
+        end_y = y;
+        // Nearest rail line ahead, and nearest cushion segment ahead
+        double t_line = std::numeric_limits<double>::max();
+        double t_cushion = std::numeric_limits<double>::max();
+        const Cushion* hit = nullptr;
+        for (const auto& c : table.cushions) {
+            double approach = c.normal[0] * dx + c.normal[1] * dy;
+            if (approach >= 0) continue;
+            double t = (c.centre_offset - c.normal[0] * x - c.normal[1] * y) / approach;
+            if (t < 0) t = 0;
+            t_line = std::min(t_line, t);
+
+            double hx = x + t * dx - c.start[0];
+            double hy = y + t * dy - c.start[1];
+            double sx = c.end[0] - c.start[0];
+            double sy = c.end[1] - c.start[1];
+            double along = hx * sx + hy * sy;
+            if (along >= 0 && along <= sx * sx + sy * sy && t < t_cushion) {
+                t_cushion = t;
+                hit = &c;
+            }
+        }
+
+        if (t_line >= distance) {
+            double stop_x = x + distance * dx;
+            double stop_y = y + distance * dy;
+            if (isPathObstructed(x, y, stop_x, stop_y, obstacles, bound_radius)) return ROLL_BLOCKED;
+            end_x = stop_x;
+            end_y = stop_y;
+            return ROLL_STOPPED;
+        }
+        // The first rail line crossed has no cushion there: pocket mouth
+        if (!hit || t_cushion > t_line + 1e-9) return ROLL_POCKETED;
+
+        double bx = x + t_cushion * dx;
+        double by = y + t_cushion * dy;
+        if (isPathObstructed(x, y, bx, by, obstacles, bound_radius)) return ROLL_BLOCKED;
+
+        double approach = hit->normal[0] * dx + hit->normal[1] * dy;
+        dx -= 2 * approach * hit->normal[0];
+        dy -= 2 * approach * hit->normal[1];
+        x = bx;
+        y = by;
+        distance -= t_cushion;
+        ++bounces;
+    }
+    return ROLL_TOO_MANY_BOUNCES;
+}
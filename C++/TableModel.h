@@ -0,0 +1,134 @@
+// TableModel.h
+// ===========================================================================
+// Table geometry with cushions as oriented segments between pocket mouths.
+//
+// walls.csv only gives one point on each rail. The rail is the line through
+// that point, perpendicular to the direction towards the table centre;
+// the pockets lying on it cut the rail into cushion segments, and the
+// pocket mouths are the gaps between them (e.g. a long rail with a side
+// pocket becomes two cushions).
+//
+// Every cushion stores the 2x3 affine matrix reflecting a ball centre
+// across it. The ball centre turns one radius before the rail, so the
+// reflection is about the rail moved inwards by the ball radius. Mirroring
+// a point is then one multiply-add chain per coordinate:
+//   x' = m[0] * x + m[1] * y + m[2]
+//   y' = m[3] * x + m[4] * y + m[5]
+//
+// Key parts:
+// - buildTableModel: pockets and cushions from holes.csv / walls.csv
+// - mirrorPoint: applies a cushion's reflection matrix
+// - cushionContact: where a ball centre path meets a cushion, validated to
+//   land on the cushion segment rather than in a pocket mouth
+// - rollOnTable: straight roll of one ball with cushion bounces
+// ===========================================================================
+
+#ifndef TABLE_MODEL_H
+#define TABLE_MODEL_H
+
+#include <vector>
+#include "PocketModel.h"
+
+// ---------------------------------------------------------------------------
+// One cushion segment:
+// - start / end: segment ends on the rail line, oriented so the table is
+//   on the left when walking from start to end
+// - normal: unit normal pointing into the table
+// - offset: rail line is normal . p = offset
+// - centre_offset: line of ball centres at contact, offset + ball radius
+// - reflect: 2x3 row-major matrix reflecting a point across the line of
+//   ball centres
+// ---------------------------------------------------------------------------
+struct Cushion {
+    std::vector<double> start;
+    std::vector<double> end;
+    std::vector<double> normal;
+    double offset;
+    double centre_offset;
+    double reflect[6];
+};
+
+// ---------------------------------------------------------------------------
+// Pockets and cushions of one table.
+// ---------------------------------------------------------------------------
+struct TableModel {
+    std::vector<Pocket> pockets;
+    std::vector<Cushion> cushions;
+};
+
+// ---------------------------------------------------------------------------
+// Builds the table model.
+//
+// - holes: pocket centres (holes.csv)
+// - walls: one point per rail (walls.csv); points on the same rail give the
+//   same cushions and are merged
+// - mouth_width: pocket mouth width (see buildPockets)
+// - ball_radius: offset of the ball centre line from the rail
+//
+// A pocket lies on a rail if its centre is within half a mouth of the rail
+// line. The cushion segments stop at the jaws of those pockets.
+// ---------------------------------------------------------------------------
+TableModel buildTableModel(
+    const std::vector<std::vector<double>>& holes,
+    const std::vector<std::vector<double>>& walls,
+    double mouth_width,
+    double ball_radius
+);
+
+// ---------------------------------------------------------------------------
+// Reflects point (x, y) across the cushion's line of ball centres.
+// ---------------------------------------------------------------------------
+inline void mirrorPoint(const Cushion& c, double x, double y, double& mx, double& my) {
+    mx = c.reflect[0] * x + c.reflect[1] * y + c.reflect[2];
+    my = c.reflect[3] * x + c.reflect[4] * y + c.reflect[5];
+}
+
+// ---------------------------------------------------------------------------
+// Contact point of a banked ball path from 'from' to 'to' off cushion 'c'
+// (the point where the straight line from 'from' to the mirror image of
+// 'to' crosses the line of ball centres).
+//
+// Returns false if either point is not on the table side of the cushion,
+// or if the contact does not land on the cushion segment (beyond its ends,
+// i.e. in a pocket mouth or past the table corner).
+// ---------------------------------------------------------------------------
+bool cushionContact(
+    const Cushion& c,
+    const std::vector<double>& from,
+    const std::vector<double>& to,
+    std::vector<double>& contact
+);
+
+// ---------------------------------------------------------------------------
+// How a rollOnTable call ended:
+// - ROLL_STOPPED: the ball used up its distance on the table
+// - ROLL_POCKETED: it crossed a rail line through a pocket mouth
+// - ROLL_BLOCKED: it ran into one of the obstacles
+// - ROLL_TOO_MANY_BOUNCES: still moving after MAX_ROLL_BOUNCES cushions
+// ---------------------------------------------------------------------------
+enum RollResult {
+    ROLL_STOPPED,
+    ROLL_POCKETED,
+    ROLL_BLOCKED,
+    ROLL_TOO_MANY_BOUNCES
+};
+
+// Cushion bounces followed per roll
+const int MAX_ROLL_BOUNCES = 6;
+
+// ---------------------------------------------------------------------------
+// Rolls a ball centre from (x, y) along unit direction (dx, dy) for
+// 'distance' mm, bouncing off the cushions (angle in = angle out).
+// 'bounces' is increased per cushion hit. (end_x, end_y) is the resting
+// place for ROLL_STOPPED, otherwise where the last leg started. Obstacles
+// within 'bound_radius' of the path block it.
+// ---------------------------------------------------------------------------
+RollResult rollOnTable(
+    const TableModel& table,
+    double x, double y, double dx, double dy, double distance,
+    const std::vector<std::vector<double>>& obstacles,
+    double bound_radius,
+    double& end_x, double& end_y, int& bounces
+);
+
+#endif // TABLE_MODEL_H
@@ -0,0 +1,40 @@
+// TableState.cpp
+// ===========================================================================
+// Converts between TableState and the planners' ball lists.
+// ===========================================================================
+
+#include "TableState.h"
+
+bool makeTableState(
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& childballs,
+    TableState& state
+) {
+    if (childballs.size() > TABLE_STATE_BALLS) return false;
+    state = TableState();
+    state.cue_x = cueball_pos[0];
+    state.cue_y = cueball_pos[1];
+    for (size_t slot = 0; slot < childballs.size(); ++slot) {
+        state.x[slot] = childballs[slot][0];
+        state.y[slot] = childballs[slot][1];
+    }
+    state.slots = static_cast<uint32_t>(childballs.size());
+    state.present = (uint32_t(1) << state.slots) - 1;
+    return true;
+}
+
+void tableStateBalls(
+    const TableState& state,
+    std::vector<double>& cueball_pos,
+    std::vector<std::vector<double>>& childballs
+) {
+    cueball_pos.assign({state.cue_x, state.cue_y});
+    size_t count = 0;
+    for (size_t slot = 0; slot < state.slots; ++slot) {
+        if (!state.hasBall(slot)) continue;
+        if (count == childballs.size()) childballs.emplace_back(2);
+        childballs[count].assign({state.x[slot], state.y[slot]});
+        ++count;
+    }
+    childballs.resize(count);
+}
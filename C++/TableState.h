@@ -0,0 +1,124 @@
+// TableState.h
+// ===========================================================================
+// Compact table state for search branching.
+//
+// Lookahead and sampling searches branch the table thousands of times per
+// frame. Copying the planners' std::vector<std::vector<double>> ball lists
+// costs one allocation per ball; TableState instead keeps up to
+// TABLE_STATE_BALLS child balls in fixed arrays, so it is trivially
+// copyable and a snapshot is one memcpy of a few hundred bytes.
+//
+// With -march=native g++ copies a state with a few vector moves; generic
+// x86-64 tuning uses rep movsq, which costs a few times more per branch.
+//
+// Balls keep their slot for the life of a state: potting a ball clears its
+// bit in 'present' instead of moving the others, so slot numbers stay
+// valid across branches.
+//
+// Key parts:
+// - makeTableState / tableStateBalls: to and from the planners' ball lists
+// - TableStateStack: branch (copy the top), modify the top, roll back
+// ===========================================================================
+
+#ifndef TABLE_STATE_H
+#define TABLE_STATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "BallMask.h"
+
+// Child balls one state can hold
+const size_t TABLE_STATE_BALLS = 16;
+
+// ---------------------------------------------------------------------------
+// - cue_x, cue_y: cue ball position
+// - x, y: child ball positions by slot (slots 0..slots-1 were filled)
+// - present: bit per slot, cleared when the ball is potted
+// ---------------------------------------------------------------------------
+struct TableState {
+    double cue_x, cue_y;
+    double x[TABLE_STATE_BALLS];
+    double y[TABLE_STATE_BALLS];
+    uint32_t present;
+    uint32_t slots;
+
+    bool hasBall(size_t slot) const { return (present >> slot) & 1; }
+
+    // Child balls still on the table
+    int ballCount() const { return countBalls(present); }
+
+    void moveCueBall(double to_x, double to_y) {
+        cue_x = to_x;
+        cue_y = to_y;
+    }
+
+    void moveBall(size_t slot, double to_x, double to_y) {
+        x[slot] = to_x;
+        y[slot] = to_y;
+    }
+
+    void removeBall(size_t slot) { present &= ~(uint32_t(1) << slot); }
+};
+
+static_assert(std::is_trivially_copyable<TableState>::value, "TableState must be memcpy-copyable");
+static_assert(sizeof(TableState) <= 512, "TableState must stay under 512 bytes");
+
+// ---------------------------------------------------------------------------
+// Fills 'state' from the planners' ball lists. Returns false (and leaves
+// 'state' unspecified) if there are more than TABLE_STATE_BALLS children.
+// ---------------------------------------------------------------------------
+bool makeTableState(
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& childballs,
+    TableState& state
+);
+
+// ---------------------------------------------------------------------------
+// Writes the state back as ball lists (present balls in slot order),
+// reusing the capacity of the output vectors.
+// ---------------------------------------------------------------------------
+void tableStateBalls(
+    const TableState& state,
+    std::vector<double>& cueball_pos,
+    std::vector<std::vector<double>>& childballs
+);
+
+// ---------------------------------------------------------------------------
+// Stack of states for depth-first search. The storage for 'max_depth'
+// branches is allocated once; branch() copies the top state into the next
+// slot, the caller modifies top(), and rollback() drops it again.
+// ---------------------------------------------------------------------------
+class TableStateStack {
+public:
+    TableStateStack(const TableState& root, size_t max_depth)
+        : states_(max_depth + 1), depth_(0) {
+        states_[0] = root;
+    }
+
+    TableState& top() { return states_[depth_]; }
+    const TableState& top() const { return states_[depth_]; }
+
+    // Branches below 'root' currently open
+    size_t depth() const { return depth_; }
+
+    // Opens a branch with a copy of the top; false if max_depth is reached
+    bool branch() {
+        if (depth_ + 1 == states_.size()) return false;
+        states_[depth_ + 1] = states_[depth_];
+        ++depth_;
+        return true;
+    }
+
+    // Drops the top branch (the root is never dropped)
+    void rollback() {
+        if (depth_ > 0) --depth_;
+    }
+
+private:
+    std::vector<TableState> states_;
+    size_t depth_;
+};
+
+#endif // TABLE_STATE_H
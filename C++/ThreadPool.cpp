@@ -0,0 +1,89 @@
+// ThreadPool.cpp
+// ===========================================================================
+// Implements the worker pool behind parallelFor.
+// ===========================================================================
+
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(size_t threads)
+    : task_(nullptr), count_(0), next_(0), completed_(0),
+      generation_(0), busy_workers_(0), stopping_(false) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    for (size_t i = 1; i < threads; ++i) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) worker.join();
+}
+
+// ---------------------------------------------------------------------------
+// Claims indices of the current job until they run out or the deadline
+// passes.
+// ---------------------------------------------------------------------------
+void ThreadPool::runTasks() {
+    for (;;) {
+        if (Clock::now() >= deadline_) return;
+        size_t i = next_.fetch_add(1, std::memory_order_relaxed);
+        if (i >= count_) return;
+        (*task_)(i);
+        completed_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void ThreadPool::workerLoop() {
+    size_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_) return;
+            seen = generation_;
+            ++busy_workers_;
+        }
+        runTasks();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --busy_workers_;
+        }
+        done_.notify_one();
+    }
+}
+
+size_t ThreadPool::parallelFor(
+    size_t count,
+    const std::function<void(size_t)>& task,
+    Clock::time_point deadline
+) {
+    std::lock_guard<std::mutex> run_lock(run_mutex_);
+    {
+        // A worker that woke up late for the previous job may still be
+        // reading its fields
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [&] { return busy_workers_ == 0; });
+        task_ = &task;
+        count_ = count;
+        deadline_ = deadline;
+        next_.store(0);
+        completed_.store(0);
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    runTasks();
+
+    // Workers that have not woken up yet find no indices left and leave
+    // at once
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&] { return busy_workers_ == 0; });
+    task_ = nullptr;
+    count_ = 0;
+    return completed_.load();
+}
@@ -0,0 +1,77 @@
+// ThreadPool.h
+// ===========================================================================
+// Fixed set of worker threads for running planner work in parallel within a
+// deadline.
+//
+// The planners are pure functions of the layout, so independent pieces of
+// work (one sampled shot, one subset of balls, ...) can run on any thread.
+// parallelFor hands out indices from a shared counter, so fast and slow
+// items balance themselves across the workers, and stops handing them out
+// once the deadline has passed. The calling thread works too, so a pool of
+// size 1 is plain serial execution.
+// ===========================================================================
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Pool of 'threads - 1' workers plus the calling thread.
+//
+// - threads: total number of threads running a parallelFor, including the
+//   caller; 0 picks std::thread::hardware_concurrency()
+// - parallelFor: runs task(i) for i in [0, count) and returns how many
+//   tasks were run. No new task is started after 'deadline'; tasks already
+//   running are finished before it returns. Tasks must not call
+//   parallelFor on the same pool.
+//
+// One parallelFor runs at a time; concurrent callers wait for each other.
+// ---------------------------------------------------------------------------
+class ThreadPool {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    explicit ThreadPool(size_t threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers_.size() + 1; }
+
+    size_t parallelFor(
+        size_t count,
+        const std::function<void(size_t)>& task,
+        Clock::time_point deadline = Clock::time_point::max()
+    );
+
+private:
+    void workerLoop();
+    void runTasks();
+
+    std::vector<std::thread> workers_;
+    std::mutex run_mutex_;   // serializes parallelFor calls
+    std::mutex mutex_;       // guards the job fields below
+    std::condition_variable wake_;
+    std::condition_variable done_;
+
+    // Current job
+    const std::function<void(size_t)>* task_;
+    size_t count_;
+    Clock::time_point deadline_;
+    std::atomic<size_t> next_;
+    std::atomic<size_t> completed_;
+    size_t generation_;
+    size_t busy_workers_;
+    bool stopping_;
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,101 @@
+// TranspositionTable.cpp
+// ===========================================================================
+// Implements the lock-free transposition table.
+//
+// Packed entry (data word):
+//   bits  0-31  value (float bits)
+//   bits 32-47  shot
+//   bits 48-55  depth
+//   bits 56-62  generation (mod 128)
+//   bit  63     set for every stored entry, so data == 0 means empty
+// ===========================================================================
+
+#include "TranspositionTable.h"
+#include <cstring>
+
+static const uint64_t USED_BIT = uint64_t(1) << 63;
+static const unsigned GENERATION_MASK = 0x7f;
+
+TranspositionTable::TranspositionTable(size_t memory_bytes) : bucket_mask_(0), generation_(0) {
+    size_t buckets = 1;
+    while (buckets * 2 * sizeof(Bucket) <= memory_bytes) buckets *= 2;
+    bucket_mask_ = buckets - 1;
+    buckets_.reset(new Bucket[buckets]);
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (size_t b = 0; b <= bucket_mask_; ++b) {
+        for (Slot& slot : buckets_[b].slots) {
+            slot.check.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void TranspositionTable::newSearch() {
+    generation_.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t TranspositionTable::pack(const TranspositionEntry& entry, unsigned generation) {
+    uint32_t value_bits;
+    std::memcpy(&value_bits, &entry.value, sizeof(value_bits));
+    return uint64_t(value_bits) |
+           (uint64_t(entry.shot) << 32) |
+           (uint64_t(entry.depth) << 48) |
+           (uint64_t(generation & GENERATION_MASK) << 56) |
+           USED_BIT;
+}
+
+TranspositionEntry TranspositionTable::unpack(uint64_t data) {
+    TranspositionEntry entry;
+    uint32_t value_bits = static_cast<uint32_t>(data);
+    std::memcpy(&entry.value, &value_bits, sizeof(value_bits));
+    entry.shot = static_cast<uint16_t>(data >> 32);
+    entry.depth = static_cast<uint8_t>(data >> 48);
+    return entry;
+}
+
+unsigned TranspositionTable::generationOf(uint64_t data) {
+    return static_cast<unsigned>(data >> 56) & GENERATION_MASK;
+}
+
+bool TranspositionTable::probe(uint64_t key, TranspositionEntry& entry) const {
+    const Slot* bucket = buckets_[key & bucket_mask_].slots;
+    for (size_t s = 0; s < TRANSPOSITION_BUCKET_SLOTS; ++s) {
+        uint64_t data = bucket[s].data.load(std::memory_order_relaxed);
+        uint64_t check = bucket[s].check.load(std::memory_order_relaxed);
+        if (data != 0 && (check ^ data) == key) {
+            entry = unpack(data);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, const TranspositionEntry& entry) {
+    const unsigned generation = generation_.load(std::memory_order_relaxed);
+    Slot* bucket = buckets_[key & bucket_mask_].slots;
+
+    // Same key, else an empty slot, else the shallowest after ageing
+    Slot* victim = nullptr;
+    int victim_worth = 0;
+    for (size_t s = 0; s < TRANSPOSITION_BUCKET_SLOTS; ++s) {
+        uint64_t data = bucket[s].data.load(std::memory_order_relaxed);
+        uint64_t check = bucket[s].check.load(std::memory_order_relaxed);
+        if (data == 0 || (check ^ data) == key) {
+            victim = &bucket[s];
+            break;
+        }
+        int age = static_cast<int>((generation - generationOf(data)) & GENERATION_MASK);
+        int worth = static_cast<int>((data >> 48) & 0xff) - TRANSPOSITION_AGE_WEIGHT * age;
+        if (!victim || worth < victim_worth) {
+            victim = &bucket[s];
+            victim_worth = worth;
+        }
+    }
+
+    uint64_t data = pack(entry, generation);
+    victim->data.store(data, std::memory_order_relaxed);
+    victim->check.store(key ^ data, std::memory_order_relaxed);
+}
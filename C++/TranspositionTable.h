@@ -0,0 +1,103 @@
+// TranspositionTable.h
+// ===========================================================================
+// Lock-free, fixed-size position cache shared by parallel search threads.
+//
+// A search over shot sequences reaches the same table state by different
+// orders of shots. The transposition table remembers what was found below
+// a state, keyed by hashTableState (PlanCache.h) of the quantized layout.
+//
+// Layout and concurrency:
+// - the table is an array of 64-byte buckets of TRANSPOSITION_BUCKET_SLOTS
+//   slots; a key maps to one bucket by its low bits
+// - a slot is two atomic 64-bit words: 'data' packs the whole entry (value,
+//   shot, depth, generation) and 'check' holds key XOR data
+// - readers and writers use plain relaxed loads and stores, no locks; a
+//   slot written by two threads at once can end up with the words of
+//   different writes, but then check XOR data no longer gives a key that
+//   is looked up, so torn slots read as misses
+//
+// Replacement: a store for a key already in the bucket overwrites it;
+// otherwise it takes an empty slot, or evicts the slot with the lowest
+// depth after subtracting TRANSPOSITION_AGE_WEIGHT per search generation
+// the slot is old. newSearch() starts a generation, so entries from
+// earlier frames give way first.
+//
+// The memory cap is fixed at construction and rounded down to a power of
+// two buckets (at least one).
+// ===========================================================================
+
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Slots per bucket (4 x 16 bytes = one cache line)
+const size_t TRANSPOSITION_BUCKET_SLOTS = 4;
+
+// Depth an entry loses per search generation of age when choosing a victim
+const int TRANSPOSITION_AGE_WEIGHT = 2;
+
+// Shot value for "no best shot"
+const uint16_t NO_TRANSPOSITION_SHOT = 0xffff;
+
+// ---------------------------------------------------------------------------
+// What a search stores about one table state:
+// - value: its score
+// - shot: index of the best shot found, or NO_TRANSPOSITION_SHOT
+// - depth: shots searched below it (deeper results are kept longer)
+// ---------------------------------------------------------------------------
+struct TranspositionEntry {
+    float value;
+    uint16_t shot;
+    uint8_t depth;
+};
+
+class TranspositionTable {
+public:
+    // Uses at most 'memory_bytes' for slots
+    explicit TranspositionTable(size_t memory_bytes);
+
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    // -----------------------------------------------------------------------
+    // Fills 'entry' and returns true if 'key' is stored. Safe to call from
+    // any number of threads alongside store().
+    // -----------------------------------------------------------------------
+    bool probe(uint64_t key, TranspositionEntry& entry) const;
+
+    // Stores 'entry' for 'key' (thread-safe, see the replacement policy)
+    void store(uint64_t key, const TranspositionEntry& entry);
+
+    // Starts a new search generation; older entries age by one
+    void newSearch();
+
+    // Empties the table (not thread-safe)
+    void clear();
+
+    size_t slotCount() const { return (bucket_mask_ + 1) * TRANSPOSITION_BUCKET_SLOTS; }
+    size_t memoryBytes() const { return (bucket_mask_ + 1) * sizeof(Bucket); }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> check;  // key ^ data
+        std::atomic<uint64_t> data;   // packed entry, 0 if empty
+    };
+
+    struct alignas(64) Bucket {
+        Slot slots[TRANSPOSITION_BUCKET_SLOTS];
+    };
+
+    static uint64_t pack(const TranspositionEntry& entry, unsigned generation);
+    static TranspositionEntry unpack(uint64_t data);
+    static unsigned generationOf(uint64_t data);
+
+    std::unique_ptr<Bucket[]> buckets_;
+    size_t bucket_mask_;
+    std::atomic<unsigned> generation_;
+};
+
+#endif // TRANSPOSITION_TABLE_H
@@ -0,0 +1,194 @@
+// VisibilitySweep.cpp
+// ===========================================================================
+// Implements the rotational visibility sweep around the cue ball.
+// ===========================================================================
+
+#include "VisibilitySweep.h"
+#include "GeometryUtils.h"
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <utility>
+
+static const double kPi = 3.14159265358979323846;
+
+// ---------------------------------------------------------------------------
+// Sweep event. At equal angles cones close first, then targets are queried,
+// then cones open, so a direction exactly on a cone boundary is not blocked.
+// ---------------------------------------------------------------------------
+enum SweepEventType {
+    CONE_CLOSE = 0,
+    TARGET_QUERY = 1,
+    CONE_OPEN = 2
+};
+
+struct SweepEvent {
+    double angle;
+    int type;
+    size_t ball;
+};
+
+// Cone of directions covered by one ball
+struct BallCone {
+    double direction;
+    double half_angle;
+    double distance;
+};
+
+// Edge of a cone for the window pass
+struct WindowEdge {
+    double angle;
+    double distance;
+};
+
+static bool edgeBefore(const WindowEdge& a, const WindowEdge& b) {
+    return a.angle < b.angle;
+}
+
+// ---------------------------------------------------------------------------
+// Window bound on one side of every hittable target (hittable is in
+// direction order). 'edges' holds the cone edges that bound that side,
+// sorted by angle: upper edges for the low side ('ascending', visited from
+// the first angle up), lower edges for the high side (visited from the
+// last angle down). For each target the bound is the nearest edge reached
+// before its direction among cones closer than the target, clipped to the
+// target's own cone; an edge exactly on the direction counts.
+//
+// The stack keeps the visited edges not hidden by a nearer edge of a
+// closer cone, so its distances grow towards the top and the nearest
+// closer edge is found by binary search. Each edge is pushed once.
+// ---------------------------------------------------------------------------
+static void sweepNearestEdges(
+    const std::vector<WindowEdge>& edges,
+    const std::vector<BallCone>& cones,
+    const std::vector<size_t>& hittable,
+    bool ascending,
+    std::vector<double>& bound
+) {
+    std::vector<WindowEdge> stack;
+    stack.reserve(edges.size());
+    const double sign = ascending ? 1.0 : -1.0;
+    size_t next = 0;
+    for (size_t k = 0; k < hittable.size(); ++k) {
+        const size_t ti = ascending ? hittable[k] : hittable[hittable.size() - 1 - k];
+        const BallCone& target = cones[ti];
+        // Push every edge up to and including the target direction
+        while (next < edges.size()) {
+            const WindowEdge& e = edges[ascending ? next : edges.size() - 1 - next];
+            if (sign * (e.angle - target.direction) > 0) break;
+            while (!stack.empty() && stack.back().distance >= e.distance) stack.pop_back();
+            stack.push_back(e);
+            ++next;
+        }
+        // Topmost edge of a closer cone
+        auto it = std::lower_bound(stack.begin(), stack.end(), target.distance,
+            [](const WindowEdge& e, double d) { return e.distance < d; });
+        double offset = target.half_angle;
+        if (it != stack.begin()) offset = std::min(offset, sign * (target.direction - (it - 1)->angle));
+        bound[ti] = target.direction - sign * offset;
+    }
+}
+
+std::vector<VisibleTarget> sweepVisibleTargets(
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& balls,
+    double bound_radius
+) {
+    std::vector<BallCone> cones(balls.size());
+    std::vector<bool> usable(balls.size(), false);
+    std::vector<SweepEvent> events;
+    events.reserve(balls.size() * 4);
+
+    // Step 1: one cone per ball, split where it wraps across +-pi
+    for (size_t i = 0; i < balls.size(); ++i) {
+        double dx = balls[i][0] - cueball_pos[0];
+        double dy = balls[i][1] - cueball_pos[1];
+        double distance = mag(dx, dy);
+        if (distance < 1e-9) continue;
+
+        BallCone& cone = cones[i];
+        cone.direction = std::atan2(dy, dx);
+        cone.half_angle = distance > bound_radius ? std::asin(bound_radius / distance) : kPi / 2;
+        cone.distance = distance;
+        usable[i] = true;
+
+        double lo = cone.direction - cone.half_angle;
+        double hi = cone.direction + cone.half_angle;
+        if (lo < -kPi) {
+            events.push_back({lo + 2 * kPi, CONE_OPEN, i});
+            events.push_back({kPi, CONE_CLOSE, i});
+            events.push_back({-kPi, CONE_OPEN, i});
+            events.push_back({hi, CONE_CLOSE, i});
+        } else if (hi > kPi) {
+            events.push_back({lo, CONE_OPEN, i});
+            events.push_back({kPi, CONE_CLOSE, i});
+            events.push_back({-kPi, CONE_OPEN, i});
+            events.push_back({hi - 2 * kPi, CONE_CLOSE, i});
+        } else {
+            events.push_back({lo, CONE_OPEN, i});
+            events.push_back({hi, CONE_CLOSE, i});
+        }
+        events.push_back({cone.direction, TARGET_QUERY, i});
+    }
+
+    std::sort(events.begin(), events.end(), [](const SweepEvent& a, const SweepEvent& b) {
+        if (a.angle != b.angle) return a.angle < b.angle;
+        return a.type < b.type;
+    });
+
+    // Step 2: sweep; active cones ordered by distance from the cue ball
+    std::set<std::pair<double, size_t>> active;
+    std::vector<size_t> hittable;
+    for (const auto& ev : events) {
+        const BallCone& cone = cones[ev.ball];
+        if (ev.type == CONE_OPEN) {
+            active.insert({cone.distance, ev.ball});
+        } else if (ev.type == CONE_CLOSE) {
+            active.erase({cone.distance, ev.ball});
+        } else {
+            // Nearest active cone other than the target itself
+            auto it = active.begin();
+            if (it != active.end() && it->second == ev.ball) ++it;
+            if (it == active.end() || it->first >= cone.distance) {
+                hittable.push_back(ev.ball);
+            }
+        }
+    }
+
+    // Step 3: free windows. The window of a hittable target ends, on each
+    // side, at the nearest edge of a closer cone, or at its own cone edge.
+    // Over the edges sorted by angle that is a nearest-smaller-distance
+    // query, answered with one monotonic stack per side (edges repeated
+    // 2 pi away for the wrap).
+    std::vector<double> window_lo(balls.size());
+    std::vector<double> window_hi(balls.size());
+    std::vector<WindowEdge> edges;
+    edges.reserve(balls.size() * 2);
+    for (size_t i = 0; i < balls.size(); ++i) {
+        if (!usable[i]) continue;
+        double lo = std::remainder(cones[i].direction - cones[i].half_angle, 2 * kPi);
+        edges.push_back({lo, cones[i].distance});
+        edges.push_back({lo + 2 * kPi, cones[i].distance});
+    }
+    std::sort(edges.begin(), edges.end(), edgeBefore);
+    // Lower edges after each target: taken from the last angle down
+    sweepNearestEdges(edges, cones, hittable, false, window_hi);
+
+    edges.clear();
+    for (size_t i = 0; i < balls.size(); ++i) {
+        if (!usable[i]) continue;
+        double hi = std::remainder(cones[i].direction + cones[i].half_angle, 2 * kPi);
+        edges.push_back({hi, cones[i].distance});
+        edges.push_back({hi - 2 * kPi, cones[i].distance});
+    }
+    std::sort(edges.begin(), edges.end(), edgeBefore);
+    // Upper edges before each target: taken from the first angle up
+    sweepNearestEdges(edges, cones, hittable, true, window_lo);
+
+    std::vector<VisibleTarget> result;
+    result.reserve(hittable.size());
+    for (size_t i : hittable) {
+        result.push_back({i, cones[i].direction, window_lo[i], window_hi[i]});
+    }
+    return result;
+}
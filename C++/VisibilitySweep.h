@@ -0,0 +1,60 @@
+// VisibilitySweep.h
+// ===========================================================================
+// Finds every ball the cue ball can hit directly with one rotational sweep,
+// instead of one isPathObstructed call per (cue, child) segment.
+//
+// Seen from the cue ball, a ball at distance d covers the directions within
+// asin(r / d) of its centre line, where r is the clearance radius (the
+// radius "widening" that turns a centre point into a cone of directions).
+// A ball is directly hittable if no closer ball's cone contains its centre
+// direction. Sorting the cone boundaries by angle and sweeping once with
+// the active cones ordered by distance answers this for every ball in
+// O(n log n).
+//
+// For each hittable ball the sweep also returns its free angular window:
+// the range of cue directions around the centre line that still contact
+// the target without first touching a closer ball, found by a second pass
+// over the sorted cone edges, also O(n log n). It is the aim tolerance of
+// a shot struck at the target's centre; SafetyPlanner spreads its sampled
+// cue directions across it. Potting shots aim at a ghost ball off the
+// centre line, so the shot search clears their cue legs with
+// isPathObstructed and scores their tolerance with GhostBallSolver.
+// ===========================================================================
+
+#ifndef VISIBILITY_SWEEP_H
+#define VISIBILITY_SWEEP_H
+
+#include <cstddef>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// One directly hittable ball:
+// - ball: index into the 'balls' argument of sweepVisibleTargets
+// - direction: angle of the cue->ball centre line (radians, atan2 range)
+// - window_lo / window_hi: free aiming window in radians, on the same
+//   branch as 'direction' (window_lo <= direction <= window_hi; the bounds
+//   may leave [-pi, pi] when the window crosses the negative x axis)
+// ---------------------------------------------------------------------------
+struct VisibleTarget {
+    size_t ball;
+    double direction;
+    double window_lo;
+    double window_hi;
+};
+
+// ---------------------------------------------------------------------------
+// Sweeps around 'cueball_pos' and returns every ball in 'balls' the cue
+// ball can reach along a straight line, ordered by direction.
+//
+// A closer ball blocks a target if the target's centre direction lies
+// strictly inside the closer ball's cone (half-angle asin(bound_radius / d)).
+// Balls farther away than the target never block it: the cue ball stops at
+// the contact point. Balls sitting on the cue ball position are ignored.
+// ---------------------------------------------------------------------------
+std::vector<VisibleTarget> sweepVisibleTargets(
+    const std::vector<double>& cueball_pos,
+    const std::vector<std::vector<double>>& balls,
+    double bound_radius
+);
+
+#endif // VISIBILITY_SWEEP_H
@@ -0,0 +1,55 @@
+// endgame_gen.cpp
+// ===========================================================================
+// Offline generator for the endgame tablebase (no robot connection needed).
+//
+// Reads the pockets from csv/holes.csv and writes csv/endgame.tb, which
+// main.cpp uses for layouts with one or two child balls left. Runs on all
+// cores; if interrupted, running it again continues where it stopped.
+//
+// Usage: endgame_gen [cell_size_mm] [minutes]
+// - cell_size_mm: grid cell size (default 20). Lookups decline layouts
+//   where snapping to a cell centre moves a ball more than a ball diameter,
+//   so cells above 21 mm (diameter * sqrt(2)) leave part of the
+//   table to the planner
+// - minutes: stop after this long (default: run to completion)
+//
+// Build together with EndgameTablebase.cpp, MappedFile.cpp, ThreadPool.cpp,
+// PocketModel.cpp, ShotPlanner.cpp, BallMask.cpp and FileIOUtils.cpp.
+// ===========================================================================
+
+#include <cstdlib>
+#include <iostream>
+#include "EndgameTablebase.h"
+#include "FileIOUtils.h"
+
+int main(int argc, char** argv) {
+    std::vector<std::vector<double>> holes = loadCSV2D("csv/holes.csv", 2);
+    if (holes.empty()) {
+        std::cerr << "csv/holes.csv is missing or empty." << std::endl;
+        return -1;
+    }
+
+    // Same pocket model and clearance margin as main.cpp
+    const double bound_radius = 15;
+    std::vector<Pocket> pockets = buildPockets(holes, 2 * bound_radius);
+    double cell_size = argc > 1 ? std::atof(argv[1]) : 20;
+    auto deadline = ThreadPool::Clock::time_point::max();
+    if (argc > 2) {
+        deadline = ThreadPool::Clock::now() + std::chrono::seconds(static_cast<long>(std::atof(argv[2]) * 60));
+    }
+
+    ThreadPool pool;
+    EndgameGenStats stats;
+    auto start = ThreadPool::Clock::now();
+    bool complete = generateEndgameTablebase("csv/endgame.tb", pockets, bound_radius, cell_size, pool, stats, deadline);
+    double seconds = std::chrono::duration<double>(ThreadPool::Clock::now() - start).count();
+
+    std::cout << "Endgame tablebase: " << stats.resumed + stats.generated << "/" << stats.units
+              << " units (" << stats.resumed << " resumed, " << stats.generated << " generated in "
+              << seconds << " s on " << pool.size() << " threads)." << std::endl;
+    if (!complete) {
+        std::cout << "Not complete; run again to continue." << std::endl;
+        return 1;
+    }
+    return 0;
+}
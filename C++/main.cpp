@@ -6,18 +6,37 @@
 //
 // Flow Summary:
 // 1. Read CSV inputs (ball positions, wall positions, hole positions)
-// 2. Determine valid direct child ball-to-hole shots (using ShotPlanner)
-// 3. If none are available, use wall bounce logic (FlipPlanner)
-// 4. Select best shot by shortest distance
-// 5. Command robot to strike
+//    and look up the layout in the plan cache (skip to step 5 on a hit)
+// 2. Search direct child ball-to-hole shots best-first (ShotSearch, using
+//    ShotPlanner checks)
+// 3. If none is likely to go in, add wall bounce logic (FlipPlanner), object
+//    ball banks (BankPlanner) and two-ball combination / kiss shots
+//    (CombinationPlanner)
+// 4. Select best shot by estimated success, validated by rolling out the
+//    cue ball and by the next shot it leaves (AnytimePlanner, steps 2-4
+//    within a fixed time budget)
+// 5. Aim the cue ball at the ghost-ball position (GhostBallSolver),
+//    corrected for collision throw when outcome tables have been generated
+// 6. Command robot to strike
 // ===========================================================================
 
+#include <algorithm>
 #include <iostream>
 #include "FileIOUtils.h"
 #include "ShotPlanner.h"
 #include "FlipPlanner.h"
 #include "RobotController.h"
 #include "GeometryUtils.h"
+#include "PlanCache.h"
+#include "ShotSearch.h"
+#include "AnytimePlanner.h"
+#include "GhostBallSolver.h"
+#include "SafetyPlanner.h"
+#include "RunOutPlanner.h"
+#include "ScratchFilter.h"
+#include "EndgameTablebase.h"
+#include "OutcomeTables.h"
+#include "BallSimulator.h"
 #include "HRSDK.h"
 #include "limits"
 void __stdcall callBack(uint16_t, uint16_t, uint16_t*, int) {};
@@ -37,59 +56,147 @@ int main() {
     std::vector<std::vector<double>> holes = loadCSV2D("csv/holes.csv", 2);
     std::vector<std::vector<double>> walls = loadCSV2D("csv/walls.csv", 2);
     int ball_count = loadSingleInt("csv/ballcount.csv");
+    // Pocket mouths are modelled about two ball diameters wide; cushions
+    // reflect the ball centre one radius off the rail
+    TableModel table = buildTableModel(holes, walls, 2 * 15, 15 / 2.0);
 
-    // Generate all possible direct shots
-    auto valid_shots = selectClearShots(cueball, holes, childballs, 15);
+    // Reuse the ranked plan if this layout was seen before
+    PlanCache plan_cache(64, 2.0);
+    plan_cache.load("csv/plan_cache.csv");
+    uint64_t layout_key = hashTableState(cueball[0], childballs, plan_cache.tolerance());
 
-    std::vector<double> target_ball;
-    std::vector<double> target_hole;
-    double total_distance = 0;
-    // Select best direct shot (by shortest distance)
-    if (!valid_shots.empty()) {
-        double min_dist = std::numeric_limits<double>::max();
-        for (const auto& shot : valid_shots) {
-            double dx = shot.first[0] - shot.second[0];
-            double dy = shot.first[1] - shot.second[1];
-            double cue_dx = cueball[0][0] - shot.first[0];
-            double cue_dy = cueball[0][1] - shot.first[1];
-            double dist = mag(dx, dy)+ mag(cue_dx, cue_dy);
-            if (dist < min_dist) {
-                min_dist = dist;
-                target_ball = shot.first;
-                target_hole = shot.second;
-                total_distance = dist;
-            }
-        }
-        std::cout << "Selected direct shot.";
+    // One or two balls left: answered by the endgame tablebase when one has
+    // been generated for this table (endgame_gen.cpp)
+    EndgameTablebase endgame;
+    endgame.open("csv/endgame.tb", table.pockets, 15);
+    ShotCandidate endgame_shot;
+    double endgame_success = 0;
+    bool from_tablebase = endgame.lookup(cueball[0], childballs, endgame_shot, endgame_success);
+
+    // Throw and pocket capture tables, when generated for this table
+    // (outcome_gen.cpp)
+    OutcomeTables outcomes;
+    outcomes.open("csv/outcome.tb", 15, 2 * 15);
+
+    // Everything from here to the strike shares one frame budget
+    CancellationToken frame(CancellationToken::Clock::now() + std::chrono::milliseconds(50));
+
+    std::vector<ShotCandidate> ranked;
+    if (from_tablebase) {
+        ranked.push_back(endgame_shot);
+        std::cout << "Endgame tablebase hit, success estimate " << endgame_success << "." << std::endl;
+    } else if (plan_cache.lookup(layout_key, ranked) &&
+               rebaseCachedPlan(ranked, cueball[0], childballs, table, 15) > 0) {
+        // Cached coordinates are up to a grid cell off: moved onto the
+        // balls as detected now, so the shots aim (and the run-out below
+        // matches) at the current positions
+        std::cout << "Plan cache hit." << std::endl;
     } else {
-        // If no direct shot is valid, try flip shots (bank shots)
-        auto flip_shots = evaluateFlipShots(cueball[0], childballs, childballs, walls, 15);
+        // Tiered search within the frame budget: direct shots, then cushion
+        // and two-ball shots, then rollout validation and lookahead
+        AnytimeStats plan_stats;
+        AnytimeOptions plan_options = defaultAnytimeOptions();
+        if (outcomes.isOpen()) plan_options.outcomes = &outcomes;
+        ranked = planAnytime(cueball[0], childballs, table, 15, plan_options, frame, plan_stats);
+        std::cout << "Planner: " << plan_stats.candidates << " candidates, "
+                  << plan_stats.search.segment_tests << " segment tests, "
+                  << plan_stats.scratch_risks << " scratch risks, "
+                  << plan_stats.scratches << " scratches"
+                  << (plan_stats.cut_short ? " (deadline)" : "") << "." << std::endl;
+        // Plans cut short by the deadline are not cached
+        if (!ranked.empty() && !plan_stats.cut_short) {
+            plan_cache.store(layout_key, ranked);
+            plan_cache.save("csv/plan_cache.csv");
+        }
+    }
+    std::cout << "Plan cache: " << plan_cache.hits() << " hits, " << plan_cache.misses()
+              << " misses, " << plan_cache.averageLookupMicros() << " us/lookup" << std::endl;
+
+    ThreadPool pool;
+    if (!from_tablebase && !ranked.empty() && ranked.front().kind == DIRECT_SHOT &&
+        childballs.size() <= MAX_RUN_OUT_BALLS) {
+        // Few balls left: play the first shot of the easiest run-out order,
+        // in what is left of the frame budget. It is only preferred if the
+        // planner ranked the same ball and pocket, so it has been through
+        // the same validation and scoring as every other shot.
+        RunOutPlan run_out;
+        if (planRunOut(cueball[0], childballs, table.pockets, 15, pool, frame.deadline(), run_out)) {
+            const RunOutStep& first = run_out.steps.front();
+            const auto& ball = childballs[first.ball];
+            const auto& hole = table.pockets[first.pocket].center;
+            auto match = std::find_if(ranked.begin(), ranked.end(), [&](const ShotCandidate& shot) {
+                return shot.kind == DIRECT_SHOT && shot.target_coords == ball && shot.hole_coords == hole;
+            });
+            bool ranked_too = match != ranked.end();
+            if (ranked_too) std::rotate(ranked.begin(), match, match + 1);
+            std::cout << "Run-out: " << run_out.steps.size() << " shots, difficulty "
+                      << run_out.difficulty << (ranked_too ? "" : " (first shot not ranked, plan kept)")
+                      << "." << std::endl;
+        }
+    }
+
+    // Whatever the source (tablebase, plan cache, planner, run-out), the shot
+    // played never sends the cue ball straight into a pocket
+    size_t scratch_risks = dropScratchRisks(ranked, cueball[0], table.pockets, 15, VALIDATION_SPEED_MARGIN);
+    if (scratch_risks > 0) {
+        std::cout << "Dropped " << scratch_risks << " ranked shots at risk of a scratch." << std::endl;
+    }
 
-        if (!flip_shots.empty()) {
-            FlipShot best = flip_shots[0];
-            for (const auto& fs : flip_shots) {
-                if (fs.total_distance < best.total_distance) {
-                    best = fs;
-                    total_distance= fs.total_distance;
-                }
-            }
-            target_ball = best.target_coords;
-            target_hole = best.hole_coords;
-            std::cout << "Selected flip shot via wall.";
-        } else {
-            std::cerr << "No available shots (direct or flip).";
+    if (ranked.empty()) {
+        // Nothing to pot: play a safety within the frame budget
+        SafetyShot safety;
+        SafetyStats safety_stats;
+        if (!planSafetyShot(cueball[0], childballs, table, 15, defaultSafetyOptions(), pool, safety, safety_stats, &frame)) {
+            std::cerr << "No available shots (no ball can be hit).";
             return -1;
         }
+        std::cout << "Safety: " << safety_stats.legal << "/" << safety_stats.samples << " legal samples, "
+                  << safety_stats.scored << " scored" << (safety_stats.deadline_hit ? " (deadline)" : "")
+                  << ", opponent pots " << safety.opponent_pots << "." << std::endl;
+        ranked.push_back({childballs[safety.target], safety.target_end, safety.roll_distance,
+                          SAFETY_SHOT, 0, safety.contact});
+    }
+    const ShotCandidate& best = ranked.front();
+    std::vector<double> target_ball = best.target_coords;
+    std::vector<double> target_hole = best.hole_coords;
+    double total_distance = best.total_distance;
+    std::cout << "Selected " << shotKindName(best.kind) << " shot.";
+
+    // Ghost-ball aim for every ranked shot in one batch
+    GhostBallBatch aims;
+    for (const auto& shot : ranked) {
+        addGhostBallShot(aims, cueball[0], shot.target_coords, shot.object_aim, shot.aim_margin);
+    }
+    solveGhostBalls(aims, 15);
+    if (outcomes.isOpen()) {
+        // Contact speed estimated as the speed that rolls the whole shot
+        // path, which is also what executeStrike sets its power from
+        std::vector<double> cue_speeds;
+        for (const auto& shot : ranked) {
+            cue_speeds.push_back(std::sqrt(2 * ROLLING_DECELERATION * shot.total_distance));
+        }
+        correctGhostBallsForThrow(aims, 15, outcomes, cue_speeds);
     }
+
     // Prepare robot for strike
     double origin_point[6] = { 90,0,0,0,-90,0 };
     double hit_position[6] = {0};
-    // Calculate hit position based on target ball and hole coordinates
-    double rel_x = target_hole[0] - target_ball[0];
-    double rel_y = target_hole[1] - target_ball[1];
-    double rel_dis = sqrt(pow(rel_x, 2) + pow(rel_y, 2));
-    double vector_x = rel_x / rel_dis; // Unit vector x-component
-    double vector_y = rel_y / rel_dis; // Unit vector y-component   
+    double vector_x = aims.aim_x[0]; // Unit aim vector x-component
+    double vector_y = aims.aim_y[0]; // Unit aim vector y-component
+    double yaw = aims.yaw[0];
+    if (best.kind == FLIP_SHOT || best.kind == SAFETY_SHOT) {
+        // Flip and safety shots send the cue ball straight at object_aim
+        // (the wall contact, or the cue ball position at contact)
+        double rel_x = best.object_aim[0] - cueball[0][0];
+        double rel_y = best.object_aim[1] - cueball[0][1];
+        double rel_dis = sqrt(pow(rel_x, 2) + pow(rel_y, 2));
+        vector_x = rel_x / rel_dis;
+        vector_y = rel_y / rel_dis;
+        yaw = hitYawDegrees(vector_x, vector_y);
+    } else {
+        std::cout << " Cut angle " << aims.cut_angle[0] << " deg, cue margin "
+                  << aims.cue_margin[0] * 1000 << " mrad.";
+    }
     double hit_x=cueball[0][0] + vector_x * (15 + 3); // Add some offset for the cue ball
     double hit_y=cueball[0][1] + vector_y * (15 + 3); // Add some offset for the cue ball
     double z = 0; // Assuming flat surface, z-coordinate is 0
@@ -98,23 +205,7 @@ int main() {
     hit_position[2] = z;
     hit_position[3] = 0; // Roll angle
     hit_position[4] = 0; // Pitch angle
-    // Calculate the angle of the hit direction
-    double angle[3] = { vector_x, vector_y, 0 };
-    double vector_TCP[3] = { 0,-1,0 };
-    double inner_product = 0;
-    double sum = 0;
-    for (int i = 0; i < 3; i++)
-    {
-        sum = angle[i] * vector_TCP[i];
-        inner_product += sum;
-    }
-    // Calculate the angle in degrees
-    double theta = abs(acos(inner_product))* 180 / M_PI;;
-    if (vector_x>0){
-        hit_position[5] = -90+theta; // Yaw angle (facing downwards
-    } else {
-        hit_position[5] = -90-theta; // Facing left
-    } 
+    hit_position[5] = yaw; // Yaw angle along the aim direction
     // Define a target robot pose manually or via mapping (hardcoded here)
     moveToPose(device_id, hit_position,total_distance);      // Move to position
     executeStrike(device_id,total_distance);         // Strike the ball
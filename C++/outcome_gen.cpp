@@ -0,0 +1,34 @@
+// outcome_gen.cpp
+// ===========================================================================
+// Offline generator for the throw and pocket capture tables (no robot
+// connection needed).
+//
+// Writes csv/outcome.tb for the ball size and pocket mouth main.cpp uses;
+// main.cpp then corrects its aim for throw and weights shots by their
+// chance of dropping. Runs on all cores.
+//
+// Build together with OutcomeTables.cpp, MappedFile.cpp and ThreadPool.cpp.
+// ===========================================================================
+
+#include <iostream>
+#include "OutcomeTables.h"
+
+int main() {
+    // Same ball and pocket mouth as main.cpp
+    const double ball_diameter = 15;
+    const double mouth_width = 2 * ball_diameter;
+
+    ThreadPool pool;
+    auto start = ThreadPool::Clock::now();
+    OutcomeTableOptions options = defaultOutcomeTableOptions();
+    if (!generateOutcomeTables("csv/outcome.tb", ball_diameter, mouth_width, options, pool)) {
+        std::cerr << "Could not write csv/outcome.tb." << std::endl;
+        return -1;
+    }
+    double seconds = std::chrono::duration<double>(ThreadPool::Clock::now() - start).count();
+
+    std::cout << "Outcome tables: " << options.throw_cuts << " x " << options.throw_speeds << " throw, "
+              << options.capture_angles << " x " << options.capture_offsets << " capture entries in "
+              << seconds << " s on " << pool.size() << " threads." << std::endl;
+    return 0;
+}
@@ -0,0 +1,164 @@
+// planner_bench.cpp
+// ===========================================================================
+// Standalone benchmark for the shot planners (no robot connection needed).
+//
+// Reads the table geometry from csv/holes.csv and csv/walls.csv, generates a
+// reproducible corpus of random layouts and prints, for each planner
+// coordinate type (double, float, fixed-point), how often its decisions
+// diverge from the double reference and how fast it plans, then measures
+// the clearance test's bounding-box rejections, compares the ball
+// simulator's broadphase with all-pairs testing on 16-ball layouts, the
+// simulator's allocations per rollout (exits with an error if a pooled
+// simulator allocates at all), the batch rollout engine's throughput
+// with its scalar reference, the cost of branching a TableState, the
+// lock-free transposition table against a mutex map under 16 threads, the
+// analytic cue margin of direct shots against sampling the aim, the
+// throw and capture lookup tables against their models (generated into
+// outcome_bench.tb, deleted afterwards), and the scratch prefilter against
+// cue ball rollouts.
+//
+// Build together with ShotPlanner.cpp, FlipPlanner.cpp, ShotSearch.cpp,
+// GhostBallSolver.cpp, BallSimulator.cpp, SweepAndPrune.cpp,
+// EventQueue.cpp, BatchRollout.cpp, TableState.cpp, PlanCache.cpp,
+// TranspositionTable.cpp, ThreadPool.cpp, OutcomeTables.cpp,
+// MappedFile.cpp, ScratchFilter.cpp, FileIOUtils.cpp and PlannerHarness.cpp.
+// Build with the planner flags (-O3 -fno-math-errno -fno-trapping-math
+// -ffp-contract=off), as the planner_bench task in .vscode/tasks.json
+// does; the batch rollout figures also need AVX2 (see BatchRollout.h).
+// ===========================================================================
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include "BatchRollout.h"
+#include "FileIOUtils.h"
+#include "PlannerHarness.h"
+
+// Every heap allocation in the process is counted, for the pool check
+static std::atomic<size_t> allocations(0);
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+static size_t allocationCount() {
+    return allocations.load();
+}
+
+int main() {
+    std::vector<std::vector<double>> holes = loadCSV2D("csv/holes.csv", 2);
+    std::vector<std::vector<double>> walls = loadCSV2D("csv/walls.csv", 2);
+    if (holes.empty()) {
+        std::cerr << "csv/holes.csv is missing or empty." << std::endl;
+        return -1;
+    }
+
+    // Same clearance margin as main.cpp
+    const double bound_radius = 15;
+    const double pocket_mouth = 2 * bound_radius;
+    std::vector<PlannerScenario> corpus = generateScenarioCorpus(holes, walls, 2000, 15, bound_radius, 2024);
+
+    std::cout << "Scalar precision (" << corpus.size() << " layouts)" << std::endl;
+    for (const auto& report : comparePlannerPrecision(corpus, bound_radius, 5)) {
+        std::cout << "  " << report.scalar_name
+                  << ": direct diverged " << report.direct_diverged
+                  << ", flip diverged " << report.flip_diverged
+                  << ", selected shot diverged " << report.best_diverged
+                  << ", " << report.micros_per_plan << " us/plan"
+                  << " (x" << report.speedup << ")" << std::endl;
+        for (size_t i = 0; i < report.diverged_scenarios.size() && i < 10; ++i) {
+            std::cout << "    layout #" << report.diverged_scenarios[i] << std::endl;
+        }
+    }
+
+    ClearanceReport clearance = compareClearance(corpus, bound_radius, 5);
+    std::cout << "Clearance prefilter (" << clearance.segments << " segments, "
+              << clearance.blocked << " blocked)" << std::endl;
+    std::cout << "  box rejected " << clearance.box_rejected << "/" << clearance.obstacles_tested
+              << " obstacles (" << 100 * clearance.box_reject_rate << "%), "
+              << clearance.nanos_per_segment << " ns/segment" << std::endl;
+
+    // Cue ball plus 15 child balls, cue ball sent to roll 3 m
+    std::vector<PlannerScenario> full_tables;
+    for (const auto& s : generateScenarioCorpus(holes, walls, 3000, 15, bound_radius, 2025)) {
+        if (s.childballs.size() == 15) full_tables.push_back(s);
+    }
+    BroadphaseReport broadphase = compareBroadphase(full_tables, bound_radius, pocket_mouth, 3000, 5);
+    std::cout << "Simulator broadphase (" << broadphase.rollouts << " rollouts, 16 balls)" << std::endl;
+    std::cout << "  mismatches " << broadphase.mismatches << ", " << broadphase.events << " events/rollout" << std::endl;
+    std::cout << "  all pairs " << broadphase.naive_pair_tests << " pair tests, "
+              << broadphase.naive_micros << " us/rollout" << std::endl;
+    std::cout << "  sort-and-sweep " << broadphase.broadphase_pair_tests << " pair tests, "
+              << broadphase.broadphase_micros << " us/rollout" << std::endl;
+
+    SimulatorPoolReport pool = measureSimulatorPool(full_tables, bound_radius, pocket_mouth, 3000, 5, allocationCount);
+    std::cout << "Simulator pool (" << pool.rollouts << " rollouts, 16 balls)" << std::endl;
+    std::cout << "  new simulator " << pool.fresh_allocations << " allocations, "
+              << pool.fresh_micros << " us/rollout" << std::endl;
+    std::cout << "  pooled " << pool.pooled_allocations << " allocations, "
+              << pool.pooled_micros << " us/rollout, " << pool.stale_events << " stale events" << std::endl;
+    if (pool.pooled_allocations > 0) {
+        std::cerr << "Pooled simulator allocated during rollouts." << std::endl;
+        return -1;
+    }
+
+    BatchRolloutReport batch = compareBatchRollout(full_tables, bound_radius, pocket_mouth, 256, 300, 3000, 5);
+    std::cout << "Batch rollout (" << batch.rollouts << " variants, " << ROLLOUT_LANES << " lanes)" << std::endl;
+    std::cout << "  mismatches " << batch.mismatches << ", " << batch.contacts << " contacts" << std::endl;
+    std::cout << "  scalar " << batch.scalar_per_second << " rollouts/s" << std::endl;
+    std::cout << "  batch " << batch.batch_per_second << " rollouts/s" << std::endl;
+
+    TableStateReport branching = measureTableStateBranching(full_tables, 5.0, 200);
+    std::cout << "Table state branching (" << branching.branches << " branches, "
+              << branching.state_bytes << " bytes/state)" << std::endl;
+    std::cout << "  hash mismatches " << branching.hash_mismatches << std::endl;
+    std::cout << "  ball lists " << branching.list_nanos << " ns/branch" << std::endl;
+    std::cout << "  TableState " << branching.state_nanos << " ns/branch" << std::endl;
+
+    TranspositionReport transposition = compareTranspositionTables(corpus, 5.0, 16, 200000, 1 << 20);
+    std::cout << "Transposition table (" << transposition.threads << " threads, "
+              << transposition.operations << " operations, " << transposition.keys << " keys, "
+              << transposition.table_bytes << " bytes)" << std::endl;
+    std::cout << "  wrong entries " << transposition.wrong_entries << std::endl;
+    std::cout << "  lock-free " << transposition.lock_free_ops_per_second << " ops/s, hit rate "
+              << transposition.lock_free_hit_rate << std::endl;
+    std::cout << "  mutex map " << transposition.mutex_ops_per_second << " ops/s, hit rate "
+              << transposition.map_hit_rate << std::endl;
+
+    AimMarginReport margins = compareAimMargins(corpus, bound_radius, pocket_mouth, 8, 20);
+    std::cout << "Cue aim margin (" << margins.shots << " direct shots)" << std::endl;
+    std::cout << "  analytic vs sampled: mean relative error " << margins.mean_relative_error << std::endl;
+    std::cout << "  pairs ordered like sampling: by margin " << margins.margin_pair_agreement
+              << ", by distance " << margins.distance_pair_agreement << std::endl;
+    std::cout << "  analytic " << margins.analytic_nanos << " ns/shot, sampled "
+              << margins.sampled_nanos << " ns/shot" << std::endl;
+
+    OutcomeTableReport outcome = compareOutcomeTables("outcome_bench.tb", bound_radius, pocket_mouth, 20000, 2025);
+    std::remove("outcome_bench.tb");
+    std::cout << "Outcome tables (generated in " << outcome.generate_seconds << " s)" << std::endl;
+    std::cout << "  throw error max " << outcome.throw_max_error << " rad, mean "
+              << outcome.throw_mean_error << " rad" << std::endl;
+    std::cout << "  capture agrees with simulation " << outcome.capture_agreement << std::endl;
+    std::cout << "  lookup " << outcome.table_nanos << " ns, models " << outcome.model_nanos << " ns" << std::endl;
+
+    ScratchFilterReport scratch = compareScratchPrefilter(corpus, bound_radius, pocket_mouth, 32, 20);
+    std::cout << "Scratch prefilter (" << scratch.shots << " shots, " << scratch.rollout_scratches
+              << " rollout scratches, " << scratch.straight_scratches << " before any cushion)" << std::endl;
+    std::cout << "  stun recall " << scratch.stun_recall << ", precision " << scratch.stun_precision
+              << ", flagged " << scratch.flag_rate << std::endl;
+    std::cout << "  prefilter " << scratch.filter_nanos << " ns/shot, rollout "
+              << scratch.rollout_nanos << " ns/shot" << std::endl;
+    return 0;
+}